@@ -14,6 +14,23 @@ const char *const ArrayViewEmptyMsg = "arrayView is empty";
 
 #ifndef NDEBUG
 using test::noisy;
+
+namespace
+{   const char *const ThrowsWhenMovedErrorMsg = "throwsWhenMoved was moved";
+
+    struct throwsWhenMoved
+    {   throwsWhenMoved() = default;
+        throwsWhenMoved(const throwsWhenMoved &) = default;
+        throwsWhenMoved(throwsWhenMoved &&)
+        {   throw error(ThrowsWhenMovedErrorMsg, AT);
+        }
+        throwsWhenMoved &operator = (const throwsWhenMoved &) = default;
+        throwsWhenMoved &operator = (throwsWhenMoved &&)
+        {   throw error(ThrowsWhenMovedErrorMsg, AT);
+        }
+    };
+}
+
 void test__core__array()
 {   TEST
     (   "can create array from an iterator implicitly via move",
@@ -122,6 +139,42 @@ void test__core__array()
         EXPECT_EQUAL(Array.count(), 24);
     );
 
+    TEST
+    (   "reserves space from the iterator's remainingCount",
+        TEST
+        (   "constructing from an exact count allocates once",
+            array<int> Array(iterator<int>::range(100000));
+            EXPECT_EQUAL(Array.count(), 100000);
+            EXPECT_EQUAL(Array.capacity(), 100000);
+
+            array<int> Copy = Array.values();
+            EXPECT_EQUAL(Copy.capacity(), 100000);
+        );
+
+        TEST
+        (   "assigning and appending reserve too",
+            array<int> Array;
+            Array = iteratorRange<int>({.Start = 10, .EndBefore = 1010}).values();
+            EXPECT_EQUAL(Array.capacity(), 1000);
+            Array += iterator<int>::range(1000);
+            EXPECT_EQUAL(Array.count(), 2000);
+            EXPECT_EQUAL(Array.capacity(), 2000);
+        );
+
+        TEST
+        (   "filtered iterators only know an upper bound",
+            auto Range = iteratorRange<int>({.EndBefore = 10}).values();
+            EXPECT_EQUAL(Range.remainingCount().AtMost, 10);
+            EXPECT_EQUAL(Range.remainingCount().exact(), True);
+            iterator<int> Filtered = std::move(Range).$ iterate<int>
+            (   [](int &Int) { return Int % 2 ? optional<int>(Int) : optional<int>(); }
+            );
+            EXPECT_EQUAL(Filtered.remainingCount().AtLeast, 0);
+            EXPECT_EQUAL(Filtered.remainingCount().AtMost, 10);
+            EXPECT_EQUAL(array<int>(std::move(Filtered)), array<int>({1, 3, 5, 7, 9}));
+        );
+    );
+
     TEST
     (   "can + and += correctly on another array",
         TEST
@@ -1140,6 +1193,45 @@ void test__core__array()
                 array<int>({-5,-4,-3,-2,-1,0,1,2,3,4,5,})
             );
         );
+
+        TEST
+        (   "sorts with a comparison function",
+            array<int> Array({1,2,3,4,5,-5,-4,-3,-2,0,-1});
+            EXPECT_EQUAL
+            (   Array.sort([](int A, int B) { return A > B; }),
+                array<int>({5,4,3,2,1,0,-1,-2,-3,-4,-5})
+            );
+        );
+
+        TEST
+        (   "sorts by a key computed once per element",
+            array<int> Array({13,-2,7,-11,5});
+            int Keys = 0;
+            EXPECT_EQUAL
+            (   Array.sortByKey([&Keys](int Value) { ++Keys; return Value * Value; }),
+                array<int>({-2,5,7,-11,13})
+            );
+            EXPECT_EQUAL(Keys, 5);
+        );
+
+        TEST
+        (   "sorting by key moves rather than copies",
+            array<noisy> Array;
+            for (int I = 3; I > 0; --I)
+            {   Array.append(noisy(I));
+            }
+            ASSERT_STRING
+            (   TestPrintOutput.pull(),
+                contains("noisy(3)")
+            );
+            Array.sortByKey([](const noisy &Noisy) { return Noisy.Value; });
+            EXPECT_EQUAL(Array[0].Value, 1);
+            EXPECT_EQUAL(Array[2].Value, 3);
+            // Only moves, no copies:
+            string Output(TestPrintOutput.pull());
+            EXPECT_EQUAL(Output.contains("{MC}"), True);
+            EXPECT_EQUAL(Output.contains("{CC}"), False);
+        );
     );
 
     TEST
@@ -1730,6 +1822,69 @@ void test__core__array()
         );
         // TODO: shift+popView tests
     );
+
+    TEST
+    (   "array can live in a memory::resource",
+        memory::arena Arena(1024);
+        array<i64> Scratch(Arena);
+        EXPECT_EQUAL(&Scratch.resource(), (memory::resource *)&Arena);
+        for (i64 I = 0; I < 10; ++I)
+        {   Scratch.append(I);
+        }
+        EXPECT_EQUAL(Arena.bytesUsed() >= 10 * (index)sizeof(i64), True);
+        arrayView<i64> View = Scratch.view();
+        EXPECT_EQUAL(View[9], 9);
+
+        // Copies go on the heap so they can outlive the arena:
+        array<i64> Copy = Scratch;
+        EXPECT_EQUAL(&Copy.resource(), &memory::heap());
+        EXPECT_EQUAL(Copy, Scratch);
+
+        // Each array keeps its resource when assigned or swapped:
+        array<i64> OnHeap({100, 200});
+        std::swap(OnHeap, Scratch);
+        EXPECT_EQUAL(&Scratch.resource(), (memory::resource *)&Arena);
+        EXPECT_EQUAL(&OnHeap.resource(), &memory::heap());
+        EXPECT_EQUAL(Scratch, array<i64>({100, 200}));
+        EXPECT_EQUAL(OnHeap, Copy);
+        Scratch = std::move(OnHeap);
+        EXPECT_EQUAL(&Scratch.resource(), (memory::resource *)&Arena);
+        EXPECT_EQUAL(Scratch, Copy);
+
+        Scratch.deallocate();
+        EXPECT_EQUAL(&Scratch.resource(), (memory::resource *)&Arena);
+    );
+
+    TEST
+    (   "moving an array takes its elements and resource without copying",
+        memory::arena Arena(1024);
+        array<int> Original(Arena);
+        for (int I = 0; I < 10; ++I)
+        {   Original.append(I);
+        }
+        const int *Data = &Original[0];
+        const index BytesUsed = Arena.bytesUsed();
+        array<int> Moved(std::move(Original));
+        EXPECT_EQUAL(&Moved.resource(), (memory::resource *)&Arena);
+        EXPECT_EQUAL(&Moved[0], Data);
+        EXPECT_EQUAL(Moved[9], 9);
+        EXPECT_EQUAL(Arena.bytesUsed(), BytesUsed);
+        EXPECT_EQUAL(Original.count(), 0);
+    );
+
+    TEST
+    (   "moving an array onto another resource can throw, since it moves elements one by one",
+        static_assert(!std::is_nothrow_move_assignable_v<array<int>>);
+        memory::arena Arena(1024);
+        array<throwsWhenMoved> OnArena(Arena);
+        array<throwsWhenMoved> OnHeap;
+        OnHeap.count(3);
+        EXPECT_THROW(OnArena = std::move(OnHeap), ThrowsWhenMovedErrorMsg);
+        // Same resource, so the elements aren't moved one by one:
+        array<throwsWhenMoved> AlsoOnHeap;
+        AlsoOnHeap = std::move(OnHeap);
+        EXPECT_EQUAL(AlsoOnHeap.count(), 3);
+    );
 }
 #endif
 
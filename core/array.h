@@ -3,11 +3,15 @@
 #include "arg.h"
 #include "error.h"
 #include "iterator.h"
+#include "memory.h"
 #include "optional.h"
 #include "pointer.h"
 #include "types.h"
 
 #include <algorithm>    // std::reverse, std::sort 
+#include <initializer_list>
+#include <type_traits>  // std::decay_t, std::is_nothrow_move_assignable_v
+#include <utility>      // std::declval
 #include <vector>
 
 BVMT
@@ -15,6 +19,12 @@ BVMT
 template <class t>
 class array;
 
+template <class t, index inlineCount>
+class smallArray;
+
+template <class t, index fixedCount>
+class fixedArray;
+
 extern const char *const ArrayViewEmptyMsg;
 
 template <class t>
@@ -34,6 +44,11 @@ public:
     {   return Start >= End;
     }
 
+    inline t &operator[] (index Index) const
+    {   ASSERT(Index >= 0 && Index < count());
+        return Start[Index];
+    }
+
     // Returns a reference to the first element in the array,
     // and moves this arrayView pointer up.
     // NOTE! This does *not* change the size of the original array.
@@ -97,13 +112,22 @@ std::ostream &operator << (std::ostream &Out, const arrayElement<value> &Element
 }
 
 namespace arrayDetail
-{   template <class arrayPointer, class value, class el>
+{   // Tags `array` allocations for the `memory::allocationTracker`.
+    struct allocationTag
+    {   static constexpr const char *Name = "array";
+    };
+
+    template <class arrayPointer, class value, class el>
     class elementPointer
     {   arrayPointer Array = Null;
         index Index = -1;
 
         template <class v>
         friend class bvmt::array;
+        template <class v, index n>
+        friend class bvmt::smallArray;
+        template <class v, index n>
+        friend class bvmt::fixedArray;
 
         elementPointer(arrayPointer _Array, index _Index)
         :   Array(_Array), Index(_Index)
@@ -220,50 +244,55 @@ namespace arrayDetail
         return Out << Pointer.element() << ")";
     }
 
+    // Static kernel for `array::values()`; see `staticIterator`.
     template <class arrayType, class iteratorValue> // e.g. (array<t> *, t &)
-    class arrayIteratorKernel : public iteratorKernel<iteratorValue>
+    class arrayIteratorKernel
     {   index Index = -1;
         // TODO: make this a pointer<> so that we can take it in (and destroy it if need be)
         // when the array does not outlive the iterator.
         arrayType Array;
-
+    public:
         arrayIteratorKernel(arrayType _Array)
-        :   iteratorKernel<iteratorValue>
-            ({  .next = [](iteratorKernel<iteratorValue> *BaseKernelSelf)
-                {   CAST_DEFINE
-                    (   SAFE((arrayIteratorKernel<arrayType, iteratorValue>)) *,
-                        Self,
-                        BaseKernelSelf
-                    );
-                    auto *A = Self->Array->getValue(Self->Index + 1);
-                    if (A != Null)
-                    {   ++Self->Index;
-                        return optional<iteratorValue>(*A);
-                    }
-                    return optional<iteratorValue>();
-                },
-            }),
-            Array(_Array)
+        :   Array(_Array)
         {}
 
-    public:
-        KERNEL_TO_ITERATOR
-        (   arrayIteratorKernel<arrayType AND iteratorValue>,
-            iteratorValue,
-            (arrayType _Array),
-            (_Array)
-        );
+        inline optional<iteratorValue> next()
+        {   auto *A = Array->getValue(Index + 1);
+            if (A != Null)
+            {   ++Index;
+                return optional<iteratorValue>(*A);
+            }
+            return optional<iteratorValue>();
+        }
+
+        // The remaining elements are contiguous, so we can add them to the batch directly.
+        inline void nextBatch(iteratorBatch<iteratorValue> &Batch)
+        {   auto *A = Array->getValue(Index + 1);
+            if (A == Null)
+            {   return;
+            }
+            const index Count = std::min(Array->count() - (Index + 1), Batch.room());
+            for (index I = 0; I < Count; ++I)
+            {   Batch.append(A[I]);
+            }
+            Index += Count;
+        }
+
+        inline countHint remainingCount() const
+        {   return countHint::exactly(Array->count() - (Index + 1));
+        }
     };
 }
 
 template <class t>
 class array
-{   std::vector<t> Internal;
+{   typedef std::vector<t, memory::resourceAllocator<t, arrayDetail::allocationTag>> internal;
+    internal Internal;
     index FixedCount = -1;
 
-    // TODO: maybe make `arrayFixedCount` its own class with a pointer to an array.
-    //       it can be a view of another array or it can own the array.
-    //       it'd be nice to be able to say `Array.fixedCountView()` or similar.
+    // NOTE: if the count is known at compile time, prefer `fixedArray`, which stores
+    //       its elements inline and doesn't need any runtime count checks.
+    // TODO: it'd be nice to be able to say `Array.fixedCountView()` or similar.
     // Don't want this public because it's not very clear that
     // this is a fixed size array and not just an array that
     // starts at a certain size.  use the static `array::fixedCount` function.
@@ -280,11 +309,24 @@ public:
     using constElement = arrayElement<const t &>;
     typedef arrayDetail::elementPointer<array *, t, element> elementPointer;
     typedef arrayDetail::elementPointer<const array *, const t, constElement> constElementPointer;
+    typedef staticIterator<t &, arrayDetail::arrayIteratorKernel<array *, t &>> valuesIterator;
+    typedef staticIterator<const t &, arrayDetail::arrayIteratorKernel<const array *, const t &>>
+            constValuesIterator;
 
     array() : Internal() {}
 
+    // An array whose elements live in `Resource` (e.g., an arena) instead of the heap.
+    // It keeps using `Resource` when assigned to or swapped, but copies of it go on the heap.
+    explicit array(memory::resource &Resource)
+    :   Internal(typename internal::allocator_type(Resource))
+    {}
+
     typedef t value;
 
+    inline memory::resource &resource() const
+    {   return Internal.get_allocator().getResource();
+    }
+
     inline arrayView<t> view() &
     {   return Internal.size()
             ?   arrayView<t>(&Internal[0], &Internal[0] + Internal.size())
@@ -322,7 +364,10 @@ public:
     {   return FixedCount >= 0;
     }
 
-    array(std::vector<t> _Vector) : Internal(std::move(_Vector)) {}
+    // Copies the values in, e.g., `array<int>({1, 2, 3})`.
+    array(std::initializer_list<t> Values)
+    :   Internal(Values)
+    {}
 
     COPYABLE_TEMPLATE
     (   array, Array,
@@ -338,42 +383,53 @@ public:
         }
     )
 
-    MOVABLE_TEMPLATE
-    (   array, Array,
-        // FixedCount is sticky to the variable; ignore incoming FixedCount info,
-        // but ensure that if the current variable is FixedCount, that we make
-        // sure the incoming array is the correct size:
-        if (fixedCount() && Array.count() != count())
-        {   LOG_ERR("moving in a different size array, it may get truncated");
-        },
-        Internal = std::move(Array.Internal);
-        if (FixedCount >= 0)
-        {   Internal.resize(FixedCount);
-        }
-        // Reset the other array's FixedCount, to be safe.
+    // Takes `Array`'s elements along with its resource, without moving them one by one.
+    array(array &&Array) noexcept
+    :   Internal(std::move(Array.Internal))
+    {   // Reset the other array's FixedCount, to be safe.
         // std::vector resets to the empty vector when moved,
         // so that would probably not be the correct FixedCount size.
         Array.FixedCount = -1;
-    )
+    }
+
+    // Like a std::pmr container, this array keeps its resource, so this takes `Array`'s
+    // elements if it uses the same resource (e.g., both are on the heap), but otherwise
+    // moves them over one by one, which can throw.  The same goes for `std::swap`.
+    array &operator = (array &&Array) noexcept(std::is_nothrow_move_assignable_v<internal>)
+    {   SET_EQUAL_GUARD
+        (   Array,
+            // FixedCount is sticky to the variable; ignore incoming FixedCount info,
+            // but ensure that if the current variable is FixedCount, that we make
+            // sure the incoming array is the correct size:
+            if (fixedCount() && Array.count() != count())
+            {   LOG_ERR("moving in a different size array, it may get truncated");
+            }
+            Internal = std::move(Array.Internal);
+            if (FixedCount >= 0)
+            {   Internal.resize(FixedCount);
+            }
+            Array.FixedCount = -1;
+        );
+    }
 
     template<class u>
     friend void std::swap(array<u>& A, array<u>& B);
 
     // allow implicit conversion from an iterator to an array, that's nice.
     ITERATOR_CONSTRUCTOR_TEMPLATES
-    (   array, { /* TODO: reserve space if iterator has remainingCount */ },
+    (   array, reserve(Iterator.remainingCount().AtLeast),
         t, T,
         Internal.push_back(T)
     )
 
     ITERATOR_ASSIGNMENT_TEMPLATES
-    (   array, this->count(0); { /* TODO: reserve space if iterator has remainingCount */ },
+    (   array, this->count(0); reserve(Iterator.remainingCount().AtLeast),
         t, T,
         Internal.push_back(T)
     )
 
     ITERATOR_PLUS_EQUAL_TEMPLATES
-    (   array, { /* TODO: reserve EXTRA space if iterator has remainingCount */ },
+    (   array, reserveExtra(Iterator.remainingCount().AtLeast),
         t, T,
         Internal.push_back(T)
     )
@@ -583,7 +639,46 @@ public:
         return *this;
     }
 
-    // TODO: sort with a comparison function
+    // Sorts with `Compare(A, B)` as the "less than" function, e.g., `stringAsciiCompare()`.
+    template <class compare>
+    array<t> &sort(compare Compare)
+    {   std::sort(Internal.begin(), Internal.end(), Compare);
+        return *this;
+    }
+
+    // Sorts by `keyOf(Element)`, which is computed once per element rather than twice in every
+    // comparison, for keys which are expensive to get, e.g., `string::collationKey`.
+    template <class keyOf>
+    array<t> &sortByKey(keyOf key)
+    {   using keyType = std::decay_t<decltype(key(std::declval<const t &>()))>;
+        struct keyed
+        {   keyType Key;
+            index Index;
+        };
+        std::vector<keyed> Keys;
+        Keys.reserve(Internal.size());
+        for (index I = 0; I < count(); ++I)
+        {   Keys.push_back(keyed{key(Internal[I]), I});
+        }
+        std::sort
+        (   Keys.begin(), Keys.end(),
+            [](const keyed &A, const keyed &B) { return A.Key < B.Key; }
+        );
+        internal Sorted(Internal.get_allocator());
+        Sorted.reserve(Internal.size());
+        for (keyed &Keyed : Keys)
+        {   Sorted.push_back(std::move(Internal[Keyed.Index]));
+        }
+        std::swap(Sorted, Internal);
+        return *this;
+    }
+
+    // For strings, sorts into the same order as `sort()`, i.e., by the global locale's
+    // collation (see `string::operator <`), but by comparing each string's precomputed
+    // `collationKey` as bytes, rather than collating the strings in every comparison.
+    array<t> &sortByCollation()
+    {   return sortByKey([](const t &Element) { return Element.collationKey(); });
+    }
 
     inline bool empty() const
     {   return count() == 0;
@@ -622,7 +717,7 @@ public:
     {   if (fixedCount())
         {   throw error(ArrayFixedCountErrorMsg, AT);
         }
-        std::vector<t> NewInternal;
+        internal NewInternal(Internal.get_allocator());
         std::swap(NewInternal, Internal);
     }
 
@@ -634,6 +729,16 @@ public:
         Internal.reserve(Count);
     }
 
+    // Reserves space for `Extra` more elements than we currently have.  Grows the capacity
+    // at least geometrically, so that many small `reserveExtra`s don't cost O(N) each.
+    inline void reserveExtra(index Extra)
+    {   ASSERT(Extra >= 0);
+        const index Needed = count() + Extra;
+        if (Needed > (index)Internal.capacity())
+        {   reserve(fixedCount() ? Needed : std::max(Needed, 2 * (index)Internal.capacity()));
+        }
+    }
+
     // Note we ignore whether the array is FixedCount
     // when comparing.  This is because FixedCount arrays
     // are "sticky" to the variable -- e.g., copying a FixedCount array
@@ -657,12 +762,14 @@ public:
     // TODO: create rvalue iterators, e.g., for `values() &` and `values() &&`
     // the latter needs to take the array memory into itself for iterating,
     // since the array is temporary.
-    iterator<t &> values() &
-    {   return arrayDetail::arrayIteratorKernel<array<t> *, t &>::toIterator(this);
+    // These are `staticIterator`s so that loops over them can be inlined;
+    // they convert implicitly to `iterator<t &>` when type erasure is needed.
+    valuesIterator values() &
+    {   return valuesIterator(this);
     }
     
-    iterator<const t &> values() const &
-    {   return arrayDetail::arrayIteratorKernel<const array<t> *, const t &>::toIterator(this);
+    constValuesIterator values() const &
+    {   return constValuesIterator(this);
     }
 
     elementPointer first() &
@@ -680,6 +787,12 @@ public:
 
     // TODO: maybe add keys() or indices() iterator
 private:
+    VISIBLE_FOR_TESTING
+    (   index capacity() const
+        {   return Internal.capacity();
+        }
+    )
+
     t *getValue(index Index)
     {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index)
         else if (Index >= count())
@@ -755,7 +868,14 @@ namespace std
             if (A.count() != B.count())
                 throw bvmt::error(bvmt::ArrayFixedCountErrorMsg, AT);
         }
-        std::swap(A.Internal, B.Internal);
+        if (A.Internal.get_allocator() == B.Internal.get_allocator())
+        {   std::swap(A.Internal, B.Internal);
+            return;
+        }
+        // Each array keeps its own resource, so the elements have to move across:
+        auto Temporary = std::move(A.Internal);
+        A.Internal = std::move(B.Internal);
+        B.Internal = std::move(Temporary);
     }
 
     template<class t>
@@ -2,6 +2,7 @@
 
 #include "types.h"
 
+#include <chrono>
 #include <iostream>
 #include <exception>
 #include <streambuf>
@@ -89,6 +90,7 @@ public:
 #define TEST_2_VALUES(Context, X, Y, actualTest) ((void)0)
 #define TEST_4_VALUES(Context, W, X, Y, Z, actualTest) ((void)0)
 #define TEST_LARGE_ALLOCATION(Context, x) ((void)0)
+#define TEST_BENCHMARK(Context, x) ((void)0)
 #define VISIBLE_FOR_TESTING(x) private: \
     x
 #define MOCK(functionOutputType, function, functionInputType, functionArgs, Mock, DebugWrite) \
@@ -98,7 +100,8 @@ public:
 #define MOCKABLE(x, y) class x { public: y }
 
 #else // DEBUG
-static bool TestOnly = False;
+// `inline` so that every translation unit (and template instantiation) sees the same flag.
+inline bool TestOnly = False;
 #define DEBUG_ONLY(X) X
 #define LOG(X) { std::cout << "[" AT "]: " << X << "\n"; }
 #define LOG_ERR(X) { std::cerr << "[" AT "]: " << X << "\n"; }
@@ -114,6 +117,9 @@ static bool TestOnly = False;
 #define ASSERT_PROBABLY(X) { if (!(X)) LOG_ERR("expected " #X); }
 #define ASSERT_WORD_ALIGNED(X) \
     ASSERT(((i64)(u8 *)&(X)) % sizeof(u8 *) == 0);
+// Commas split macro arguments unless they're inside parentheses, so a test can't use
+// e.g. `map<i64, i64>` directly; tests declare aliases like `using intMap = map<i64, i64>;`
+// above their `test__core__...` function instead.
 #define TEST(Context, x) \
 {   TestOnly = True; \
     bvmt::capturer TestPrintOutput(std::cout); \
@@ -157,6 +163,12 @@ static bool TestOnly = False;
 #else
 #define TEST_LARGE_ALLOCATION(Context, x) ((void)0)
 #endif
+// Benchmarks don't run inside a `TEST`, so that they can `LOG` their results.
+#ifdef BENCHMARKS
+#define TEST_BENCHMARK(Context, x) {LOG("benchmark " Context "..."); TRY(Context " benchmark", x);}
+#else
+#define TEST_BENCHMARK(Context, x) ((void)0)
+#endif
 #define VISIBLE_FOR_TESTING(x) \
     public: \
     x \
@@ -254,4 +266,16 @@ bool checkEqual(const std::string &A, const char *const &B);
     DEBUG_ONLY(static returnType ReturnValue); \
     MOCK(returnType, function, (argType ArgOnly), (ArgOnly), ArgOnly, ReturnValue)
 
+#ifndef NDEBUG
+namespace test
+{   // Returns how many seconds it takes to call `run()`, e.g., for a `TEST_BENCHMARK`.
+    template <class runner>
+    dbl secondsToRun(runner run)
+    {   const auto Start = std::chrono::steady_clock::now();
+        run();
+        return std::chrono::duration<dbl>(std::chrono::steady_clock::now() - Start).count();
+    }
+}
+#endif
+
 TMVB
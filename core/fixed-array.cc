@@ -0,0 +1,113 @@
+#include "fixed-array.h"
+
+#ifndef NDEBUG
+#include "memory.h"
+#include "string.h"
+#endif
+
+BVMT
+
+const char *const FixedArrayIndexErrorMsg = "fixedArray index is past the end";
+const char *const FixedArrayTooManyValuesErrorMsg = "fixedArray was given more values than its count";
+
+#ifndef NDEBUG
+namespace
+{   using fourInts = fixedArray<i32, 4>;
+    using twoStrings = fixedArray<string, 2>;
+    using fourByFour = fixedArray<fourInts, 4>;
+}
+
+void test__core__fixed_array()
+{   TEST
+    (   "fixedArray is stored inline and its count is a compile-time constant",
+        static_assert(sizeof(fourInts) == 4 * sizeof(i32));
+        static_assert(fourInts::count() == 4);
+        fourInts Array({1, 2});
+        EXPECT_EQUAL(Array, fourInts({1, 2, 0, 0}));
+        EXPECT_THROW(fourInts({1, 2, 3, 4, 5}), FixedArrayTooManyValuesErrorMsg);
+    );
+
+    TEST
+    (   "fixedArray indexing",
+        fourInts Array({5, 6, 7, 8});
+        EXPECT_EQUAL(Array[0], 5);
+        EXPECT_EQUAL(Array[-1], 8);
+        Array[1] = 60;
+        EXPECT_EQUAL(Array.swap(2, 70), 7);
+        Array.swapIndices(0, -1);
+        EXPECT_EQUAL(Array, fourInts({8, 60, 70, 5}));
+        EXPECT_THROW(Array[4], FixedArrayIndexErrorMsg);
+        EXPECT_THROW(Array[-5], ArrayTooNegativeIndexErrorMsg);
+
+        index Index = -1;
+        EXPECT_EQUAL(Array.findFirst(70, determining<index>(Index)), True);
+        EXPECT_EQUAL(Index, 2);
+        EXPECT_EQUAL(Array.sort(), fourInts({5, 8, 60, 70}));
+        EXPECT_EQUAL(Array.reverse(), fourInts({70, 60, 8, 5}));
+        Array.fill(3);
+        EXPECT_EQUAL(Array, fourInts({3, 3, 3, 3}));
+    );
+
+    TEST
+    (   "fixedArray works with views, iterators, and element pointers",
+        twoStrings Array({"hi", "there"});
+        arrayView<string> View = Array.view();
+        EXPECT_EQUAL(View.count(), 2);
+        View[0] += "!";
+        EXPECT_EQUAL(Array[0], "hi!");
+
+        string Joined;
+        for (string &String : Array.values())
+        {   Joined += String;
+        }
+        EXPECT_EQUAL(Joined, "hi!there");
+        EXPECT_EQUAL(Array.values().remainingCount().AtLeast, 2);
+        array<string> Copied = Array.values();
+        EXPECT_EQUAL(Copied, array<string>({"hi!", "there"}));
+
+        index Count = 0;
+        for (auto Element : Array.elements())
+        {   EXPECT_EQUAL(Element.Value, Array[Element.Index]);
+            ++Count;
+        }
+        EXPECT_EQUAL(Count, 2);
+
+        twoStrings::elementPointer Pointer = Array.get(1);
+        EXPECT_EQUAL(*Pointer, "there");
+        string Default = "nope";
+        EXPECT_EQUAL(Array.get(2).otherwise(defaultTo(Default)), "nope");
+        EXPECT_EQUAL(Pointer.next(), False);
+        EXPECT_EQUAL(Pointer == Null, True);
+    );
+
+    TEST
+    (   "fixedArray works as a grid or lookup table without allocating",
+        memory::allocationTracker *Tracker = memory::allocationTracker::get();
+        const bool WasEnabled = memory::allocationTracker::enabled();
+        memory::allocationTracker::enable();
+        const index AllocationsBefore = Tracker->totals().Allocations;
+        // A 4x4 multiplication table, looked up as `Table[Row][Column]`:
+        fourByFour Table;
+        for (i32 Row = 0; Row < 4; ++Row)
+        {   for (i32 Column = 0; Column < 4; ++Column)
+            {   Table[Row][Column] = Row * Column;
+            }
+        }
+        const i32 Lookup = Table[3][2] + Table[1][1];
+        const index AllocationsAfterTable = Tracker->totals().Allocations;
+        // Compared to an `array` with a fixed count, which allocates its elements:
+        array<i32> Array = array<i32>::fixedCount(4);
+        const index FixedArrayAllocations = AllocationsAfterTable - AllocationsBefore;
+        const index ArrayAllocations = Tracker->totals().Allocations - AllocationsAfterTable;
+        memory::allocationTracker::enable(WasEnabled);
+
+        EXPECT_EQUAL(FixedArrayAllocations, 0);
+        EXPECT_EQUAL(ArrayAllocations, 1);
+        EXPECT_EQUAL(Lookup, 7);
+        EXPECT_EQUAL(Table[2], fourInts({0, 2, 4, 6}));
+        EXPECT_EQUAL(Array.count(), 4);
+    );
+}
+#endif
+
+TMVB
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "array.h"
+#include "error.h"
+#include "iterator.h"
+#include "types.h"
+
+#include <algorithm>    // std::reverse, std::sort
+#include <initializer_list>
+
+BVMT
+
+extern const char *const FixedArrayIndexErrorMsg;
+extern const char *const FixedArrayTooManyValuesErrorMsg;
+
+// An array whose count is known at compile time, with its elements stored inside it
+// (so a local `fixedArray` lives on the stack), e.g., for grids and lookup tables.
+// Unlike `array::fixedCount`, there are no runtime count checks on mutation since
+// the count can't change, and loops up to `count()` can be unrolled by the compiler.
+// Works with `arrayView`, `values()`, `elements()`, and array-style element pointers.
+template <class t, index fixedCount>
+class fixedArray
+{   static_assert(fixedCount > 0, "fixedArray needs at least one element");
+
+    t Elements[fixedCount];
+
+public:
+    using element = arrayElement<t &>;
+    using constElement = arrayElement<const t &>;
+    typedef arrayDetail::elementPointer<fixedArray *, t, element> elementPointer;
+    typedef arrayDetail::elementPointer<const fixedArray *, const t, constElement> constElementPointer;
+    typedef staticIterator<t &, arrayDetail::arrayIteratorKernel<fixedArray *, t &>> valuesIterator;
+    typedef staticIterator<const t &, arrayDetail::arrayIteratorKernel<const fixedArray *, const t &>>
+            constValuesIterator;
+
+    typedef t value;
+
+    // Elements are default-constructed (so are uninitialized for plain types like `int`).
+    fixedArray() {}
+
+    // Sets the first elements to `Values` and value-initializes the rest.
+    fixedArray(std::initializer_list<t> Values)
+    :   Elements()
+    {   if ((index)Values.size() > fixedCount)
+        {   throw error(FixedArrayTooManyValuesErrorMsg, AT);
+        }
+        index I = 0;
+        for (const t &Value : Values)
+        {   Elements[I++] = Value;
+        }
+    }
+
+    static constexpr index count()
+    {   return fixedCount;
+    }
+
+    static constexpr bool empty()
+    {   return False;
+    }
+
+    inline arrayView<t> view() &
+    {   return arrayView<t>(Elements, Elements + fixedCount);
+    }
+
+    inline arrayView<const t> view() const &
+    {   return arrayView<const t>(Elements, Elements + fixedCount);
+    }
+
+    elementPointer get(index Index)
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index);
+        return elementPointer(this, Index);
+    }
+
+    constElementPointer get(index Index) const
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index);
+        return constElementPointer(this, Index);
+    }
+
+    inline const t &operator[] (index Index) const
+    {   return *getNonNullValue(Index);
+    }
+
+    inline t &operator[] (index Index)
+    {   return *getNonNullValue(Index);
+    }
+
+    t swap(index Index, t T)
+    {   t Result = std::move(operator[](Index));
+        operator[](Index) = std::move(T);
+        return Result;
+    }
+
+    void swapIndices(index Index1, index Index2)
+    {   t &Value1 = operator[](Index1);
+        t &Value2 = operator[](Index2);
+        if (&Value1 == &Value2)
+            return;
+        std::swap(Value1, Value2);
+    }
+
+    // Sets every element to `Value`.
+    void fill(const t &Value)
+    {   for (index I = 0; I < fixedCount; ++I)
+        {   Elements[I] = Value;
+        }
+    }
+
+    bool findFirst(const t &T, determining<index> Index) const
+    {   for (index I = 0; I < fixedCount; ++I)
+        {   if (Elements[I] == T)
+            {   Index = I;
+                return True;
+            }
+        }
+        return False;
+    }
+
+    fixedArray &reverse()
+    {   std::reverse(Elements, Elements + fixedCount);
+        return This;
+    }
+
+    fixedArray &sort()
+    {   std::sort(Elements, Elements + fixedCount);
+        return This;
+    }
+
+    bool operator == (const fixedArray &Other) const
+    {   for (index I = 0; I < fixedCount; ++I)
+        {   if (Elements[I] != Other.Elements[I])
+            {   return False;
+            }
+        }
+        return True;
+    }
+
+    inline bool operator != (const fixedArray &Other) const
+    {   return !(*this == Other);
+    }
+
+    valuesIterator values() &
+    {   return valuesIterator(this);
+    }
+
+    constValuesIterator values() const &
+    {   return constValuesIterator(this);
+    }
+
+    elementPointer first() &
+    {   return elementPointer(this, 0);
+    }
+
+    constElementPointer first() const &
+    {   return constElementPointer(this, 0);
+    }
+
+    CONTAINER_ITERATOR(fixedArray)
+    MUTABLE_CONTAINER_ITERATOR(fixedArray)
+
+private:
+    t *getValue(index Index)
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index)
+        else if (Index >= fixedCount)
+        {   return Null;
+        }
+        return &Elements[Index];
+    }
+
+    const t *getValue(index Index) const
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index)
+        else if (Index >= fixedCount)
+        {   return Null;
+        }
+        return &Elements[Index];
+    }
+
+    // There's no growing a fixedArray, so both versions throw if `Index` is past the end.
+    inline t *getNonNullValue(index Index)
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index)
+        else if (Index >= fixedCount)
+        {   throw error(FixedArrayIndexErrorMsg, AT);
+        }
+        return &Elements[Index];
+    }
+
+    inline const t *getNonNullValue(index Index) const
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index)
+        else if (Index >= fixedCount)
+        {   throw error(FixedArrayIndexErrorMsg, AT);
+        }
+        return &Elements[Index];
+    }
+
+    template <class a1, class t1, class e1>
+    friend class arrayDetail::elementPointer;
+    template <class a1, class t1>
+    friend class arrayDetail::arrayIteratorKernel;
+};
+
+template <class t, index fixedCount>
+std::ostream &operator << (std::ostream &Out, const fixedArray<t, fixedCount> &Array)
+{   Out << "fixedArray({ ";
+    for (index I = 0; I < fixedCount; ++I)
+        Out << Array[I] << ", ";
+    return Out << "})";
+}
+
+TMVB
@@ -0,0 +1,166 @@
+#include "format.h"
+
+#include <algorithm>    // std::max, std::min
+#include <charconv>     // std::to_chars
+#include <cstring>      // memcpy, memset
+
+#ifndef NDEBUG
+#include "error.h"
+#include "string.h"
+
+#include <limits>
+#endif
+
+BVMT
+
+namespace format
+{   namespace
+    {   // Copies `Count` bytes of `Digits` into `Buffer`, padding them out to `Options.Width`.
+        index pad(char *Buffer, index Capacity, const char *Digits, index Count, const options &Options)
+        {   const index Pads = std::max(std::min(Options.Width, MaxWidth) - Count, (index)0);
+            if (Count + Pads > Capacity)
+            {   return -1;
+            }
+            index Written = 0;
+            if (Pads > 0 && Options.Pad == '0' && (Digits[0] == '-' || Digits[0] == '+'))
+            {   Buffer[Written++] = *Digits++;
+                --Count;
+            }
+            memset(Buffer + Written, Options.Pad, Pads);
+            Written += Pads;
+            memcpy(Buffer + Written, Digits, Count);
+            return Written + Count;
+        }
+
+        template <class t>
+        index writeFloatLike(char *Buffer, index Capacity, t Value, const options &Options)
+        {   char Digits[MaxBytes];
+            char *const End = Digits + sizeof(Digits);
+            const int Precision = std::min(Options.Precision, MaxPrecision);
+            std::to_chars_result Result;
+            if (Options.Base == 16)
+            {   Result = Precision < 0
+                    ?   std::to_chars(Digits, End, Value, std::chars_format::hex)
+                    :   std::to_chars(Digits, End, Value, std::chars_format::hex, Precision);
+            }
+            else if (Precision < 0)
+            {   Result = std::to_chars(Digits, End, Value);
+            }
+            else
+            {   Result = std::to_chars(Digits, End, Value, std::chars_format::fixed, Precision);
+                if (Result.ec != std::errc())
+                {   Result = std::to_chars(Digits, End, Value, std::chars_format::scientific, Precision);
+                }
+            }
+            if (Result.ec != std::errc())
+            {   return -1;
+            }
+            return pad(Buffer, Capacity, Digits, Result.ptr - Digits, Options);
+        }
+    }
+
+    index writeInteger(char *Buffer, index Capacity, u64 Magnitude, bool Negative, const options &Options)
+    {   // A sign and 64 binary digits:
+        char Digits[72];
+        char *Start = Digits;
+        if (Negative)
+        {   *Start++ = '-';
+        }
+        const int Base = Options.Base >= 2 && Options.Base <= 36 ? Options.Base : 10;
+        const std::to_chars_result Result = std::to_chars(Start, Digits + sizeof(Digits), Magnitude, Base);
+        return pad(Buffer, Capacity, Digits, Result.ptr - Digits, Options);
+    }
+
+    index writeFloat(char *Buffer, index Capacity, float Value, const options &Options)
+    {   return writeFloatLike(Buffer, Capacity, Value, Options);
+    }
+
+    index writeFloat(char *Buffer, index Capacity, double Value, const options &Options)
+    {   return writeFloatLike(Buffer, Capacity, Value, Options);
+    }
+
+    index writeFloat(char *Buffer, index Capacity, long double Value, const options &Options)
+    {   return writeFloatLike(Buffer, Capacity, Value, Options);
+    }
+}
+
+#ifndef NDEBUG
+void test__core__format()
+{   // Writes into a buffer with some room to spare, and checks that nothing past the end was touched.
+    auto written = [](auto Value, format::options Options = {}) -> string
+    {   char Buffer[format::MaxBytes + 1];
+        Buffer[format::MaxBytes] = '#';
+        const index Count = format::write(Buffer, format::MaxBytes, Value, Options);
+        ASSERT(Buffer[format::MaxBytes] == '#');
+        return Count < 0 ? string("(too long)") : string(std::string(Buffer, Count));
+    };
+
+    TEST
+    (   "format::write writes integers",
+        EXPECT_EQUAL(written(0), "0");
+        EXPECT_EQUAL(written(12345), "12345");
+        EXPECT_EQUAL(written(-42), "-42");
+        EXPECT_EQUAL(written(True), "1");
+        EXPECT_EQUAL(written(u16(65535)), "65535");
+        EXPECT_EQUAL(written(std::numeric_limits<i64>::min()), "-9223372036854775808");
+        EXPECT_EQUAL(written(std::numeric_limits<u64>::max()), "18446744073709551615");
+        EXPECT_EQUAL(written(255, {.Base = 16}), "ff");
+        EXPECT_EQUAL(written(-255, {.Base = 16}), "-ff");
+        EXPECT_EQUAL(written(5, {.Base = 2}), "101");
+        EXPECT_EQUAL(written(5, {.Base = 99}), "5");
+    );
+
+    TEST
+    (   "format::write writes floats with the shortest digits that round-trip",
+        EXPECT_EQUAL(written(1234.56f), "1234.56");
+        EXPECT_EQUAL(written(0.1), "0.1");
+        EXPECT_EQUAL(written(-2.5), "-2.5");
+        EXPECT_EQUAL(written(1234567.0), "1234567");
+        EXPECT_EQUAL(written(1e21), "1e+21");
+        EXPECT_EQUAL(written(0.1f + 0.2f), "0.3");
+        EXPECT_EQUAL(written(0.1 + 0.2), "0.30000000000000004");
+        EXPECT_EQUAL(written(std::numeric_limits<dbl>::infinity()), "inf");
+        EXPECT_EQUAL(written(1.5, {.Base = 16}), "1.8p+0");
+    );
+
+    TEST
+    (   "format::write writes floats with a fixed precision",
+        EXPECT_EQUAL(written(3.14159, {.Precision = 2}), "3.14");
+        EXPECT_EQUAL(written(-0.5, {.Precision = 0}), "-0");
+        EXPECT_EQUAL(written(2.0, {.Precision = 3}), "2.000");
+        // Too long to write in fixed notation:
+        EXPECT_EQUAL(written(1e300, {.Precision = 2}), "1.00e+300");
+        // Precision past `MaxPrecision` still fits into `MaxBytes`:
+        EXPECT_EQUAL(written(1.0, {.Precision = 200}), string("1.") + string("0") * format::MaxPrecision);
+        EXPECT_EQUAL(written(-1e300, {.Precision = 200}).countBytes(), format::MaxPrecision + 8);
+        EXPECT_EQUAL
+        (   written(std::numeric_limits<long double>::max(), {.Precision = 1000}).countBytes(),
+            format::MaxPrecision + 8
+        );
+        EXPECT_EQUAL
+        (   written(1.5, {.Base = 16, .Precision = 200}),
+            string("1.8") + string("0") * (format::MaxPrecision - 1) + "p+0"
+        );
+    );
+
+    TEST
+    (   "format::write pads to a width",
+        EXPECT_EQUAL(written(42, {.Width = 5}), "   42");
+        EXPECT_EQUAL(written(-42, {.Width = 5, .Pad = '0'}), "-0042");
+        EXPECT_EQUAL(written(12345, {.Width = 3}), "12345");
+        EXPECT_EQUAL(written(7, {.Base = 16, .Width = 2, .Pad = '0'}), "07");
+        EXPECT_EQUAL(written(1.5, {.Precision = 1, .Width = 6, .Pad = '0'}), "0001.5");
+        EXPECT_EQUAL(written(1, {.Width = 1000}).countBytes(), format::MaxWidth);
+    );
+
+    TEST
+    (   "format::write returns -1 if the number doesn't fit",
+        char Buffer[4];
+        EXPECT_EQUAL(format::write(Buffer, 4, 1234), 4);
+        EXPECT_EQUAL(format::write(Buffer, 4, 12345), -1);
+        EXPECT_EQUAL(format::write(Buffer, 4, 12, {.Width = 5}), -1);
+    );
+}
+#endif
+
+TMVB
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "types.h"
+
+#include <type_traits>
+
+BVMT
+
+// Number formatting which writes straight into a buffer via std::to_chars, i.e., without
+// streams, locales, or allocations, e.g., for scores, coordinates, and timers every frame.
+// See also `string::of` and `string::appendNumber`, which use it for all numbers.
+namespace format
+{   struct options
+    {   // For integers, 2 through 36, with lowercase letters for digits past 9.
+        // Floats can use 16 for hexadecimal floating point.
+        int Base = 10;
+        // Digits after the decimal point for floats, or -1 for the shortest digits that
+        // round-trip.  Values too large to write in fixed notation use scientific notation.
+        // Anything past `MaxPrecision` (far more than a double has) is written as `MaxPrecision`.
+        int Precision = -1;
+        // Pads on the left with `Pad` to at least this many bytes, up to `MaxWidth`.
+        // Zero padding goes after the sign, e.g., "-0042".
+        index Width = 0;
+        char Pad = ' ';
+    };
+
+    constexpr index MaxWidth = 64;
+    constexpr int MaxPrecision = 128;
+    // Enough room for any number written with any `options`, e.g., a sign, a digit, a period,
+    // `MaxPrecision` digits, and an exponent like "e+4932" for the largest long doubles.
+    constexpr index MaxBytes = 192;
+
+    // The types that `write` formats: integers (including bool, as 0 or 1) and floats, but
+    // not character types, which `string::of` writes as characters like a stream would.
+    template <class t>
+    constexpr bool number = std::is_arithmetic_v<t>
+            &&  !std::is_same_v<t, char> && !std::is_same_v<t, signed char> && !std::is_same_v<t, unsigned char>
+            &&  !std::is_same_v<t, wchar_t> && !std::is_same_v<t, char8_t>
+            &&  !std::is_same_v<t, char16_t> && !std::is_same_v<t, char32_t>;
+
+    index writeInteger(char *Buffer, index Capacity, u64 Magnitude, bool Negative, const options &Options);
+    index writeFloat(char *Buffer, index Capacity, float Value, const options &Options);
+    index writeFloat(char *Buffer, index Capacity, double Value, const options &Options);
+    index writeFloat(char *Buffer, index Capacity, long double Value, const options &Options);
+
+    // Writes `Value` into `Buffer` (without a NUL terminator), returning how many bytes it
+    // took, or -1 if they didn't fit into `Capacity`; `MaxBytes` always fits.
+    template <class t>
+    index write(char *Buffer, index Capacity, t Value, const options &Options = {})
+    {   static_assert(number<t>, "format::write only writes numbers");
+        if constexpr (std::is_floating_point_v<t>)
+        {   return writeFloat(Buffer, Capacity, Value, Options);
+        }
+        else if constexpr (std::is_signed_v<t>)
+        {   // Negating as unsigned also works for the most negative value.
+            return Value < 0
+                ?   writeInteger(Buffer, Capacity, u64(0) - (u64)Value, True, Options)
+                :   writeInteger(Buffer, Capacity, (u64)Value, False, Options);
+        }
+        else
+        {   return writeInteger(Buffer, Capacity, (u64)Value, False, Options);
+        }
+    }
+}
+
+TMVB
@@ -0,0 +1,196 @@
+#include "hash-table.h"
+
+BVMT
+
+const char *const HashTableAllocationErrorMsg = "hash table could not allocate its slots";
+
+#ifndef NDEBUG
+namespace
+{   struct sameKey
+    {   static inline const i64 &of(const i64 &Entry)
+        {   return Entry;
+        }
+    };
+
+    // Puts everything into the same probe sequence, so we can test collisions and tombstones.
+    struct collidingHash
+    {   inline size_t operator() (i64) const
+        {   return 12345;
+        }
+    };
+
+    struct counted
+    {   // Counts instances so that we can check that slots are constructed/destroyed once.
+        static inline index Live = 0;
+        i64 Key;
+
+        counted(i64 K) : Key(K)
+        {   ++Live;
+        }
+        counted(const counted &Other) : Key(Other.Key)
+        {   ++Live;
+        }
+        counted(counted &&Other) : Key(Other.Key)
+        {   ++Live;
+        }
+        ~counted()
+        {   --Live;
+        }
+
+        static inline const i64 &of(const counted &Entry)
+        {   return Entry.Key;
+        }
+    };
+
+    using intTable = hashTable<i64, i64, sameKey>;
+    using collidingTable = hashTable<i64, i64, sameKey, collidingHash>;
+    using countedTable = hashTable<counted, i64, counted>;
+
+    template <class table>
+    index insertKey(table &Table, i64 Key)
+    {   bool Inserted;
+        return Table.insert
+        (   Key, determining<bool>(Inserted),
+            [Key](auto *Slot) { new (Slot) i64(Key); }
+        );
+    }
+}
+
+void test__core__hash_table()
+{   TEST
+    (   "hash table finds what was inserted, across rehashes",
+        intTable Table;
+        EXPECT_EQUAL(Table.capacity(), 0);
+        EXPECT_EQUAL(Table.find(5), -1);
+        for (i64 Key = 0; Key < 1000; ++Key)
+        {   insertKey(Table, Key * 7);
+        }
+        EXPECT_EQUAL(Table.count(), 1000);
+        for (i64 Key = 0; Key < 1000; ++Key)
+        {   index Slot = Table.find(Key * 7);
+            ASSERT(Slot >= 0);
+            EXPECT_EQUAL(*Table.at(Slot), Key * 7);
+            EXPECT_EQUAL(Table.find(Key * 7 + 1), -1);
+        }
+        // Inserting an existing key doesn't construct anything:
+        bool Inserted = True;
+        index Slot = Table.insert
+        (   14, determining<bool>(Inserted),
+            [](i64 *) { throw error("should not construct", AT); }
+        );
+        EXPECT_EQUAL(Inserted, False);
+        EXPECT_EQUAL(*Table.at(Slot), 14);
+    );
+
+    TEST
+    (   "hash table can iterate over full slots",
+        intTable Table;
+        EXPECT_EQUAL(Table.nextFull(-1), -1);
+        i64 Sum = 0;
+        for (i64 Key = 1; Key <= 100; ++Key)
+        {   insertKey(Table, Key);
+        }
+        index Visited = 0;
+        for (index Slot = Table.nextFull(-1); Slot >= 0; Slot = Table.nextFull(Slot))
+        {   Sum += *Table.at(Slot);
+            ++Visited;
+        }
+        EXPECT_EQUAL(Visited, 100);
+        EXPECT_EQUAL(Sum, 5050);
+    );
+
+    TEST
+    (   "hash table keeps probing past tombstones",
+        collidingTable Table;
+        // More than a few groups' worth, so that probes need to go past full groups:
+        for (i64 Key = 0; Key < 100; ++Key)
+        {   insertKey(Table, Key);
+        }
+        for (i64 Key = 0; Key < 100; Key += 2)
+        {   Table.erase(Table.find(Key));
+        }
+        EXPECT_EQUAL(Table.count(), 50);
+        for (i64 Key = 0; Key < 100; ++Key)
+        {   EXPECT_EQUAL(Table.find(Key) >= 0, Key % 2 == 1);
+        }
+        // Tombstones get reused and don't make us grow forever:
+        const index Capacity = Table.capacity();
+        for (int Round = 0; Round < 10; ++Round)
+        {   for (i64 Key = 0; Key < 100; Key += 2)
+            {   insertKey(Table, Key);
+            }
+            for (i64 Key = 0; Key < 100; Key += 2)
+            {   Table.erase(Table.find(Key));
+            }
+        }
+        EXPECT_EQUAL(Table.capacity(), Capacity);
+        EXPECT_EQUAL(Table.count(), 50);
+        for (i64 Key = 1; Key < 100; Key += 2)
+        {   ASSERT(Table.find(Key) >= 0);
+        }
+    );
+
+    TEST
+    (   "hash table reserve avoids rehashing",
+        intTable Table;
+        Table.reserve(1000);
+        const index Capacity = Table.capacity();
+        ASSERT(Capacity >= 1000);
+        for (i64 Key = 0; Key < 1000; ++Key)
+        {   insertKey(Table, Key);
+        }
+        EXPECT_EQUAL(Table.capacity(), Capacity);
+    );
+
+    TEST
+    (   "hash table keeps its entries if it can't allocate a bigger table",
+        intTable Table;
+        for (i64 Key = 0; Key < 100; ++Key)
+        {   insertKey(Table, Key);
+        }
+        const index Capacity = Table.capacity();
+        // Too many slots to fit into memory:
+        EXPECT_THROW(Table.reserve(index(1) << 61), HashTableAllocationErrorMsg);
+        EXPECT_EQUAL(Table.capacity(), Capacity);
+        EXPECT_EQUAL(Table.count(), 100);
+        for (i64 Key = 0; Key < 100; ++Key)
+        {   ASSERT(Table.find(Key) >= 0);
+        }
+        insertKey(Table, 100);
+        EXPECT_EQUAL(Table.count(), 101);
+    );
+
+    TEST
+    (   "hash table constructs and destroys entries once",
+        {   countedTable Table;
+            for (i64 Key = 0; Key < 200; ++Key)
+            {   bool Inserted;
+                Table.insert
+                (   Key, determining<bool>(Inserted),
+                    [Key](counted *Slot) { new (Slot) counted(Key); }
+                );
+            }
+            EXPECT_EQUAL(counted::Live, 200);
+            Table.erase(Table.find(3));
+            EXPECT_EQUAL(counted::Live, 199);
+
+            countedTable Copy = Table;
+            EXPECT_EQUAL(counted::Live, 398);
+            ASSERT(Copy.find(4) >= 0);
+            EXPECT_EQUAL(Copy.find(3), -1);
+
+            countedTable Moved = std::move(Copy);
+            EXPECT_EQUAL(counted::Live, 398);
+            EXPECT_EQUAL(Copy.count(), 0);
+            EXPECT_EQUAL(Moved.count(), 199);
+
+            Moved.clear();
+            EXPECT_EQUAL(counted::Live, 199);
+            EXPECT_EQUAL(Moved.find(4), -1);
+        }
+        EXPECT_EQUAL(counted::Live, 0);
+    );
+}
+#endif
+
+TMVB
@@ -0,0 +1,427 @@
+#pragma once
+
+#include "arg.h"
+#include "error.h"
+#include "iterator.h"
+#include "memory.h"
+#include "optional.h"
+#include "types.h"
+
+#include <algorithm>    // std::max
+#include <bit>          // std::countr_zero
+#include <cstring>      // memcpy, memset
+#include <functional>   // std::hash
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+BVMT
+
+extern const char *const HashTableAllocationErrorMsg;
+
+namespace hashTableDetail
+{   // Each slot in a `hashTable` has a control byte, which is either `Empty`, `Deleted`,
+    // or (for a full slot) the lowest 7 bits of the hash of its key.
+    constexpr u8 Empty = 0x80;
+    constexpr u8 Deleted = 0xFE;
+
+    // Spreads the bits of `std::hash` (which is the identity for integers) over the whole word,
+    // since we use the low bits for the control byte and the high bits for the probe start.
+    inline u64 mix(size_t Hash)
+    {   const u64 Mixed = (u64)Hash * 0x9E3779B97F4A7C15ull;
+        return Mixed ^ (Mixed >> 32);
+    }
+
+    // A group of control bytes which are checked at the same time when probing.
+    // Each `match` returns a bitmask with bit `I` set if byte `I` of the group matches.
+    class group
+    {
+#if defined(__SSE2__)
+        __m128i Bytes;
+    public:
+        static constexpr index Width = 16;
+
+        explicit group(const u8 *Control)
+        :   Bytes(_mm_loadu_si128((const __m128i *)Control))
+        {}
+
+        inline u32 match(u8 Byte) const
+        {   return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8((char)Byte), Bytes));
+        }
+
+        // Empty and deleted control bytes are the only ones with their high bit set.
+        inline u32 matchEmptyOrDeleted() const
+        {   return (u32)_mm_movemask_epi8(Bytes);
+        }
+#else
+        u8 Bytes[8];
+    public:
+        static constexpr index Width = 8;
+
+        explicit group(const u8 *Control)
+        {   memcpy(Bytes, Control, Width);
+        }
+
+        inline u32 match(u8 Byte) const
+        {   u32 Mask = 0;
+            for (index I = 0; I < Width; ++I)
+            {   Mask |= (u32)(Bytes[I] == Byte) << I;
+            }
+            return Mask;
+        }
+
+        inline u32 matchEmptyOrDeleted() const
+        {   u32 Mask = 0;
+            for (index I = 0; I < Width; ++I)
+            {   Mask |= (u32)(Bytes[I] >> 7) << I;
+            }
+            return Mask;
+        }
+#endif
+        inline u32 matchEmpty() const
+        {   return match(Empty);
+        }
+
+        inline u32 matchFull() const
+        {   return ~matchEmptyOrDeleted() & ((1u << Width) - 1);
+        }
+    };
+
+    // Returns the index of the lowest set bit of a nonzero `match` result.
+    inline index firstMatch(u32 Mask)
+    {   return std::countr_zero(Mask);
+    }
+
+    // Picks the whole entry for `iteratorKernel`, e.g., for a `set`.
+    struct pickEntry
+    {   template <class e>
+        static inline auto &of(e &Entry)
+        {   return Entry;
+        }
+    };
+
+    // Static kernel for iterating over (part of) each entry in a `hashTable`, in slot order;
+    // see `staticIterator`.  `pick::of(entry &)` returns the `iteratorValue` for an entry.
+    template <class tablePointer, class iteratorValue, class pick> // e.g. (const hashTable<...> *, const t &, pickEntry)
+    class iteratorKernel
+    {   index Slot = -1;
+        index Seen = 0;
+        tablePointer Table;
+    public:
+        iteratorKernel(tablePointer _Table)
+        :   Table(_Table)
+        {}
+
+        inline optional<iteratorValue> next()
+        {   if ((Slot = Table->nextFull(Slot)) < 0)
+            {   // Don't start over on the next call:
+                Slot = Table->capacity();
+                return optional<iteratorValue>();
+            }
+            ++Seen;
+            return optional<iteratorValue>(pick::of(*Table->at(Slot)));
+        }
+
+        inline void nextBatch(iteratorBatch<iteratorValue> &Batch)
+        {   while (!Batch.full())
+            {   if ((Slot = Table->nextFull(Slot)) < 0)
+                {   Slot = Table->capacity();
+                    return;
+                }
+                ++Seen;
+                Batch.append(pick::of(*Table->at(Slot)));
+            }
+        }
+
+        inline countHint remainingCount() const
+        {   return countHint::exactly(Table->count() - Seen);
+        }
+    };
+}
+
+// A flat, open-addressing hash table of `entry`s, each of which contains a `key`
+// that can be found via `keyOf::of(const entry &)`.  This is the storage for `map` and `set`.
+// Slots are probed a group of control bytes at a time (using SSE2 where available),
+// so that most lookups only compare against keys that (probably) have the right hash.
+// Erased slots become tombstones unless no probe could have passed them, and inserting
+// rehashes into a bigger table when the full slots and tombstones reach 7/8 of the capacity.
+// WARNING! Rehashing moves all entries, so any pointers to entries (or slot indices)
+// are invalidated by an insert, but not by an erase.
+template <class entry, class key, class keyOf, class hasher = std::hash<key>>
+class hashTable
+{   // One control byte per slot; see `hashTableDetail::Empty`.
+    u8 *Control = Null;
+    entry *Slots = Null;
+    // Number of slots, always a power of two and a multiple of the group width (or zero).
+    index Capacity = 0;
+    index Count = 0;
+    // How many more entries we can insert into empty slots before we need to rehash.
+    index GrowthLeft = 0;
+
+    using group = hashTableDetail::group;
+public:
+    hashTable() {}
+
+    ~hashTable()
+    {   deallocate();
+    }
+
+    COPYABLE_TEMPLATE
+    (   hashTable, Table,
+        deallocate(),
+        if (Table.Capacity > 0)
+        {   allocate(Table.Capacity);
+            memcpy(Control, Table.Control, Capacity);
+            for (index Slot = Table.nextFull(-1); Slot >= 0; Slot = Table.nextFull(Slot))
+            {   memory::copyConstruct(&Slots[Slot], Table.Slots[Slot]);
+            }
+            Count = Table.Count;
+            GrowthLeft = Table.GrowthLeft;
+        }
+    )
+
+    MOVABLE_TEMPLATE
+    (   hashTable, Table,
+        deallocate(),
+        Control = Table.Control;
+        Slots = Table.Slots;
+        Capacity = Table.Capacity;
+        Count = Table.Count;
+        GrowthLeft = Table.GrowthLeft;
+        Table.Control = Null;
+        Table.Slots = Null;
+        Table.Capacity = 0;
+        Table.Count = 0;
+        Table.GrowthLeft = 0;
+    )
+
+    inline index count() const
+    {   return Count;
+    }
+
+    inline bool empty() const
+    {   return Count == 0;
+    }
+
+    // Number of slots, including empty ones.
+    inline index capacity() const
+    {   return Capacity;
+    }
+
+    inline entry *at(index Slot)
+    {   ASSERT(Slot >= 0 && Slot < Capacity && !(Control[Slot] & hashTableDetail::Empty));
+        return &Slots[Slot];
+    }
+
+    inline const entry *at(index Slot) const
+    {   ASSERT(Slot >= 0 && Slot < Capacity && !(Control[Slot] & hashTableDetail::Empty));
+        return &Slots[Slot];
+    }
+
+    // Returns the slot holding `Key`, or -1 if there is none.
+    index find(const key &Key) const
+    {   if (Count == 0)
+        {   return -1;
+        }
+        const u64 Hash = hashTableDetail::mix(hasher()(Key));
+        const u8 Hash7 = Hash & 0x7F;
+        const index GroupMask = Capacity / group::Width - 1;
+        index Group = (Hash >> 7) & GroupMask;
+        // Triangular probing visits every group once the step reaches the group count:
+        for (index Step = 1; ; ++Step)
+        {   const index GroupStart = Group * group::Width;
+            const group Bytes(Control + GroupStart);
+            for (u32 Mask = Bytes.match(Hash7); Mask != 0; Mask &= Mask - 1)
+            {   const index Slot = GroupStart + hashTableDetail::firstMatch(Mask);
+                if (keyOf::of(Slots[Slot]) == Key)
+                {   return Slot;
+                }
+            }
+            // An insert would have stopped here, so `Key` isn't in the table:
+            if (Bytes.matchEmpty() != 0)
+            {   return -1;
+            }
+            Group = (Group + Step) & GroupMask;
+        }
+    }
+
+    // Returns the slot holding `Key`; if there isn't one, `construct(entry *UninitializedSlot)`
+    // is called to fill a new slot (with an entry whose key equals `Key`) and `Inserted` is set.
+    template <class constructor>
+    index insert(const key &Key, determining<bool> Inserted, constructor construct)
+    {   index Slot = find(Key);
+        if (Slot >= 0)
+        {   Inserted = False;
+            return Slot;
+        }
+        if (GrowthLeft == 0)
+        {   rehash(capacityFor(Count + 1));
+        }
+        const u64 Hash = hashTableDetail::mix(hasher()(Key));
+        Slot = freeSlot(Hash);
+        construct(&Slots[Slot]);
+        if (Control[Slot] == hashTableDetail::Empty)
+        {   --GrowthLeft;
+        }
+        Control[Slot] = Hash & 0x7F;
+        ++Count;
+        Inserted = True;
+        return Slot;
+    }
+
+    // Destroys the entry in `Slot`.
+    void erase(index Slot)
+    {   ASSERT(Slot >= 0 && Slot < Capacity && !(Control[Slot] & hashTableDetail::Empty));
+        memory::deconstruct(&Slots[Slot]);
+        --Count;
+        // If this group still has an empty slot, no probe went past it looking for a free slot,
+        // so no lookup needs to go past it either, and we don't need a tombstone.
+        const index GroupStart = Slot / group::Width * group::Width;
+        if (group(Control + GroupStart).matchEmpty() != 0)
+        {   Control[Slot] = hashTableDetail::Empty;
+            ++GrowthLeft;
+        }
+        else
+        {   Control[Slot] = hashTableDetail::Deleted;
+        }
+    }
+
+    // Returns the first full slot after `Slot` (use -1 to start at the beginning),
+    // or -1 if there are no more.  Whole groups of empty slots are skipped at once.
+    index nextFull(index Slot) const
+    {   ++Slot;
+        while (Slot < Capacity)
+        {   const index GroupStart = Slot / group::Width * group::Width;
+            const u32 Mask = group(Control + GroupStart).matchFull() >> (Slot - GroupStart);
+            if (Mask != 0)
+            {   return Slot + hashTableDetail::firstMatch(Mask);
+            }
+            Slot = GroupStart + group::Width;
+        }
+        return -1;
+    }
+
+    // Calls `visit(Slot)` for every full slot, in one pass over the control bytes.
+    // `visit` may erase the slot it was called with, but must not insert.
+    template <class visitor>
+    void forEachFull(visitor visit) const
+    {   for (index GroupStart = 0; GroupStart < Capacity; GroupStart += group::Width)
+        {   for (u32 Mask = group(Control + GroupStart).matchFull(); Mask != 0; Mask &= Mask - 1)
+            {   visit(GroupStart + hashTableDetail::firstMatch(Mask));
+            }
+        }
+    }
+
+    // Makes room for `ForCount` entries in total, so that inserting that many won't rehash.
+    void reserve(index ForCount)
+    {   ASSERT(ForCount >= 0);
+        if (ForCount - Count > GrowthLeft)
+        {   rehash(capacityFor(std::max(ForCount, Count)));
+        }
+    }
+
+    // Destroys all entries but keeps the memory.
+    void clear()
+    {   for (index Slot = nextFull(-1); Slot >= 0; Slot = nextFull(Slot))
+        {   memory::deconstruct(&Slots[Slot]);
+        }
+        if (Capacity > 0)
+        {   memset(Control, hashTableDetail::Empty, Capacity);
+        }
+        Count = 0;
+        GrowthLeft = maxCount(Capacity);
+    }
+
+    // Destroys all entries and frees the memory.  The table can still be used afterwards.
+    void deallocate()
+    {   for (index Slot = nextFull(-1); Slot >= 0; Slot = nextFull(Slot))
+        {   memory::deconstruct(&Slots[Slot]);
+        }
+        if (Capacity > 0)
+        {   memory::deallocate(Control);
+            memory::deallocate(Slots);
+        }
+        Control = Null;
+        Slots = Null;
+        Capacity = 0;
+        Count = 0;
+        GrowthLeft = 0;
+    }
+
+private:
+    // Full slots (and tombstones) can take up to 7/8 of the table, so that probes stay short
+    // and every probe sequence is guaranteed to hit an empty slot.
+    static inline index maxCount(index ForCapacity)
+    {   return ForCapacity - ForCapacity / 8;
+    }
+
+    static index capacityFor(index ForCount)
+    {   index Result = group::Width;
+        while (maxCount(Result) < ForCount)
+        {   Result *= 2;
+        }
+        return Result;
+    }
+
+    // Sets up empty storage for `NewCapacity` slots, without freeing the old storage.
+    // If that fails, this throws and leaves the table (i.e., the old storage) alone.
+    void allocate(index NewCapacity)
+    {   entry *NewSlots = memory::allocate<entry>(NewCapacity, "hashTable");
+        if (NewSlots == Null)
+        {   throw error(HashTableAllocationErrorMsg, AT);
+        }
+        u8 *NewControl = memory::allocate<u8>(NewCapacity, "hashTable");
+        if (NewControl == Null)
+        {   memory::deallocate(NewSlots);
+            throw error(HashTableAllocationErrorMsg, AT);
+        }
+        memset(NewControl, hashTableDetail::Empty, NewCapacity);
+        Control = NewControl;
+        Slots = NewSlots;
+        Capacity = NewCapacity;
+        Count = 0;
+        GrowthLeft = maxCount(NewCapacity);
+    }
+
+    // Returns the first empty or deleted slot in the probe sequence for `Hash`.
+    index freeSlot(u64 Hash) const
+    {   const index GroupMask = Capacity / group::Width - 1;
+        index Group = (Hash >> 7) & GroupMask;
+        for (index Step = 1; ; ++Step)
+        {   const index GroupStart = Group * group::Width;
+            const u32 Mask = group(Control + GroupStart).matchEmptyOrDeleted();
+            if (Mask != 0)
+            {   return GroupStart + hashTableDetail::firstMatch(Mask);
+            }
+            Group = (Group + Step) & GroupMask;
+        }
+    }
+
+    // Moves every entry into new storage with `NewCapacity` slots, dropping all tombstones.
+    // The old storage is kept until the new storage is allocated, so a failure keeps every entry.
+    void rehash(index NewCapacity)
+    {   u8 *OldControl = Control;
+        entry *OldSlots = Slots;
+        const index OldCapacity = Capacity;
+        const index OldCount = Count;
+        allocate(NewCapacity);
+        for (index Slot = 0; Slot < OldCapacity; ++Slot)
+        {   if (OldControl[Slot] & hashTableDetail::Empty)
+            {   continue;
+            }
+            const u64 Hash = hashTableDetail::mix(hasher()(keyOf::of(OldSlots[Slot])));
+            const index NewSlot = freeSlot(Hash);
+            memory::moveConstruct(&Slots[NewSlot], std::move(OldSlots[Slot]));
+            memory::deconstruct(&OldSlots[Slot]);
+            Control[NewSlot] = Hash & 0x7F;
+        }
+        Count = OldCount;
+        GrowthLeft -= OldCount;
+        if (OldCapacity > 0)
+        {   memory::deallocate(OldControl);
+            memory::deallocate(OldSlots);
+        }
+    }
+};
+
+TMVB
@@ -3,6 +3,8 @@
 #ifndef NDEBUG
 #include "array.h"
 #include "string.h"
+
+#include <vector>
 #endif
 
 BVMT
@@ -46,6 +48,33 @@ iterator<noisy &> test::noisyIterator(int Count)
 {   return noisyKernel::toIterator(Count);
 }
 
+// Like `noisyKernel` but small enough to live inside its iterator, unless `bytes` is large.
+template <size_t bytes>
+class sizedNoisyKernel : public iteratorKernel<noisy &>
+{   noisy Noisy;
+    u8 Padding[bytes];
+    sizedNoisyKernel(int Count)
+    :   iteratorKernel<noisy &>
+        ({  .next = [](iteratorKernel<noisy &> *BaseKernelSelf)
+            {   CAST_DEFINE(sizedNoisyKernel *, Self, BaseKernelSelf);
+                if (Self->Noisy.Value > 0)
+                {   --(Self->Noisy.Value);
+                    return optional<noisy &>(Self->Noisy);
+                }
+                return optional<noisy &>();
+            },
+        }),
+        Noisy(Count)
+    {}
+public:
+    sizedNoisyKernel(sizedNoisyKernel &&Other)
+    :   iteratorKernel<noisy &>(Other),
+        Noisy(std::move(Other.Noisy))
+    {}
+
+    KERNEL_TO_ITERATOR(sizedNoisyKernel, noisy &, (int Count), (Count));
+};
+
 void test__core__iterator()
 {   TEST
     (   "iterator works with custom functions (and does cleanup)",
@@ -220,6 +249,213 @@ void test__core__iterator()
         // TODO: add tests changing types using optional, e.g., int to string
     );
 
+    TEST
+    (   "staticIterator works",
+        TEST
+        (   "iteratorRange::values works in a for-loop",
+            int I = 3;
+            for (int R : iteratorRange<int>({.Start = 3, .EndBefore = 10}).values())
+            {   EXPECT_EQUAL(R, I++);
+            }
+            EXPECT_EQUAL(I, 10);
+        );
+
+        TEST
+        (   "can map and filter without copying the parent's values",
+            array<noisy> Noisies({noisy(1), noisy(2), noisy(3), noisy(4)});
+            ASSERT_STRING(TestPrintOutput.pull(), contains("noisy")); // ignore construction noise
+            array<int> Result = Noisies.values().$ iterate<int>
+            (   [](noisy &Noisy)
+                {   return Noisy.Value % 2 == 0 ? optional<int>(10 * Noisy.Value) : optional<int>();
+                }
+            );
+            EXPECT_EQUAL(Result, array<int>({20, 40}));
+            EXPECT_EQUAL(TestPrintOutput.pull(), "");
+        );
+
+        TEST
+        (   "can chain iterates on a temporary",
+            array<int> Result = iteratorRange<int>({.EndBefore = 20}).values()
+                .$ iterate<int>([](int &Int) { return optional<int>(Int * Int); })
+                .$ iterate<int>
+                (   [](int &Int)
+                    {   return Int % 3 == 0 ? optional<int>(Int) : optional<int>();
+                    }
+                );
+            EXPECT_EQUAL(Result, array<int>({0, 9, 36, 81, 144, 225, 324}));
+        );
+
+        TEST
+        (   "parent and child share state when the parent outlives the child",
+            auto ParentIterator = iteratorRange<int>({.EndBefore = 10}).values();
+            {   auto ChildIterator = ParentIterator.$ iterate<int>
+                (   [](int &Int)
+                    {   return Int % 3 == 0 ? optional<int>(Int) : optional<int>();
+                    }
+                );
+                EXPECT_POINTER_EQUAL(ChildIterator.next(), 0);
+                EXPECT_POINTER_EQUAL(ChildIterator.next(), 3);
+                EXPECT_POINTER_EQUAL(ParentIterator.next(), 4);
+                EXPECT_POINTER_EQUAL(ChildIterator.next(), 6);
+            }
+            EXPECT_EQUAL(array<int>(std::move(ParentIterator)), array<int>({7, 8, 9}));
+        );
+
+        TEST
+        (   "checkAny works",
+            array<int> Array({5, 7, 9});
+            EXPECT_EQUAL(Array.values().checkAny([](int Int) { return Int > 8; }), True);
+            EXPECT_EQUAL(Array.values().checkAny([](int Int) { return Int < 5; }), False);
+        );
+
+        TEST
+        (   "can be type-erased into an iterator",
+            array<int> Array({1, 2, 3});
+            iterator<int &> Iterator = Array.values();
+            for (int &Int : Iterator)
+            {   Int *= 2;
+            }
+            EXPECT_EQUAL(Array, array<int>({2, 4, 6}));
+
+            iterator<int> Mapped = Array.values().$ iterate<int>
+            (   [](int &Int) { return optional<int>(Int + 1); }
+            ).toIterator();
+            EXPECT_POINTER_EQUAL(Mapped.next(), 3);
+            EXPECT_EQUAL(array<int>(std::move(Mapped)), array<int>({5, 7}));
+        );
+    );
+
+    TEST
+    (   "nextBatch works",
+        TEST
+        (   "ranges fill batches until they're done",
+            auto Range = iteratorRange<int>({.Start = 1, .EndBefore = 101}).values();
+            iteratorBatch<int> Batch;
+            EXPECT_EQUAL(Range.nextBatch(Batch), iteratorBatch<int>::Capacity);
+            EXPECT_EQUAL(Batch[0], 1);
+            EXPECT_EQUAL(Batch[iteratorBatch<int>::Capacity - 1], iteratorBatch<int>::Capacity);
+            EXPECT_EQUAL(Range.nextBatch(Batch), 100 - iteratorBatch<int>::Capacity);
+            EXPECT_EQUAL(Batch[Batch.count() - 1], 100);
+            EXPECT_EQUAL(Range.nextBatch(Batch), 0);
+        );
+
+        TEST
+        (   "array batches refer to the array's elements",
+            array<int> Array({1, 2, 3});
+            iterator<int &> Iterator = Array.values();
+            EXPECT_POINTER_EQUAL(Iterator.next(), 1);
+            iteratorBatch<int &> Batch;
+            EXPECT_EQUAL(Iterator.nextBatch(Batch), 2);
+            EXPECT_EQUAL(&Batch[0], &Array[1]);
+            EXPECT_EQUAL(&Batch[1], &Array[2]);
+            EXPECT_EQUAL(Iterator.nextBatch(Batch), 0);
+        );
+
+        TEST
+        (   "filter/map kernels batch their parent's values",
+            array<int> Array = iterator<int>::range(200).$ iterate<int>
+            (   [](int &Int) { return Int % 3 == 0 ? optional<int>(Int / 3) : optional<int>(); }
+            );
+            EXPECT_EQUAL(Array, array<int>(iterator<int>::range(67)));
+
+            array<int> StaticArray = iteratorRange<int>({.EndBefore = 200}).values().$ iterate<int>
+            (   [](int &Int) { return Int >= 190 ? optional<int>(Int) : optional<int>(); }
+            );
+            EXPECT_EQUAL(StaticArray, array<int>({190, 191, 192, 193, 194, 195, 196, 197, 198, 199}));
+        );
+
+        TEST
+        (   "rune batches decode multi-byte runes",
+            iteratorBatch<rune> Batch;
+            string String("añb");
+            auto Runes = String.runes();
+            EXPECT_EQUAL(Runes.nextBatch(Batch), 3);
+            EXPECT_EQUAL(Batch[0], 'a');
+            EXPECT_EQUAL(Batch[1], 241);
+            EXPECT_EQUAL(Batch[2], 'b');
+        );
+
+        TEST
+        (   "kernels without batch support return one reference at a time",
+            {   iterator<noisy &> NoisyIterator = test::noisyIterator(2);
+                iteratorBatch<noisy &> Batch;
+                EXPECT_EQUAL(NoisyIterator.nextBatch(Batch), 1);
+                EXPECT_EQUAL(Batch[0].Value, 1);
+                EXPECT_EQUAL(NoisyIterator.nextBatch(Batch), 1);
+                EXPECT_EQUAL(Batch[0].Value, 0);
+                EXPECT_EQUAL(NoisyIterator.nextBatch(Batch), 0);
+            }
+            EXPECT_EQUAL(TestPrintOutput.pull(), "noisy(2)~noisyKernel()~noisy(0)");
+        );
+    );
+
+    TEST
+    (   "iterator keeps small kernels inline",
+        TEST
+        (   "bvmt kernels don't need the heap",
+            EXPECT_EQUAL(iterator<int>::range(10).kernelIsInline(), True);
+            array<int> Array({1, 2, 3});
+            iterator<int &> Iterator = Array.values();
+            EXPECT_EQUAL(Iterator.kernelIsInline(), True);
+            iterator<int> Child = Iterator.$ iterate<int>([](int &Int) { return optional<int>(Int); });
+            EXPECT_EQUAL(Child.kernelIsInline(), True);
+            // Except for a parent, so that its kernel stays put for the child:
+            EXPECT_EQUAL(Iterator.kernelIsInline(), False);
+        );
+
+        TEST
+        (   "inline kernels are moved along with the iterator and cleaned up once",
+            {   iterator<noisy &> Iterator = sizedNoisyKernel<8>::toIterator(3);
+                EXPECT_EQUAL(Iterator.kernelIsInline(), True);
+                EXPECT_EQUAL(TestPrintOutput.pull(), "noisy(3)");
+                EXPECT_EQUAL(Iterator.next()->Value, 2);
+                iterator<noisy &> Moved(std::move(Iterator));
+                EXPECT_EQUAL(TestPrintOutput.pull(), "noisy(2){MC}~noisy(-2)");
+                EXPECT_EQUAL(Moved.next()->Value, 1);
+                Iterator = std::move(Moved);
+                EXPECT_EQUAL(TestPrintOutput.pull(), "noisy(1){MC}~noisy(-1)");
+                EXPECT_EQUAL(Iterator.next()->Value, 0);
+                EXPECT_EQUAL(Iterator.next(), Null);
+            }
+            EXPECT_EQUAL(TestPrintOutput.pull(), "~noisy(0)");
+        );
+
+        TEST
+        (   "large kernels go on the heap",
+            {   iterator<noisy &> Iterator = sizedNoisyKernel<256>::toIterator(2);
+                EXPECT_EQUAL(Iterator.kernelIsInline(), False);
+                iterator<noisy &> Moved(std::move(Iterator));
+                EXPECT_EQUAL(TestPrintOutput.pull(), "noisy(2)");
+                EXPECT_EQUAL(Moved.next()->Value, 1);
+            }
+            EXPECT_EQUAL(TestPrintOutput.pull(), "~noisy(1)");
+        );
+
+        TEST
+        (   "a parent can be moved while its child is in use",
+            std::vector<iterator<int>> Parents;
+            Parents.push_back(iterator<int>::range(4));
+            iterator<int> Child = Parents[0].$ iterate<int>
+            (   [](int &Int) { return optional<int>(Int + 100); }
+            );
+            EXPECT_EQUAL(Child.next(), 100);
+            // Growing the vector moves the parent:
+            for (int I = 0; I < 10; ++I)
+            {   Parents.push_back(iterator<int>::range(I));
+            }
+            iterator<int> Moved = std::move(Parents[0]);
+            EXPECT_EQUAL(array<int>(std::move(Child)), array<int>({101, 102, 103}));
+        );
+
+        TEST
+        (   "an inline parent can be descoped before its child",
+            iterator<int> Child = iterator<int>::range(5).$ iterate<int>
+            (   [](int &Int) { return optional<int>(Int * 10); }
+            );
+            EXPECT_EQUAL(array<int>(std::move(Child)), array<int>({0, 10, 20, 30, 40}));
+        );
+    );
+
     TEST
     (   "testing new/delete on a void* for some reason",
         void *Void = new noisy(3);
@@ -5,16 +5,34 @@
 #include "pointer.h" 
 #include "types.h" 
 
+#include <cstddef> // std::max_align_t
 #include <iterator>
+#include <new> // placement new
+#include <type_traits>
 
 BVMT
 
+// Pulls values out of `Iterator` a batch at a time (see `iterator::nextBatch`),
+// running `loopLogic` on each value, which is available as `TypeVar`.
+#define ITERATOR_BATCH_LOOP(Iterator, type, TypeVar, loopLogic) \
+    {   iteratorBatch<type> IteratorBatch; \
+        while (Iterator.nextBatch(IteratorBatch) > 0) \
+        {   for (index BatchIndex = 0; BatchIndex < IteratorBatch.count(); ++BatchIndex) \
+            {   type TypeVar = std::forward<type>(IteratorBatch[BatchIndex]); \
+                loopLogic; \
+            } \
+        } \
+    }
+
 #define ITERATOR_CONSTRUCTOR_TEMPLATE_BASE(x, preLoopLogic, type, TypeVar, loopLogic) \
     x(iterator<type> Iterator) \
     {   preLoopLogic; \
-        for (type TypeVar : Iterator) \
-        {   loopLogic; \
-        } \
+        ITERATOR_BATCH_LOOP(Iterator, type, TypeVar, loopLogic) \
+    } \
+    template <class staticKernel> \
+    x(staticIterator<type, staticKernel> Iterator) \
+    {   preLoopLogic; \
+        ITERATOR_BATCH_LOOP(Iterator, type, TypeVar, loopLogic) \
     }
 
 #define ITERATOR_CONSTRUCTOR_TEMPLATES(x, preLoopLogic, type, TypeVar, loopLogic) \
@@ -25,9 +43,13 @@ BVMT
 #define ITERATOR_ASSIGNMENT_TEMPLATE_BASE(x, logicBeforeAssignment, type, TypeVar, loopLogic) \
     x &operator = (iterator<type> &&Iterator) \
     {   logicBeforeAssignment; \
-        for (type TypeVar : Iterator) \
-        {   loopLogic; \
-        } \
+        ITERATOR_BATCH_LOOP(Iterator, type, TypeVar, loopLogic) \
+        return This; \
+    } \
+    template <class staticKernel> \
+    x &operator = (staticIterator<type, staticKernel> &&Iterator) \
+    {   logicBeforeAssignment; \
+        ITERATOR_BATCH_LOOP(Iterator, type, TypeVar, loopLogic) \
         return This; \
     }
 
@@ -39,9 +61,13 @@ BVMT
 #define ITERATOR_PLUS_EQUAL_TEMPLATE_BASE(x, preLogic, type, TypeVar, loopLogic) \
     x &operator += (iterator<type> &&Iterator) \
     {   preLogic; \
-        for (type TypeVar : Iterator) \
-        {   loopLogic; \
-        } \
+        ITERATOR_BATCH_LOOP(Iterator, type, TypeVar, loopLogic) \
+        return This; \
+    } \
+    template <class staticKernel> \
+    x &operator += (staticIterator<type, staticKernel> &&Iterator) \
+    {   preLogic; \
+        ITERATOR_BATCH_LOOP(Iterator, type, TypeVar, loopLogic) \
         return This; \
     }
 
@@ -50,19 +76,13 @@ BVMT
     ITERATOR_PLUS_EQUAL_TEMPLATE_BASE(x, preLogic, type &, TypeVar, loopLogic) \
     ITERATOR_PLUS_EQUAL_TEMPLATE_BASE(x, preLogic, const type &, TypeVar, loopLogic)
 
+// Constructs the kernel inside the iterator if it fits (see `iterator::of`), otherwise on the heap.
 #define KERNEL_TO_ITERATOR_LOGIC(kernelType, iteratorValue, args, Args) \
-{   return iterator<iteratorValue> \
-    (   pointer<iteratorKernel<iteratorValue>> \
-        (   new kernelType Args, \
-            [](iteratorKernel<iteratorValue> *Kernel) \
-            {   /* need to cast to the real type for the destructor to work properly: */ \
-                delete (kernelType *)Kernel; \
-            } \
-        ) \
-    ); \
+{   return iterator<iteratorValue>::$ of<kernelType> Args; \
 }
 
 #define KERNEL_TO_ITERATOR_H(kernelType, iteratorValue, args, Args) \
+    friend class iterator<iteratorValue>; \
     static iterator<iteratorValue> toIterator args;
 
 #define KERNEL_TO_ITERATOR_CC(kernelType, iteratorValue, args, Args) \
@@ -70,12 +90,116 @@ BVMT
     KERNEL_TO_ITERATOR_LOGIC(SAFE((kernelType)), iteratorValue, args, Args)
 
 #define KERNEL_TO_ITERATOR(kernelType, iteratorValue, args, Args) \
+    friend class iterator<iteratorValue>; \
     static iterator<iteratorValue> toIterator args \
     KERNEL_TO_ITERATOR_LOGIC(SAFE((kernelType)), iteratorValue, args, Args)
 
 template <class t>
 class iterator;
 
+template <class t, class kernel>
+class staticIterator;
+
+namespace detail
+{   template <class t>
+    class iteratorRangeKernel;
+}
+
+// How many values an iterator has left, as far as its kernel knows; see `iterator::remainingCount`.
+struct countHint
+{   // There are at least this many values left.
+    index AtLeast = 0;
+    // There are at most this many values left, or -1 if unknown.
+    index AtMost = -1;
+
+    inline bool exact() const
+    {   return AtLeast == AtMost;
+    }
+
+    static inline countHint exactly(index Count)
+    {   return countHint({.AtLeast = Count, .AtMost = Count});
+    }
+};
+
+// A fixed-capacity buffer of values pulled out of an iterator in one go (see `iterator::nextBatch`),
+// so that consumers don't pay for a `next` call and an `optional` per value.
+// Values of a reference type are stored as pointers, so nothing gets copied.
+template <class t>
+class iteratorBatch
+{   using slot = std::conditional_t<std::is_reference_v<t>, std::remove_reference_t<t> *, t>;
+public:
+    static constexpr index Capacity = 64;
+private:
+    index Count = 0;
+    alignas(slot) u8 Slots[Capacity * sizeof(slot)];
+
+    inline slot *slots()
+    {   return (slot *)Slots;
+    }
+public:
+    iteratorBatch() {}
+
+    UNCOPYABLE_CLASS(iteratorBatch)
+
+    ~iteratorBatch() { clear(); }
+
+    inline index count() const
+    {   return Count;
+    }
+
+    // How many more values can be appended.
+    inline index room() const
+    {   return Capacity - Count;
+    }
+
+    inline bool full() const
+    {   return Count >= Capacity;
+    }
+
+    template <class u>
+    inline void append(u &&Value)
+    {   ASSERT(Count < Capacity);
+        if constexpr (std::is_reference_v<t>)
+        {   slots()[Count] = &Value;
+        }
+        else
+        {   new (slots() + Count) slot(std::forward<u>(Value));
+        }
+        ++Count;
+    }
+
+    // For plain values, kernels can write up to `room()` values straight into the batch
+    // (e.g., from a bulk decoder) starting here, then call `appended` with how many they wrote.
+    template <class u = t> requires (!std::is_reference_v<u> && std::is_trivially_copyable_v<u>)
+    inline u *unfilled()
+    {   return slots() + Count;
+    }
+
+    inline void appended(index Added)
+    {   ASSERT(Added >= 0 && Count + Added <= Capacity);
+        Count += Added;
+    }
+
+    inline t &operator[] (index Index)
+    {   ASSERT(Index >= 0 && Index < Count);
+        if constexpr (std::is_reference_v<t>)
+        {   return *slots()[Index];
+        }
+        else
+        {   return slots()[Index];
+        }
+    }
+
+    void clear()
+    {   if constexpr (!std::is_trivially_destructible_v<slot>)
+        {   for (index I = 0; I < Count; ++I)
+            {   slots()[I].~slot();
+            }
+        }
+        Count = 0;
+    }
+};
+
 /*
 C++ doesn't do generics (templates) with polymorphism (virtual/overloading methods)
 so a generic function that needs overloads needs functions to be passed into it to define those methods.
@@ -89,12 +213,18 @@ template <class t>
 struct iteratorKernel
 {   using basePtr = iteratorKernel<t> *;
     // pass in the basePtr type, but you should cast it to whatever your iteratorKernel child-class is.
-    fn<optional<t>(basePtr)> next;
+    // this is a plain function pointer (not an `fn`) so that each `next` is a single indirect call.
+    optional<t> (*next)(basePtr);
+    // optional, for kernels that can produce many values at once.  appends up to a batch's `room()`
+    // of values to an empty batch, and should only leave the batch empty when there are no more values.
+    // if Null, `iterator::nextBatch` falls back to calling `next`.
+    void (*nextBatch)(basePtr, iteratorBatch<t> &) = Null;
+    // optional, returns how many more values `next` will return; if Null, nothing is known.
+    countHint (*remainingCount)(basePtr) = Null;
     // TODO: add support for these, as well as for checking if they are present inside iterator.
     //fn<const t(basePtr)> peak;
     //fn<t(basePtr)> previous;
     //fn<valueType(basePtr)> take;
-    //fn<index(basePtr)> remainingCount;
     // TODO: double check that we need to do the `pointer` route
 };
 
@@ -112,6 +242,10 @@ struct iteratorRange
     // Iterate but stop before this value.
     t EndBefore = 0;
     // TODO: step
+
+    // Returns a `staticIterator` over [Start, EndBefore), which compiles down to a plain for-loop.
+    // Use `iterator<t>::range` if you need a type-erased iterator instead.
+    inline staticIterator<t, detail::iteratorRangeKernel<t>> values() const;
 };
 
 
@@ -205,14 +339,53 @@ struct iteratorRange
 
 
 namespace detail
-{   // TODO: maybe create a wrapper around standard STL iterators, e.g.
+{   // Fills `Batch` by calling `next` (which returns an `optional<t>`) until the batch is full.
+    // Kernels might reuse the same instance for each reference they return (e.g., a member
+    // variable), so we only take one value at a time for reference types.
+    template <class t, class nexter>
+    inline void fillBatchViaNext(iteratorBatch<t> &Batch, nexter next)
+    {   do
+        {   optional<t> T = next();
+            if (T == Null)
+            {   return;
+            }
+            Batch.append(std::forward<t>(*T));
+        }   while (!std::is_reference_v<t> && !Batch.full());
+    }
+
+    // Fills `Batch` from a static kernel (see `staticIterator`), using the kernel's own
+    // `nextBatch(iteratorBatch<t> &)` method if it has one.  Returns the number of values.
+    template <class t, class kernel>
+    inline index nextBatch(kernel &Kernel, iteratorBatch<t> &Batch)
+    {   Batch.clear();
+        if constexpr (requires { Kernel.nextBatch(Batch); })
+        {   Kernel.nextBatch(Batch);
+        }
+        else
+        {   fillBatchViaNext(Batch, [&Kernel]() { return Kernel.next(); });
+        }
+        return Batch.count();
+    }
+
+    // Returns a static kernel's hint from its `countHint remainingCount() const` method, if it has one.
+    template <class kernel>
+    inline countHint remainingCount(const kernel &Kernel)
+    {   if constexpr (requires { Kernel.remainingCount(); })
+        {   return Kernel.remainingCount();
+        }
+        else
+        {   return countHint();
+        }
+    }
+
+    // TODO: maybe create a wrapper around standard STL iterators, e.g.
     // template <class t, class stlItr>
     // so it's easy to port more stl iterators.  or not...
 
     // Buffers a `next` value from the iterator.
-    template <class t>
+    template <class t, class iteratorType = iterator<t>>
     class stlIterator 
-    {   iterator<t> *Iterator;
+    {   iteratorType *Iterator;
         optional<t> CurrentValue;
     public:
         using value_type = typename std::remove_reference<t>::type;
@@ -223,7 +396,7 @@ namespace detail
         // TODO: do not use differences of the iterator, these details should be ignored:
         //using difference_type = NOT std::ptrdiff_t;
 
-        stlIterator(iterator<t> *_Iterator, bool AtEnd)
+        stlIterator(iteratorType *_Iterator, bool AtEnd)
         :   Iterator(_Iterator)
         {   if (!AtEnd)
             {   CurrentValue = Iterator->next();
@@ -253,37 +426,83 @@ namespace detail
         }
     };
 
+    // Static kernel for `iteratorRange`; see `staticIterator` for what a static kernel is.
     template <class t>
-    class iteratorRangeKernel : public iteratorKernel<t>
+    class iteratorRangeKernel
     {   t Index; // current index while iterating.
         t EndBefore; // don't return this index when iterating.
-
+    public:
         iteratorRangeKernel(iteratorRange<t> Range)
-        :   iteratorKernel<t>
-            ({  .next = [](iteratorKernel<t> *BaseKernelSelf)
-                {   CAST_DEFINE
-                    (   iteratorRangeKernel<t> *,
-                        Self,
-                        BaseKernelSelf
-                    );
-                    if (Self->Index + t(1) < Self->EndBefore)
-                    {   return optional<t>(++(Self->Index));
-                    }
-                    return optional<t>();
-                },
-            }),
-            Index(Range.Start - t(1)),
+        :   Index(Range.Start - t(1)),
             EndBefore(Range.EndBefore)
         {}
+
+        inline optional<t> next()
+        {   if (Index + t(1) < EndBefore)
+            {   return optional<t>(++Index);
+            }
+            return optional<t>();
+        }
+
+        inline void nextBatch(iteratorBatch<t> &Batch)
+        {   while (!Batch.full() && Index + t(1) < EndBefore)
+            {   Batch.append(++Index);
+            }
+        }
+
+        inline countHint remainingCount() const
+        {   t Remaining = EndBefore - (Index + t(1));
+            if (!(Remaining > t(0)))
+            {   return countHint::exactly(0);
+            }
+            // round up for non-integer types, e.g., [0.0, 2.5) has 3 values.
+            index Count = (index)Remaining;
+            if (t(Count) < Remaining)
+            {   ++Count;
+            }
+            return countHint::exactly(Count);
+        }
+    };
+
+    // Static version of `iteratorKernelFilterMap`, which knows the concrete types of
+    // its parent kernel and mapping function so that the compiler can inline both.
+    // `parentKernel` is a reference type if the parent iterator outlives this kernel.
+    template <class t, class u, class parentKernel, class mapper>
+    class staticFilterMapKernel
+    {   parentKernel Parent;
+        mapper mapTToU;
     public:
-        static pointer<iteratorKernel<t>> destructible(iteratorRange<t> Range)
-        {   return pointer<iteratorKernel<t>>
-            (   new iteratorRangeKernel<t>(Range),
-                [](iteratorKernel<t> *Kernel)
-                {   // need to cast to the real type for the destructor to work properly:
-                    delete (iteratorRangeKernel<t> *)Kernel;
+        staticFilterMapKernel(parentKernel _Parent, mapper _mapTToU)
+        :   Parent(std::forward<parentKernel>(_Parent)),
+            mapTToU(std::move(_mapTToU))
+        {}
+
+        inline optional<u> next()
+        {   for (optional<t> T = Parent.next(); T != Null; T = Parent.next())
+            {   optional<u> U = mapTToU(*T);
+                if (U != Null)
+                    return U;
+            }
+            return optional<u>();
+        }
+
+        // Maps a whole batch of parent values at a time.  The parent's batch can't be
+        // bigger than ours, so every mapped value always fits.
+        inline void nextBatch(iteratorBatch<u> &Batch)
+        {   iteratorBatch<t> ParentBatch;
+            while (Batch.count() == 0 && detail::nextBatch(Parent, ParentBatch) > 0)
+            {   for (index I = 0; I < ParentBatch.count(); ++I)
+                {   optional<u> U = mapTToU(ParentBatch[I]);
+                    if (U != Null)
+                    {   Batch.append(std::forward<u>(*U));
+                    }
                 }
-            );
+            }
+        }
+
+        // Any parent value can be filtered out, so we only know an upper bound.
+        inline countHint remainingCount() const
+        {   return countHint({.AtMost = detail::remainingCount(Parent).AtMost});
         }
     };
 
@@ -314,36 +533,202 @@ namespace detail
                             return U;
                     }
                     return optional<u>();
-                }
+                },
+                // Like `staticFilterMapKernel::nextBatch`, all mapped values fit in the batch.
+                .nextBatch = [](iteratorKernel<u> *BaseKernelSelf, iteratorBatch<u> &Batch)
+                {   CAST_DEFINE
+                    (   SAFE((iteratorKernelFilterMap<t, refT, u>)) *,
+                        Self,
+                        BaseKernelSelf
+                    );
+                    iteratorBatch<t> ParentBatch;
+                    while (Batch.count() == 0 && nextParentBatch(Self->ParentKernel, ParentBatch) > 0)
+                    {   for (index I = 0; I < ParentBatch.count(); ++I)
+                        {   optional<u> U = Self->mapTToU(ParentBatch[I]);
+                            if (U != Null)
+                            {   Batch.append(std::forward<u>(*U));
+                            }
+                        }
+                    }
+                },
+                // Any parent value can be filtered out, so we only know an upper bound.
+                .remainingCount = [](iteratorKernel<u> *BaseKernelSelf)
+                {   CAST_DEFINE
+                    (   SAFE((iteratorKernelFilterMap<t, refT, u>)) *,
+                        Self,
+                        BaseKernelSelf
+                    );
+                    iteratorKernel<t> *Parent = &*Self->ParentKernel;
+                    return Parent->remainingCount != Null
+                        ?   countHint({.AtMost = Parent->remainingCount(Parent).AtMost})
+                        :   countHint();
+                },
             }),
             ParentKernel(std::move(_ParentKernel)),
-            mapTToU(_mapTToU)
+            mapTToU(std::move(_mapTToU))
         {}
-    public:
-        static pointer<iteratorKernel<u>> destructible
-        (   pointer<iteratorKernel<t>> _ParentKernel,
-            fn<optional<u>(refT)> _mapTToU
-        )
-        {   return pointer<iteratorKernel<u>>
-            (   new iteratorKernelFilterMap<t, refT, u>(std::move(_ParentKernel), _mapTToU),
-                [](iteratorKernel<u> *Kernel)
-                {   // need to cast to the real type for the destructor to work properly:
-                    delete (iteratorKernelFilterMap<t, refT, u> *)Kernel;
-                }
-            );
+
+        static index nextParentBatch(pointer<iteratorKernel<t>> &ParentKernel, iteratorBatch<t> &Batch)
+        {   Batch.clear();
+            if (ParentKernel->nextBatch != Null)
+            {   ParentKernel->nextBatch(&*ParentKernel, Batch);
+            }
+            else
+            {   fillBatchViaNext(Batch, [&ParentKernel]() { return ParentKernel->next(&*ParentKernel); });
+            }
+            return Batch.count();
         }
+    public:
+        KERNEL_TO_ITERATOR
+        (   iteratorKernelFilterMap<t AND refT AND u>,
+            u,
+            (pointer<iteratorKernel<t>> _ParentKernel, fn<optional<u>(refT)> _mapTToU),
+            (std::move(_ParentKernel), std::move(_mapTToU))
+        );
     };
 }
 
 template <class t>
 class iterator
-{   pointer<iteratorKernel<t>> Kernel;
+{   // Kernels up to this size (e.g., everything made via `KERNEL_TO_ITERATOR` in bvmt)
+    // are constructed inside the iterator itself, so creating an iterator doesn't allocate.
+    static constexpr size_t InlineKernelBytes = 128;
+
+    // Type-specific logic for a kernel living in `InlineKernel`.  These are plain
+    // function pointers so that an inline kernel never needs an `fn` to be cleaned up.
+    struct inlineKernelOps
+    {   // Move-constructs the kernel into `To` and destroys the original; returns the new kernel.
+        iteratorKernel<t> *(*relocate)(iteratorKernel<t> *From, u8 *To);
+        // Moves the kernel to the heap and destroys the original; returns the owning heap pointer.
+        pointer<iteratorKernel<t>> (*relocateToHeap)(iteratorKernel<t> *From);
+        void (*destroy)(iteratorKernel<t> *Kernel);
+    };
+
+    template <class kernelType>
+    static constexpr inlineKernelOps InlineKernelOpsFor =
+    {   .relocate = [](iteratorKernel<t> *From, u8 *To) -> iteratorKernel<t> *
+        {   kernelType *Typed = (kernelType *)From;
+            kernelType *Moved = new (To) kernelType(std::move(*Typed));
+            Typed->~kernelType();
+            return Moved;
+        },
+        .relocateToHeap = [](iteratorKernel<t> *From)
+        {   kernelType *Typed = (kernelType *)From;
+            kernelType *Moved = new kernelType(std::move(*Typed));
+            Typed->~kernelType();
+            return pointer<iteratorKernel<t>>
+            (   Moved,
+                [](iteratorKernel<t> *Kernel)
+                {   // need to cast to the real type for the destructor to work properly:
+                    delete (kernelType *)Kernel;
+                }
+            );
+        },
+        .destroy = [](iteratorKernel<t> *Kernel)
+        {   ((kernelType *)Kernel)->~kernelType();
+        },
+    };
+
+    // The kernel we're iterating with; either Null, inside `InlineKernel` (if `InlineOps`
+    // is not Null), or the same kernel as `HeapKernel` (which may just be a reference).
+    iteratorKernel<t> *Kernel = Null;
+    const inlineKernelOps *InlineOps = Null;
+    pointer<iteratorKernel<t>> HeapKernel;
+    alignas(std::max_align_t) u8 InlineKernel[InlineKernelBytes];
+
+    iterator() {}
 public:
-    iterator(pointer<iteratorKernel<t>> _Kernel) : Kernel(std::move(_Kernel)) {}
+    iterator(pointer<iteratorKernel<t>> _Kernel)
+    :   HeapKernel(std::move(_Kernel))
+    {   if (HeapKernel != Null)
+        {   Kernel = &*HeapKernel;
+        }
+    }
+
+    // Creates an iterator with a new `kernelType` kernel, constructed from the passed-in
+    // arguments.  The kernel lives inside the iterator if it is small enough, otherwise
+    // on the heap.  `kernelType` should extend `iteratorKernel<t>`.
+    template <class kernelType, class... arguments>
+    static iterator of(arguments&&... Arguments)
+    {   iterator Result;
+        if constexpr
+        (       sizeof(kernelType) <= InlineKernelBytes
+            &&  alignof(kernelType) <= alignof(std::max_align_t)
+        )
+        {   Result.Kernel = new (Result.InlineKernel) kernelType(std::forward<arguments>(Arguments)...);
+            Result.InlineOps = &InlineKernelOpsFor<kernelType>;
+        }
+        else
+        {   Result.HeapKernel = pointer<iteratorKernel<t>>
+            (   new kernelType(std::forward<arguments>(Arguments)...),
+                [](iteratorKernel<t> *Kernel)
+                {   // need to cast to the real type for the destructor to work properly:
+                    delete (kernelType *)Kernel;
+                }
+            );
+            Result.Kernel = &*Result.HeapKernel;
+        }
+        return Result;
+    }
+
+    UNCOPYABLE_CLASS(iterator)
+
+    MOVABLE_TEMPLATE
+    (   iterator, Other,
+        // For move assignment, make sure our own kernel is cleaned up first:
+        reset(),
+        // Do the rest for both assignment and construction:
+        HeapKernel = std::move(Other.HeapKernel);
+        if (Other.InlineOps != Null)
+        {   InlineOps = Other.InlineOps;
+            Kernel = InlineOps->relocate(Other.Kernel, InlineKernel);
+            Other.InlineOps = Null;
+        }
+        else
+        {   Kernel = Other.Kernel;
+        }
+        Other.Kernel = Null;
+    )
+
+    ~iterator() { reset(); }
+
+    // Cleans up the kernel; safe to call multiple times.
+    void reset()
+    {   iteratorKernel<t> *KernelOnce = Kernel;
+        Kernel = Null;
+        if (InlineOps != Null)
+        {   const inlineKernelOps *InlineOpsOnce = InlineOps;
+            InlineOps = Null;
+            InlineOpsOnce->destroy(KernelOnce);
+        }
+        HeapKernel.reset();
+    }
 
     optional<t> next()
-    {   ASSERT(Kernel->next != Null);
-        return Kernel->next(&*Kernel);
+    {   ASSERT(Kernel != Null && Kernel->next != Null);
+        return Kernel->next(Kernel);
+    }
+
+    // Clears `Batch` and fills it with upcoming values, returning how many there are.
+    // Only returns 0 when the iterator is done.  Prefer this to `next` for consuming
+    // many values, since kernels which support it fill the batch without a call per value.
+    index nextBatch(iteratorBatch<t> &Batch)
+    {   ASSERT(Kernel != Null && Kernel->next != Null);
+        Batch.clear();
+        if (Kernel->nextBatch != Null)
+        {   Kernel->nextBatch(Kernel, Batch);
+        }
+        else
+        {   detail::fillBatchViaNext(Batch, [this]() { return Kernel->next(Kernel); });
+        }
+        return Batch.count();
+    }
+
+    // Returns how many values are left, as far as the kernel knows.
+    // E.g., `array` uses this to reserve space when being constructed from an iterator.
+    countHint remainingCount()
+    {   ASSERT(Kernel != Null);
+        return Kernel->remainingCount != Null ? Kernel->remainingCount(Kernel) : countHint();
     }
 
     bool checkAny(fn<bool(const t &)> hasCondition)
@@ -357,6 +742,7 @@ public:
 
     // Create a new, child iterator which maps over some elements based on the values of
     // the parent (this).  The parent (this) MUST outlive the child (returned) iterator.
+    // An inline kernel is moved to the heap first, so the parent can still be moved.
     template <class u>
     iterator<u> iterate
     (   // this mapping function does not require that `t` is immutable, since we are
@@ -364,11 +750,10 @@ public:
         // note that `t` can of course be a `const` type under the hood.
         fn<optional<u>(t &)> mapTToU
     )   &
-    {   return iterator<u>
-        (   detail::iteratorKernelFilterMap<t, t &, u>::destructible
-            (   Kernel.reference(),
-                mapTToU
-            )
+    {   moveKernelToHeap();
+        return detail::iteratorKernelFilterMap<t, t &, u>::toIterator
+        (   pointer<iteratorKernel<t>>::reference(Kernel),
+            std::move(mapTToU)
         );
     }
 
@@ -378,11 +763,9 @@ public:
     iterator<u> iterate
     (   fn<optional<u>(t &)> mapTToU
     )   &&
-    {   return iterator<u>
-        (   detail::iteratorKernelFilterMap<t, t &, u>::destructible
-            (   Kernel.abdicate(),
-                mapTToU
-            )
+    {   return detail::iteratorKernelFilterMap<t, t &, u>::toIterator
+        (   abdicate(),
+            std::move(mapTToU)
         );
     }
 
@@ -412,17 +795,166 @@ public:
     // to iterate through.
 
     // Returns an iterator from 0 to Count-1.
+    // For a hot loop, prefer `iteratorRange<t>({.EndBefore = Count}).values()`, which isn't type-erased.
     static iterator<t> range(t Count)
-    {   return iterator<t>
-        (   detail::iteratorRangeKernel<t>::destructible(iteratorRange<t>({.EndBefore = Count}))
-        );
+    {   return range(iteratorRange<t>({.EndBefore = Count}));
     }
 
     static iterator<t> range(iteratorRange<t> Range)
-    {   return iterator<t>(detail::iteratorRangeKernel<t>::destructible(Range));
+    {   return Range.values().toIterator();
+    }
+
+private:
+    // Returns an owning pointer to the kernel, keeping only a reference to it in this iterator.
+    // Inline kernels are moved to the heap first, since they would be destroyed with this iterator.
+    pointer<iteratorKernel<t>> abdicate()
+    {   moveKernelToHeap();
+        return HeapKernel.abdicate();
+    }
+
+    // Moves an inline kernel to the heap (still owned by this iterator),
+    // so that its address doesn't change when this iterator is moved.
+    void moveKernelToHeap()
+    {   if (InlineOps != Null)
+        {   HeapKernel = InlineOps->relocateToHeap(Kernel);
+            InlineOps = Null;
+            Kernel = &*HeapKernel;
+        }
     }
+
+    VISIBLE_FOR_TESTING
+    (   bool kernelIsInline() const
+        {   return InlineOps != Null;
+        }
+    )
 };
 
+namespace detail
+{   // Wraps a static kernel (see `staticIterator`) so that it can be used in an `iterator<t>`.
+    template <class t, class kernel>
+    class erasedKernel : public iteratorKernel<t>
+    {   kernel Kernel;
+
+        erasedKernel(kernel &&_Kernel)
+        :   iteratorKernel<t>
+            ({  .next = [](iteratorKernel<t> *BaseKernelSelf)
+                {   CAST_DEFINE(SAFE((erasedKernel<t, kernel>)) *, Self, BaseKernelSelf);
+                    return Self->Kernel.next();
+                },
+                .nextBatch = [](iteratorKernel<t> *BaseKernelSelf, iteratorBatch<t> &Batch)
+                {   CAST_DEFINE(SAFE((erasedKernel<t, kernel>)) *, Self, BaseKernelSelf);
+                    detail::nextBatch(Self->Kernel, Batch);
+                },
+                .remainingCount = [](iteratorKernel<t> *BaseKernelSelf)
+                {   CAST_DEFINE(SAFE((erasedKernel<t, kernel>)) *, Self, BaseKernelSelf);
+                    return detail::remainingCount(Self->Kernel);
+                },
+            }),
+            Kernel(std::move(_Kernel))
+        {}
+    public:
+        KERNEL_TO_ITERATOR
+        (   erasedKernel<t AND kernel>,
+            t,
+            (kernel &&_Kernel),
+            (std::move(_Kernel))
+        );
+    };
+}
+
+/*
+`staticIterator` is the compile-time-composed version of `iterator`.  Instead of calling
+through a heap-allocated, type-erased `iteratorKernel`, it holds its kernel by value and calls
+`Kernel.next()` directly, so e.g. `Array.values().$ iterate<int>(...)` can be inlined
+down to a plain loop.  A static kernel is any type with an `optional<t> next()` method,
+and optionally `void nextBatch(iteratorBatch<t> &)` and `countHint remainingCount() const`
+methods (see `iterator::nextBatch` and `iterator::remainingCount`).
+
+Use `toIterator()` (or just assign to an `iterator<t>`) where you actually need type erasure,
+e.g., to store the iterator in a class or return it from a function defined in a `.cc` file.
+*/
+template <class t, class kernel>
+class staticIterator
+{   kernel Kernel;
+public:
+    explicit staticIterator(kernel _Kernel) : Kernel(std::move(_Kernel)) {}
+
+    inline optional<t> next()
+    {   return Kernel.next();
+    }
+
+    // See `iterator::nextBatch`.  Static kernels can add a `void nextBatch(iteratorBatch<t> &)`
+    // method to fill the batch themselves.
+    inline index nextBatch(iteratorBatch<t> &Batch)
+    {   return detail::nextBatch(Kernel, Batch);
+    }
+
+    // See `iterator::remainingCount`.  Static kernels can add a `countHint remainingCount() const`
+    // method if they know how many values are left.
+    inline countHint remainingCount() const
+    {   return detail::remainingCount(Kernel);
+    }
+
+    template <class condition>
+    bool checkAny(condition hasCondition)
+    {   for (const t & Entry : This)
+        {   if (hasCondition(Entry))
+            {   return true;
+            }
+        }
+        return false;
+    }
+
+    // Create a new, child iterator which maps over some elements based on the values of
+    // the parent (this).  The parent (this) MUST outlive the child (returned) iterator.
+    // `mapTToU` takes a `t &` and returns an `optional<u>`; Null results are skipped.
+    template <class u, class mapper>
+    staticIterator<u, detail::staticFilterMapKernel<t, u, kernel &, mapper>> iterate
+    (   mapper mapTToU
+    )   &
+    {   return staticIterator<u, detail::staticFilterMapKernel<t, u, kernel &, mapper>>
+        (   detail::staticFilterMapKernel<t, u, kernel &, mapper>(Kernel, std::move(mapTToU))
+        );
+    }
+
+    // An overload of iterate for when the parent (this) will be descoped
+    // before the child (returned iterator).  This moves the parent's kernel into the child.
+    template <class u, class mapper>
+    staticIterator<u, detail::staticFilterMapKernel<t, u, kernel, mapper>> iterate
+    (   mapper mapTToU
+    )   &&
+    {   return staticIterator<u, detail::staticFilterMapKernel<t, u, kernel, mapper>>
+        (   detail::staticFilterMapKernel<t, u, kernel, mapper>(std::move(Kernel), std::move(mapTToU))
+        );
+    }
+
+    template <class u>
+    inline u join(u Delimiter) &&
+    {   return Delimiter.join(std::move(This));
+    }
+
+    using iterator_type = detail::stlIterator<t, staticIterator>;
+
+    // Beware of using these STL iterators for standard C++ things.
+    // These are currently designed only for making for-loops with containers easy:
+    iterator_type begin() { return iterator_type(this, /*AtEnd =*/ False); }
+    iterator_type end() { return iterator_type(this, /*AtEnd =*/ True); }
+
+    // Type-erases this iterator, moving the kernel into an `iterator<t>`.
+    iterator<t> toIterator() &&
+    {   return detail::erasedKernel<t, kernel>::toIterator(std::move(Kernel));
+    }
+
+    operator iterator<t>() &&
+    {   return std::move(This).toIterator();
+    }
+};
+
+template <class t>
+inline staticIterator<t, detail::iteratorRangeKernel<t>> iteratorRange<t>::values() const
+{   return staticIterator<t, detail::iteratorRangeKernel<t>>(detail::iteratorRangeKernel<t>(This));
+}
+
 #ifndef NDEBUG
 namespace test
 {   iterator<noisy &> noisyIterator(int Count);
@@ -0,0 +1,511 @@
+#include "job.h"
+
+#ifndef NDEBUG
+#include "array.h"
+#include "parallel.h"
+
+#include <chrono>
+#include <cmath>
+#endif
+
+BVMT
+
+static thread_local index ThreadIndex = -1;
+
+jobs::jobs()
+:   Queues(std::max((index)std::thread::hardware_concurrency(), (index)1))
+{   ThreadIndex = 0;
+    ActiveThreadCount = threadCount();
+    for (index I = 1; I < threadCount(); ++I)
+    {   Workers.emplace_back([this, I]() { work(I); });
+    }
+}
+
+jobs *jobs::get()
+{   // Never deleted (like other singletons), since workers may still be running at exit.
+    static jobs *Instance = new jobs();
+    return Instance;
+}
+
+jobs::~jobs()
+{   {   std::lock_guard<std::mutex> Lock(SleepMutex);
+        Stopping = True;
+    }
+    WakeUp.notify_all();
+    for (std::thread &Worker : Workers)
+    {   Worker.join();
+    }
+}
+
+index jobs::threadIndex()
+{   return ThreadIndex;
+}
+
+void jobs::activeThreadCount(index Count)
+{   ASSERT(Count >= 1 && Count <= threadCount());
+    {   std::lock_guard<std::mutex> Lock(SleepMutex);
+        ActiveThreadCount.store(Count, std::memory_order_relaxed);
+    }
+    WakeUp.notify_all();
+}
+
+void jobs::run(fn<void()> Job, jobCounter *Counter)
+{   if (Counter != Null)
+    {   Counter->Count.fetch_add(1, std::memory_order_relaxed);
+    }
+    push(job({.Run = std::move(Job), .Counter = Counter}), /*OnMainThread =*/ False);
+}
+
+void jobs::runAfter(jobCounter &Dependency, fn<void()> Job, jobCounter *Counter)
+{   if (Counter != Null)
+    {   Counter->Count.fetch_add(1, std::memory_order_relaxed);
+    }
+    runAfter(Dependency, job({.Run = std::move(Job), .Counter = Counter}), /*OnMainThread =*/ False);
+}
+
+void jobs::runOnMainThread(fn<void()> Job, jobCounter *Counter)
+{   if (Counter != Null)
+    {   Counter->Count.fetch_add(1, std::memory_order_relaxed);
+    }
+    push(job({.Run = std::move(Job), .Counter = Counter}), /*OnMainThread =*/ True);
+}
+
+void jobs::runOnMainThreadAfter(jobCounter &Dependency, fn<void()> Job, jobCounter *Counter)
+{   if (Counter != Null)
+    {   Counter->Count.fetch_add(1, std::memory_order_relaxed);
+    }
+    runAfter(Dependency, job({.Run = std::move(Job), .Counter = Counter}), /*OnMainThread =*/ True);
+}
+
+void jobs::runAfter(jobCounter &Dependency, job Job, bool OnMainThread)
+{   {   std::lock_guard<std::mutex> Lock(Dependency.Mutex);
+        // `execute` takes the lock after finishing the last job, so if this isn't done
+        // yet, the last job to finish will see (and queue) our dependent.
+        if (!Dependency.done())
+        {   Dependency.Dependents.push_back
+            (   jobCounter::dependent
+                ({  .Run = std::move(Job.Run),
+                    .Counter = Job.Counter,
+                    .OnMainThread = OnMainThread,
+                })
+            );
+            return;
+        }
+    }
+    push(std::move(Job), OnMainThread);
+}
+
+void jobs::push(job Job, bool OnMainThread)
+{   if (OnMainThread)
+    {   {   std::lock_guard<std::mutex> Lock(MainThreadQueue.Mutex);
+            MainThreadQueue.Jobs.push_back(std::move(Job));
+        }
+        // In case the main thread is sleeping in `wait`.
+        {   std::lock_guard<std::mutex> Lock(SleepMutex);
+        }
+        WakeUp.notify_all();
+        return;
+    }
+    // Threads outside of the pool hand their jobs to the main thread's queue,
+    // where they can be stolen like any other job.
+    jobQueue &Queue = Queues[std::max(ThreadIndex, (index)0)];
+    {   std::lock_guard<std::mutex> Lock(Queue.Mutex);
+        Queue.Jobs.push_back(std::move(Job));
+    }
+    Pending.fetch_add(1, std::memory_order_release);
+    // Lock so that a worker can't miss the wake up between checking `Pending` and sleeping.
+    {   std::lock_guard<std::mutex> Lock(SleepMutex);
+    }
+    if (activeThreadCount() < threadCount())
+    {   // One wake up might go to a thread which isn't allowed to run jobs, and be lost.
+        WakeUp.notify_all();
+    }
+    else
+    {   WakeUp.notify_one();
+    }
+}
+
+index jobs::runMainThreadJobs()
+{   ASSERT(ThreadIndex == 0);
+    index Count = 0;
+    while (True)
+    {   optional<job> Job;
+        {   std::lock_guard<std::mutex> Lock(MainThreadQueue.Mutex);
+            if (MainThreadQueue.Jobs.empty())
+            {   return Count;
+            }
+            Job = std::move(MainThreadQueue.Jobs.front());
+            MainThreadQueue.Jobs.pop_front();
+        }
+        execute(*Job);
+        ++Count;
+    }
+}
+
+void jobs::wait(jobCounter &Counter)
+{   while (!Counter.done())
+    {   if (ThreadIndex == 0 && runMainThreadJobs() > 0)
+        {   continue;
+        }
+        if (runOne(ThreadIndex))
+        {   continue;
+        }
+        // Nothing to run, so sleep until there is (like an idle worker), or until the last job
+        // in `Counter` finishes, which wakes us up since `execute` sees that we're waiting.
+        {   std::lock_guard<std::mutex> Lock(Counter.Mutex);
+            ++Counter.Waiters;
+        }
+        {   std::unique_lock<std::mutex> Lock(SleepMutex);
+            WakeUp.wait
+            (   Lock,
+                [this, &Counter]()
+                {   if (Counter.done() || canRun(ThreadIndex))
+                    {   return True;
+                    }
+                    if (ThreadIndex != 0)
+                    {   return False;
+                    }
+                    std::lock_guard<std::mutex> QueueLock(MainThreadQueue.Mutex);
+                    return !MainThreadQueue.Jobs.empty();
+                }
+            );
+        }
+        std::lock_guard<std::mutex> Lock(Counter.Mutex);
+        --Counter.Waiters;
+    }
+    std::exception_ptr Error;
+    {   std::lock_guard<std::mutex> Lock(Counter.Mutex);
+        std::swap(Error, Counter.Error);
+    }
+    if (Error)
+    {   std::rethrow_exception(Error);
+    }
+}
+
+bool jobs::canRun(index ThisThread) const
+{   return Pending.load(std::memory_order_acquire) > 0 && ThisThread < activeThreadCount();
+}
+
+bool jobs::runOne(index ThisThread)
+{   if (!canRun(ThisThread))
+    {   return False;
+    }
+    const index ThreadCount = threadCount();
+    // Check our own queue first (newest job first, since it's probably still in cache),
+    // then steal the oldest job from the other threads.
+    const index Start = std::max(ThisThread, (index)0);
+    for (index Offset = 0; Offset < ThreadCount; ++Offset)
+    {   jobQueue &Queue = Queues[(Start + Offset) % ThreadCount];
+        optional<job> Job;
+        {   std::lock_guard<std::mutex> Lock(Queue.Mutex);
+            if (Queue.Jobs.empty())
+            {   continue;
+            }
+            if (Offset == 0 && ThisThread >= 0)
+            {   Job = std::move(Queue.Jobs.back());
+                Queue.Jobs.pop_back();
+            }
+            else
+            {   Job = std::move(Queue.Jobs.front());
+                Queue.Jobs.pop_front();
+            }
+        }
+        Pending.fetch_sub(1, std::memory_order_relaxed);
+        execute(*Job);
+        return True;
+    }
+    return False;
+}
+
+void jobs::execute(job &Job)
+{   try
+    {   Job.Run();
+    }
+    catch (...)
+    {   if (Job.Counter == Null)
+        {   // Nobody is waiting for this job, so there's nowhere to rethrow.
+            LOG_ERR("a job without a jobCounter threw an error");
+            return;
+        }
+        std::lock_guard<std::mutex> Lock(Job.Counter->Mutex);
+        if (!Job.Counter->Error)
+        {   Job.Counter->Error = std::current_exception();
+        }
+    }
+    if (Job.Counter == Null)
+    {   return;
+    }
+    std::vector<jobCounter::dependent> Dependents;
+    bool Waited = False;
+    {   // Decrement under the lock so that `runAfter` either sees that we're done
+        // or adds its dependent before we take them, and so that `wait` either sees
+        // that we're done or tells us that it's going to sleep.
+        std::lock_guard<std::mutex> Lock(Job.Counter->Mutex);
+        if (Job.Counter->Count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {   std::swap(Dependents, Job.Counter->Dependents);
+            Waited = Job.Counter->Waiters > 0;
+        }
+    }
+    // NOTE: `Job.Counter` may be descoped by a waiting thread from here on.
+    if (Waited)
+    {   {   std::lock_guard<std::mutex> Lock(SleepMutex);
+        }
+        WakeUp.notify_all();
+    }
+    for (jobCounter::dependent &Dependent : Dependents)
+    {   push(job({.Run = std::move(Dependent.Run), .Counter = Dependent.Counter}), Dependent.OnMainThread);
+    }
+}
+
+void jobs::work(index ThisThread)
+{   ThreadIndex = ThisThread;
+    while (True)
+    {   if (runOne(ThisThread))
+        {   continue;
+        }
+        std::unique_lock<std::mutex> Lock(SleepMutex);
+        WakeUp.wait
+        (   Lock,
+            [this, ThisThread]()
+            {   return Stopping || canRun(ThisThread);
+            }
+        );
+        if (Stopping)
+        {   return;
+        }
+    }
+}
+
+#ifndef NDEBUG
+void test__core__job()
+{   TEST
+    (   "jobs run on the pool and can be waited on",
+        jobs *Jobs = jobs::get();
+        EXPECT_EQUAL(jobs::threadIndex(), 0);
+        std::atomic<index> Sum = 0;
+        jobCounter Counter;
+        for (index I = 1; I <= 1000; ++I)
+        {   Jobs->run([&Sum, I]() { Sum += I; }, &Counter);
+        }
+        Jobs->wait(Counter);
+        EXPECT_EQUAL(Counter.done(), True);
+        EXPECT_EQUAL(Sum.load(), 500500);
+    );
+
+    TEST
+    (   "jobs::get() returns the same pool from any thread",
+        jobs *Jobs = jobs::get();
+        std::atomic<index> Mismatches = 0;
+        std::atomic<index> MainThreadJobsRefused = 0;
+        std::vector<std::thread> Threads;
+        for (index I = 0; I < 8; ++I)
+        {   Threads.emplace_back
+            (   [Jobs, &Mismatches, &MainThreadJobsRefused]()
+                {   Mismatches += jobs::get() != Jobs;
+                    // Other threads don't become the main thread:
+                    try
+                    {   Jobs->runMainThreadJobs();
+                    }
+                    catch (const error &)
+                    {   ++MainThreadJobsRefused;
+                    }
+                }
+            );
+        }
+        for (std::thread &Thread : Threads)
+        {   Thread.join();
+        }
+        EXPECT_EQUAL(Mismatches.load(), 0);
+        EXPECT_EQUAL(MainThreadJobsRefused.load(), 8);
+    );
+
+    TEST
+    (   "jobs can queue and wait on more jobs",
+        jobs *Jobs = jobs::get();
+        std::atomic<index> Count = 0;
+        jobCounter Counter;
+        for (index I = 0; I < 20; ++I)
+        {   Jobs->run
+            (   [Jobs, &Count]()
+                {   jobCounter InnerCounter;
+                    for (index J = 0; J < 20; ++J)
+                    {   Jobs->run([&Count]() { ++Count; }, &InnerCounter);
+                    }
+                    Jobs->wait(InnerCounter);
+                },
+                &Counter
+            );
+        }
+        Jobs->wait(Counter);
+        EXPECT_EQUAL(Count.load(), 400);
+    );
+
+    TEST
+    (   "jobs can depend on other jobs",
+        jobs *Jobs = jobs::get();
+        std::atomic<index> First = 0;
+        std::atomic<index> SeenBySecond = -1;
+        jobCounter FirstCounter;
+        jobCounter SecondCounter;
+        for (index I = 0; I < 50; ++I)
+        {   Jobs->run([&First]() { ++First; }, &FirstCounter);
+        }
+        Jobs->runAfter
+        (   FirstCounter,
+            [&First, &SeenBySecond]() { SeenBySecond = First.load(); },
+            &SecondCounter
+        );
+        Jobs->wait(SecondCounter);
+        EXPECT_EQUAL(SeenBySecond.load(), 50);
+
+        // A dependency which is already done doesn't hold anything up:
+        Jobs->runAfter(FirstCounter, [&SeenBySecond]() { SeenBySecond = 0; }, &SecondCounter);
+        Jobs->wait(SecondCounter);
+        EXPECT_EQUAL(SeenBySecond.load(), 0);
+    );
+
+    TEST
+    (   "main thread jobs only run on the main thread",
+        jobs *Jobs = jobs::get();
+        std::atomic<index> NotOnMainThread = 0;
+        jobCounter WorkCounter;
+        jobCounter MainCounter;
+        for (index I = 0; I < 100; ++I)
+        {   Jobs->run
+            (   [Jobs, &NotOnMainThread, &MainCounter]()
+                {   Jobs->runOnMainThread
+                    (   [&NotOnMainThread]()
+                        {   if (jobs::threadIndex() != 0) ++NotOnMainThread;
+                        },
+                        &MainCounter
+                    );
+                },
+                &WorkCounter
+            );
+        }
+        Jobs->runOnMainThreadAfter
+        (   WorkCounter,
+            [&NotOnMainThread]() { if (jobs::threadIndex() != 0) ++NotOnMainThread; },
+            &MainCounter
+        );
+        Jobs->wait(WorkCounter);
+        Jobs->wait(MainCounter);
+        EXPECT_EQUAL(NotOnMainThread.load(), 0);
+        EXPECT_EQUAL(Jobs->runMainThreadJobs(), 0);
+
+        Jobs->runOnMainThread([]() {}, Null);
+        EXPECT_EQUAL(Jobs->runMainThreadJobs(), 1);
+    );
+
+    TEST
+    (   "can limit the number of active threads",
+        jobs *Jobs = jobs::get();
+        Jobs->activeThreadCount(1);
+        std::atomic<index> NotOnMainThread = 0;
+        jobCounter Counter;
+        for (index I = 0; I < 100; ++I)
+        {   Jobs->run
+            (   [&NotOnMainThread]() { if (jobs::threadIndex() != 0) ++NotOnMainThread; },
+                &Counter
+            );
+        }
+        Jobs->wait(Counter);
+        Jobs->activeThreadCount(Jobs->threadCount());
+        EXPECT_EQUAL(NotOnMainThread.load(), 0);
+    );
+
+    TEST
+    (   "a limited number of active threads still picks up jobs",
+        jobs *Jobs = jobs::get();
+        if (Jobs->threadCount() >= 3)
+        {   Jobs->activeThreadCount(2);
+            for (int Round = 0; Round < 100; ++Round)
+            {   jobCounter Counter;
+                Jobs->run([]() {}, &Counter);
+                // Not `wait`ing, so that only the one active worker can run the job.
+                const auto GiveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+                while (!Counter.done() && std::chrono::steady_clock::now() < GiveUp)
+                {   std::this_thread::yield();
+                }
+                EXPECT_EQUAL(Counter.done(), True);
+                Jobs->wait(Counter);
+            }
+            Jobs->activeThreadCount(Jobs->threadCount());
+        }
+    );
+
+    TEST
+    (   "threads outside of the pool sleep until the jobs they wait on are done",
+        jobs *Jobs = jobs::get();
+        std::atomic<bool> Done = False;
+        std::atomic<index> RanOn = -2;
+        std::thread Outside
+        (   [Jobs, &Done, &RanOn]()
+            {   jobCounter Counter;
+                Jobs->runOnMainThread([&RanOn]() { RanOn = jobs::threadIndex(); }, &Counter);
+                Jobs->wait(Counter);
+                Done = True;
+            }
+        );
+        while (!Done)
+        {   Jobs->runMainThreadJobs();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        Outside.join();
+        EXPECT_EQUAL(RanOn.load(), 0);
+    );
+
+    TEST
+    (   "errors in jobs are rethrown when waiting",
+        jobCounter Counter;
+        jobs::get()->run([]() { throw error("job failed", AT); }, &Counter);
+        jobs::get()->run([]() {}, &Counter);
+        EXPECT_THROW(jobs::get()->wait(Counter), "job failed");
+        EXPECT_EQUAL(Counter.done(), True);
+    );
+
+    TEST_BENCHMARK
+    (   "per-entity updates on 1 to N threads",
+        struct entity
+        {   dbl X = 0.0;
+            dbl Y = 0.0;
+            dbl VelocityX = 1.0;
+            dbl VelocityY = 0.5;
+        };
+        array<entity> Entities = array<entity>::fixedCount(200000);
+        jobs *Jobs = jobs::get();
+        dbl SingleThreadSeconds = 0.0;
+        for (index Threads = 1; Threads <= Jobs->threadCount(); ++Threads)
+        {   Jobs->activeThreadCount(Threads);
+            dbl Seconds = test::secondsToRun
+            (   [&Entities]()
+                {   for (int Frame = 0; Frame < 20; ++Frame)
+                    {   parallelFor
+                        (   Entities.view(),
+                            [](entity &Entity)
+                            {   // Something a bit more expensive than a memory-bound update:
+                                for (int Step = 0; Step < 8; ++Step)
+                                {   Entity.VelocityX += 0.01 * std::sin(Entity.Y);
+                                    Entity.VelocityY -= 0.01 * std::cos(Entity.X);
+                                    Entity.X += 0.01 * Entity.VelocityX;
+                                    Entity.Y += 0.01 * Entity.VelocityY;
+                                }
+                            }
+                        );
+                    }
+                }
+            );
+            if (Threads == 1)
+            {   SingleThreadSeconds = Seconds;
+            }
+            LOG
+            (   Threads << " thread(s): " << Seconds << "s, "
+                    << SingleThreadSeconds / Seconds << "x speedup"
+            );
+        }
+        Jobs->activeThreadCount(Jobs->threadCount());
+    );
+}
+#endif
+
+TMVB
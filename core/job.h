@@ -0,0 +1,153 @@
+#pragma once
+
+#include "error.h"
+#include "optional.h"
+#include "types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+BVMT
+
+// Counts how many jobs (see `jobs::run`) are still unfinished, so that they can be waited on,
+// or so that other jobs can depend on them (see `jobs::runAfter`).
+// Must outlive the jobs that it is counting, as well as any jobs depending on it.
+class jobCounter
+{   struct dependent
+    {   fn<void()> Run;
+        jobCounter *Counter;
+        bool OnMainThread;
+    };
+
+    std::atomic<index> Count = 0;
+    // Guards `Error` and `Dependents`.
+    std::mutex Mutex;
+    // The first error thrown by one of the counted jobs, rethrown by `jobs::wait`.
+    std::exception_ptr Error;
+    // Jobs to queue once `Count` gets to zero.
+    std::vector<dependent> Dependents;
+    // Threads sleeping in `jobs::wait` on this, which need a wake up once `Count` gets to zero.
+    // Guarded by `Mutex`.
+    index Waiters = 0;
+
+    friend class jobs;
+public:
+    jobCounter() {}
+
+    UNCOPYABLE_CLASS(jobCounter)
+    UNMOVABLE_CLASS(jobCounter)
+
+    inline bool done() const
+    {   return Count.load(std::memory_order_acquire) == 0;
+    }
+};
+
+// A work-stealing thread pool.  Every thread in the pool (including the main thread, i.e.,
+// the thread that first calls `jobs::get()`, which `window` does when it's created) has its
+// own deque of jobs; a thread pushes and pops jobs at the back of its own deque, and idle
+// threads steal from the front of others'.
+// The main thread only runs jobs while it is inside `wait` or `runMainThreadJobs`.
+// Jobs which need to be on the main thread (e.g., anything calling raylib) can be queued
+// via `runOnMainThread`; `window::draw` runs these at the start of each frame.
+class jobs
+{   jobs();
+public:
+    // Like `SINGLETON_H`'s `get()`, but safe to call first from any thread.
+    static jobs *get();
+private:
+    struct job
+    {   fn<void()> Run;
+        jobCounter *Counter;
+    };
+
+    struct jobQueue
+    {   std::mutex Mutex;
+        std::deque<job> Jobs;
+    };
+
+    // one queue per thread, index 0 is for the main thread.
+    std::vector<jobQueue> Queues;
+    std::vector<std::thread> Workers;
+    // Only run by the main thread, so not counted in `Pending`.
+    jobQueue MainThreadQueue;
+    // Jobs which are queued but haven't started yet.
+    std::atomic<index> Pending = 0;
+    // Threads with an index at or above this don't run jobs; see `activeThreadCount`.
+    std::atomic<index> ActiveThreadCount;
+    std::atomic<bool> Stopping = False;
+    std::mutex SleepMutex;
+    std::condition_variable WakeUp;
+
+public:
+    ~jobs();
+
+    UNCOPYABLE_CLASS(jobs)
+    UNMOVABLE_CLASS(jobs)
+
+    // Number of threads that can run jobs, including the main thread.
+    inline index threadCount() const
+    {   return Queues.size();
+    }
+
+    // Number of threads that are allowed to run jobs (including the main thread),
+    // which is `threadCount()` unless limited, e.g., for benchmarking.
+    inline index activeThreadCount() const
+    {   return ActiveThreadCount.load(std::memory_order_relaxed);
+    }
+
+    // Limits how many threads run jobs, in [1, threadCount()].
+    void activeThreadCount(index Count);
+
+    // Index of the current thread in the pool, 0 for the main thread,
+    // or -1 for a thread that isn't part of the pool.
+    static index threadIndex();
+
+    // Queues `Job` to run on any thread.  If `Counter` isn't Null, it is incremented
+    // now and decremented once the job finishes (even if it throws).
+    void run(fn<void()> Job, jobCounter *Counter);
+
+    // Like `run`, but `Job` is only queued once all of `Dependency`'s jobs are done
+    // (immediately, if they already are).  `Job` runs even if one of them threw;
+    // the error is still rethrown by `wait(Dependency)`.
+    void runAfter(jobCounter &Dependency, fn<void()> Job, jobCounter *Counter);
+
+    // Queues `Job` to run on the main thread, e.g., for raylib calls.  Note that a worker
+    // waiting on `Counter` will only finish once the main thread has run `Job`.
+    void runOnMainThread(fn<void()> Job, jobCounter *Counter);
+
+    // Like `runAfter`, but `Job` will run on the main thread.
+    void runOnMainThreadAfter(jobCounter &Dependency, fn<void()> Job, jobCounter *Counter);
+
+    // Runs all jobs queued for the main thread.  Must be called from the main thread,
+    // i.e., `threadIndex() == 0`.
+    // Returns how many jobs were run.
+    index runMainThreadJobs();
+
+    // Runs queued jobs on this thread until all jobs in `Counter` are done, sleeping while
+    // there's nothing for this thread to run.  If any of them threw, the first error is rethrown here.
+    void wait(jobCounter &Counter);
+
+private:
+    // Queues a job whose counter has already been incremented.
+    void push(job Job, bool OnMainThread);
+
+    void runAfter(jobCounter &Dependency, job Job, bool OnMainThread);
+
+    // Whether there are queued jobs which the thread at `ThreadIndex` is allowed to run.
+    bool canRun(index ThreadIndex) const;
+
+    // Runs one job from this thread's queue, or steals one from another thread.
+    // Returns False if no job could be found.
+    bool runOne(index ThreadIndex);
+
+    void execute(job &Job);
+
+    void work(index ThreadIndex);
+};
+
+TMVB
@@ -0,0 +1,214 @@
+#include "map.h"
+
+#ifndef NDEBUG
+#include "array.h"
+#include "string.h"
+
+#include <unordered_map>
+#endif
+
+BVMT
+
+const char *const MapMissingKeyErrorMsg = "map does not have that key";
+
+#ifndef NDEBUG
+namespace
+{   using intMap = map<i64, i64>;
+    using stringMap = map<string, i32>;
+    using stdIntMap = std::unordered_map<i64, i64>;
+    using stdStringMap = std::unordered_map<string, i32>;
+}
+
+void test__core__map()
+{   TEST
+    (   "map can insert, get, and erase",
+        stringMap Map;
+        EXPECT_EQUAL(Map.count(), 0);
+        EXPECT_EQUAL(Map.get("hi") == Null, True);
+
+        Map.insert("hi", 3);
+        Map["hello"] = 5;
+        Map.insertInPlace("hey", 7);
+        EXPECT_EQUAL(Map.count(), 3);
+        EXPECT_EQUAL(Map["hi"], 3);
+        EXPECT_EQUAL(Map["hello"], 5);
+        EXPECT_EQUAL(*Map.get("hey"), 7);
+        EXPECT_EQUAL(Map.contains("hey"), True);
+        EXPECT_EQUAL(Map.contains("ho"), False);
+
+        // insert overwrites but insertInPlace doesn't:
+        Map.insert("hi", 4);
+        Map.insertInPlace("hey", 8);
+        EXPECT_EQUAL(Map["hi"], 4);
+        EXPECT_EQUAL(Map["hey"], 7);
+
+        EXPECT_EQUAL(Map.erase("hello"), True);
+        EXPECT_EQUAL(Map.erase("hello"), False);
+        EXPECT_EQUAL(Map.pop("hi"), 4);
+        EXPECT_THROW(Map.pop("hi"), MapMissingKeyErrorMsg);
+        EXPECT_EQUAL(Map.count(), 1);
+        EXPECT_EQUAL(Map, stringMap({{"hey", 7}}));
+    );
+
+    TEST
+    (   "map element pointers work like array's",
+        intMap Map({{1, 10}, {2, 20}});
+        i64 Default = -1;
+        EXPECT_EQUAL(Map.get(1).otherwise(defaultTo(Default)), 10);
+        EXPECT_EQUAL(Map.get(3).otherwise(defaultTo(Default)), -1);
+
+        const intMap &ConstMap = Map;
+        EXPECT_EQUAL(ConstMap.get(2).orDefault(), 20);
+        EXPECT_EQUAL(ConstMap.get(3).orDefault(), 0);
+        EXPECT_THROW(ConstMap[3], MapMissingKeyErrorMsg);
+
+        intMap::elementPointer Pointer = Map.get(2);
+        EXPECT_EQUAL(Pointer.element().Key, 2);
+        *Pointer += 5;
+        EXPECT_EQUAL(Map[2], 25);
+        EXPECT_EQUAL(Pointer.pop(), 25);
+        EXPECT_EQUAL(Pointer == Null, True);
+        EXPECT_EQUAL(Map.count(), 1);
+    );
+
+    TEST
+    (   "map can iterate over elements, keys, and values",
+        intMap Map;
+        for (i64 I = 1; I <= 100; ++I)
+        {   Map[I] = I * I;
+        }
+        i64 KeySum = 0;
+        for (const i64 &Key : Map.keys())
+        {   KeySum += Key;
+        }
+        EXPECT_EQUAL(KeySum, 5050);
+
+        for (i64 &Value : Map.values())
+        {   Value = -Value;
+        }
+        index Count = 0;
+        for (auto Element : Map)
+        {   EXPECT_EQUAL(Element.Value, -Element.Key * Element.Key);
+            ++Count;
+        }
+        EXPECT_EQUAL(Count, 100);
+
+        Count = 0;
+        for (auto Element : Map.elements())
+        {   EXPECT_EQUAL(Element.Value, -Element.Key * Element.Key);
+            ++Count;
+        }
+        EXPECT_EQUAL(Count, 100);
+
+        EXPECT_EQUAL(Map.values().remainingCount().exact(), True);
+        EXPECT_EQUAL(Map.values().remainingCount().AtLeast, 100);
+        array<i64> Values = Map.values();
+        EXPECT_EQUAL(Values.count(), 100);
+    );
+
+    TEST
+    (   "map can erase while iterating via element pointers",
+        intMap Map;
+        for (i64 I = 0; I < 50; ++I)
+        {   Map[I] = I;
+        }
+        intMap::elementPointer Pointer = Map.first();
+        while (Pointer != Null)
+        {   intMap::elementPointer Next = Pointer;
+            Next.next();
+            if (*Pointer % 2 == 0)
+            {   Pointer.pop();
+            }
+            Pointer = Next;
+        }
+        EXPECT_EQUAL(Map.count(), 25);
+        for (i64 Value : Map.values())
+        {   EXPECT_EQUAL(Value % 2, 1);
+        }
+    );
+
+    TEST
+    (   "map can be copied and moved",
+        stringMap Map({{"a", 1}, {"b", 2}});
+        stringMap Copy = Map;
+        Copy["c"] = 3;
+        EXPECT_EQUAL(Map.count(), 2);
+        EXPECT_EQUAL(Copy.count(), 3);
+        EXPECT_NOT_EQUAL(Map, Copy);
+        Copy.erase("c");
+        EXPECT_EQUAL(Map, Copy);
+
+        stringMap Moved = std::move(Copy);
+        EXPECT_EQUAL(Moved, Map);
+        EXPECT_EQUAL(Copy.count(), 0);
+        EXPECT_EQUAL(Copy.contains("a"), False);
+    );
+
+    TEST_BENCHMARK
+    (   "map vs. std::unordered_map",
+        const i64 IntCount = 1000000;
+        const i64 StringCount = 200000;
+        array<string> Strings;
+        Strings.reserve(StringCount);
+        for (i64 I = 0; I < StringCount; ++I)
+        {   Strings.append(string("entity-") + string::of(I * 7919));
+        }
+
+        i64 Found = 0;
+        dbl MapSeconds = test::secondsToRun
+        (   [&]()
+            {   intMap Map;
+                for (i64 I = 0; I < IntCount; ++I)
+                {   Map[I * 31] = I;
+                }
+                for (i64 I = 0; I < 2 * IntCount; ++I)
+                {   Found += Map.contains(I * 31 + (I & 1));
+                }
+            }
+        );
+        dbl StdSeconds = test::secondsToRun
+        (   [&]()
+            {   stdIntMap Map;
+                for (i64 I = 0; I < IntCount; ++I)
+                {   Map[I * 31] = I;
+                }
+                for (i64 I = 0; I < 2 * IntCount; ++I)
+                {   Found += Map.count(I * 31 + (I & 1));
+                }
+            }
+        );
+        LOG("integer keys: map " << MapSeconds << "s, std::unordered_map " << StdSeconds << "s");
+
+        MapSeconds = test::secondsToRun
+        (   [&]()
+            {   stringMap Map;
+                for (i64 I = 0; I < StringCount; ++I)
+                {   Map[Strings[I]] = I;
+                }
+                for (int Round = 0; Round < 5; ++Round)
+                {   for (i64 I = 0; I < StringCount; ++I)
+                    {   Found += Map.contains(Strings[I]);
+                    }
+                }
+            }
+        );
+        StdSeconds = test::secondsToRun
+        (   [&]()
+            {   stdStringMap Map;
+                for (i64 I = 0; I < StringCount; ++I)
+                {   Map[Strings[I]] = I;
+                }
+                for (int Round = 0; Round < 5; ++Round)
+                {   for (i64 I = 0; I < StringCount; ++I)
+                    {   Found += Map.count(Strings[I]);
+                    }
+                }
+            }
+        );
+        LOG("string keys: map " << MapSeconds << "s, std::unordered_map " << StdSeconds << "s");
+        EXPECT_EQUAL(Found, 2 * (IntCount / 2 + 5 * StringCount));
+    );
+}
+#endif
+
+TMVB
@@ -0,0 +1,362 @@
+#pragma once
+
+#include "arg.h"
+#include "error.h"
+#include "hash-table.h"
+#include "iterator.h"
+#include "optional.h"
+#include "types.h"
+
+#include <initializer_list>
+#include <utility>      // std::pair
+
+BVMT
+
+template <class k, class v>
+class map;
+
+extern const char *const MapMissingKeyErrorMsg;
+
+template <class key, class value>
+struct mapElement
+{   const key &Key;
+    value Value;
+
+    using noRefValueType = typename std::remove_reference<value>::type;
+
+    mapElement(const key &K, value V)
+    :   Key(K), Value(V)
+    {}
+
+    template <class newValue>
+    mapElement(const mapElement<key, newValue> &MapElement)
+    :   Key(MapElement.Key), Value(MapElement.Value)
+    {}
+};
+
+template <class key, class value>
+std::ostream &operator << (std::ostream &Out, const mapElement<key, value> &Element)
+{   return Out << "mapElement(" << Element.Key << ", " << Element.Value << ")";
+}
+
+namespace mapDetail
+{   template <class k, class v>
+    struct entry
+    {   k Key;
+        v Value;
+
+        static inline const k &of(const entry &Entry)
+        {   return Entry.Key;
+        }
+    };
+
+    template <class mapPointer, class value, class el>
+    class elementPointer
+    {   mapPointer Map = Null;
+        index Slot = -1;
+
+        template <class k1, class v1>
+        friend class bvmt::map;
+
+        elementPointer(mapPointer _Map, index _Slot)
+        :   Map(_Map), Slot(_Slot)
+        {}
+    public:
+        elementPointer() {}
+        elementPointer(null) {}
+
+        el element() const
+        {   value &Value = *This;
+            return el(Map->Table.at(Slot)->Key, Value);
+        }
+
+        inline value *operator -> () const
+        {   if (Map == Null)
+            {   throw error("map pointer is null", AT);
+            }
+            return &Map->Table.at(Slot)->Value;
+        }
+
+        value &operator * () const
+        {   return *(operator -> ());
+        }
+
+        bool operator == (null) const
+        {   return Map == Null;
+        }
+
+        bool operator != (null) const
+        {   return Map != Null;
+        }
+
+        value &otherwise(defaultTo<value> Default) const
+        {   if (Map != Null)
+            {   return Map->Table.at(Slot)->Value;
+            }
+            return *Default;
+        }
+
+        template <class q = value> requires (type<value>::IsConstant)
+        inline q &orDefault() const
+        {   return otherwise(defaultTo(type<value>::DefaultInstance));
+        }
+
+        // Removes the value from the map at this pointer's key and returns it.
+        // Unlike `array::elementPointer::pop`, this pointer becomes Null afterwards,
+        // since there is nothing left at the key.
+        template <class m = mapPointer> requires (type<typename type<m>::pointingAt>::IsMutable)
+        value pop()
+        {   if (Map == Null)
+            {   throw error("cannot pop from null map element pointer", AT);
+            }
+            value Result = std::move(Map->Table.at(Slot)->Value);
+            Map->Table.erase(Slot);
+            Map = Null;
+            Slot = -1;
+            return Result;
+        }
+
+        // moves the pointer to the next element in the map, in no particular order.
+        // returns true if there is a next element in the map.
+        // returns false otherwise, and sets this pointer to null.
+        bool next()
+        {   if (Map == Null)
+            {   return False;
+            }
+            if ((Slot = Map->Table.nextFull(Slot)) < 0)
+            {   Map = Null;
+                return False;
+            }
+            return True;
+        }
+    };
+
+    template <class mapPointer, class v, class e>
+    std::ostream &operator << (std::ostream &Out, elementPointer<mapPointer, v, e> Pointer)
+    {   Out <<
+        (       type<typename type<mapPointer>::pointingAt>::IsConstant
+            ?   "map::constElementPointer("
+            :   "map::elementPointer("
+        );
+        if (Pointer == Null)
+        {   return Out << "Null)";
+        }
+        return Out << Pointer.element() << ")";
+    }
+
+    struct pickKey
+    {   template <class e>
+        static inline const auto &of(e &Entry)
+        {   return Entry.Key;
+        }
+    };
+
+    struct pickValue
+    {   template <class e>
+        static inline auto &of(e &Entry)
+        {   return Entry.Value;
+        }
+    };
+}
+
+// A hash map from `k` to `v`, stored flat (see `hashTable`) rather than with a node per entry
+// like `std::unordered_map`.  Keys need `std::hash<k>` and `operator ==`.
+// Iteration order is arbitrary and changes as the map grows.
+// WARNING! Inserting can move every entry, so references to values (and `elementPointer`s)
+// should not be held across an insert; erasing only invalidates the erased entry.
+template <class k, class v>
+class map
+{   using entry = mapDetail::entry<k, v>;
+    using table = hashTable<entry, k, entry>;
+    table Table;
+
+public:
+    using element = mapElement<k, v &>;
+    using constElement = mapElement<k, const v &>;
+    typedef mapDetail::elementPointer<map *, v, element> elementPointer;
+    typedef mapDetail::elementPointer<const map *, const v, constElement> constElementPointer;
+    typedef staticIterator<v &, hashTableDetail::iteratorKernel<table *, v &, mapDetail::pickValue>>
+            valuesIterator;
+    typedef staticIterator
+    <   const v &, hashTableDetail::iteratorKernel<const table *, const v &, mapDetail::pickValue>
+    >   constValuesIterator;
+    typedef staticIterator<const k &, hashTableDetail::iteratorKernel<const table *, const k &, mapDetail::pickKey>>
+            keysIterator;
+
+    typedef k key;
+    typedef v value;
+
+    map() {}
+
+    map(std::initializer_list<std::pair<k, v>> Entries)
+    {   reserve(Entries.size());
+        for (const std::pair<k, v> &Entry : Entries)
+        {   insert(Entry.first, Entry.second);
+        }
+    }
+
+    inline index count() const
+    {   return Table.count();
+    }
+
+    inline bool empty() const
+    {   return Table.empty();
+    }
+
+    // Makes room for `Count` entries in total, so that inserting up to that many won't rehash.
+    inline void reserve(index Count)
+    {   Table.reserve(Count);
+    }
+
+    // Removes all entries but does not reclaim any memory.
+    inline void clear()
+    {   Table.clear();
+    }
+
+    // Clears the map and frees memory.  It is safe to continue using the map after this call.
+    inline void deallocate()
+    {   Table.deallocate();
+    }
+
+    inline bool contains(const k &Key) const
+    {   return Table.find(Key) >= 0;
+    }
+
+    // Returns a pointer to the value at `Key`, which is Null if there is no such key.
+    // Use e.g. `Map.get(Key).otherwise(defaultTo(Default))` for a fallback value.
+    elementPointer get(const k &Key)
+    {   const index Slot = Table.find(Key);
+        return Slot >= 0 ? elementPointer(this, Slot) : elementPointer();
+    }
+
+    // const version of the above.
+    constElementPointer get(const k &Key) const
+    {   const index Slot = Table.find(Key);
+        return Slot >= 0 ? constElementPointer(this, Slot) : constElementPointer();
+    }
+
+    // Returns the value at `Key`, throwing if there is none.
+    const v &operator[] (const k &Key) const
+    {   const index Slot = Table.find(Key);
+        if (Slot < 0)
+        {   throw error(MapMissingKeyErrorMsg, AT);
+        }
+        return Table.at(Slot)->Value;
+    }
+
+    // Returns the value at `Key`, adding a default-constructed value if there is none.
+    // WARNING! It is not memory safe to hold onto a reference here and then insert into the map.
+    v &operator[] (const k &Key)
+    {   bool Inserted;
+        const index Slot = Table.insert
+        (   Key, determining<bool>(Inserted),
+            [&Key](entry *Entry) { new (Entry) entry{.Key = Key, .Value = v()}; }
+        );
+        return Table.at(Slot)->Value;
+    }
+
+    // Sets the value at `Key` (overwriting any existing value) and returns a reference to it.
+    v &insert(k Key, v Value)
+    {   bool Inserted;
+        const index Slot = Table.insert
+        (   Key, determining<bool>(Inserted),
+            [&Key, &Value](entry *Entry)
+            {   new (Entry) entry{.Key = std::move(Key), .Value = std::move(Value)};
+            }
+        );
+        if (!Inserted)
+        {   Table.at(Slot)->Value = std::move(Value);
+        }
+        return Table.at(Slot)->Value;
+    }
+
+    // Constructs the value at `Key` from `Arguments` if there is no value there yet.
+    // Returns a reference to the value at `Key` either way.
+    template <class... arguments>
+    v &insertInPlace(const k &Key, arguments&&... Arguments)
+    {   bool Inserted;
+        const index Slot = Table.insert
+        (   Key, determining<bool>(Inserted),
+            [&](entry *Entry)
+            {   new (Entry) entry{.Key = Key, .Value = v(std::forward<arguments>(Arguments)...)};
+            }
+        );
+        return Table.at(Slot)->Value;
+    }
+
+    // Removes the value at `Key` and returns it, throwing if there is none.
+    v pop(const k &Key)
+    {   elementPointer Pointer = get(Key);
+        if (Pointer == Null)
+        {   throw error(MapMissingKeyErrorMsg, AT);
+        }
+        return Pointer.pop();
+    }
+
+    // Removes the value at `Key`, if any.  Returns true iff there was one.
+    bool erase(const k &Key)
+    {   const index Slot = Table.find(Key);
+        if (Slot < 0)
+        {   return False;
+        }
+        Table.erase(Slot);
+        return True;
+    }
+
+    bool operator == (const map &Other) const
+    {   if (count() != Other.count())
+        {   return False;
+        }
+        for (index Slot = Table.nextFull(-1); Slot >= 0; Slot = Table.nextFull(Slot))
+        {   const entry *Entry = Table.at(Slot);
+            const index OtherSlot = Other.Table.find(Entry->Key);
+            if (OtherSlot < 0 || !(Other.Table.at(OtherSlot)->Value == Entry->Value))
+            {   return False;
+            }
+        }
+        return True;
+    }
+
+    inline bool operator != (const map &Other) const
+    {   return !(*this == Other);
+    }
+
+    valuesIterator values() &
+    {   return valuesIterator(&Table);
+    }
+
+    constValuesIterator values() const &
+    {   return constValuesIterator(&Table);
+    }
+
+    keysIterator keys() const &
+    {   return keysIterator(&Table);
+    }
+
+    elementPointer first() &
+    {   const index Slot = Table.nextFull(-1);
+        return Slot >= 0 ? elementPointer(this, Slot) : elementPointer();
+    }
+
+    constElementPointer first() const &
+    {   const index Slot = Table.nextFull(-1);
+        return Slot >= 0 ? constElementPointer(this, Slot) : constElementPointer();
+    }
+
+    CONTAINER_ITERATOR(map)
+    MUTABLE_CONTAINER_ITERATOR(map)
+
+private:
+    template <class m1, class v1, class e1>
+    friend class mapDetail::elementPointer;
+};
+
+template <class k, class v>
+std::ostream &operator << (std::ostream &Out, const map<k, v> &Map)
+{   Out << "map({ ";
+    for (const auto &Element : Map)
+        Out << Element.Key << ": " << Element.Value << ", ";
+    return Out << "})";
+}
+
+TMVB
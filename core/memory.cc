@@ -1,5 +1,7 @@
 #include "memory.h"
 
+#include <vector>
+
 #ifndef NDEBUG
 #include "array.h"
 #include "string.h"
@@ -7,9 +9,230 @@
 
 BVMT
 
+const char *const ArenaAllocationErrorMsg = "arena could not allocate a new chunk";
+const char *const PoolAllocationErrorMsg = "pool could not allocate a new slab";
+const char *const PoolStaleHandleErrorMsg = "pool handle is stale, its object was destroyed";
+
+namespace memory
+{   std::ostream &operator << (std::ostream &Out, const allocationStats &Stats)
+    {   return Out << Stats.Allocations << " allocations (" << Stats.AllocationsLastFrame
+                << " last frame), " << Stats.BytesAllocated << " bytes allocated ("
+                << Stats.BytesLastFrame << " last frame), " << Stats.BytesLive << " bytes live, "
+                << Stats.BytesPeak << " bytes peak";
+    }
+
+    SINGLETON_CC(allocationTracker, {})
+
+    void allocationTracker::enable(bool Enable)
+    {   // Make sure the instance exists before any other thread can see `Enabled`.
+        get();
+        Enabled.store(Enable, std::memory_order_relaxed);
+    }
+
+    namespace
+    {   void addAllocation(allocationStats &Stats, index Bytes)
+        {   ++Stats.Allocations;
+            ++Stats.AllocationsThisFrame;
+            Stats.BytesAllocated += Bytes;
+            Stats.BytesThisFrame += Bytes;
+            Stats.BytesLive += Bytes;
+            Stats.BytesPeak = std::max(Stats.BytesPeak, Stats.BytesLive);
+        }
+
+        void addDeallocation(allocationStats &Stats, index Bytes)
+        {   ++Stats.Deallocations;
+            Stats.BytesLive -= Bytes;
+        }
+
+        void rollOverFrame(allocationStats &Stats)
+        {   Stats.AllocationsLastFrame = Stats.AllocationsThisFrame;
+            Stats.BytesLastFrame = Stats.BytesThisFrame;
+            Stats.AllocationsThisFrame = 0;
+            Stats.BytesThisFrame = 0;
+        }
+    }
+
+    void allocationTracker::allocated(const void *Pointer, index Bytes, const char *Kind)
+    {   const char *Scope = CurrentScope;
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Live[Pointer] = liveAllocation{.Bytes = Bytes, .Kind = Kind, .Scope = Scope};
+        addAllocation(Totals, Bytes);
+        addAllocation(ByTag[Kind], Bytes);
+        if (Scope != Null)
+        {   addAllocation(ByTag[Scope], Bytes);
+        }
+        addAllocation(BySite[{Scope == Null ? "" : Scope, Kind}], Bytes);
+    }
+
+    void allocationTracker::deallocated(const void *Pointer)
+    {   std::lock_guard<std::mutex> Lock(Mutex);
+        auto Found = Live.find(Pointer);
+        if (Found == Live.end())
+        {   // Allocated before tracking was enabled (or cleared).
+            return;
+        }
+        const liveAllocation Allocation = Found->second;
+        Live.erase(Found);
+        addDeallocation(Totals, Allocation.Bytes);
+        addDeallocation(ByTag[Allocation.Kind], Allocation.Bytes);
+        if (Allocation.Scope != Null)
+        {   addDeallocation(ByTag[Allocation.Scope], Allocation.Bytes);
+        }
+        addDeallocation
+        (   BySite[{Allocation.Scope == Null ? "" : Allocation.Scope, Allocation.Kind}],
+            Allocation.Bytes
+        );
+    }
+
+    void allocationTracker::endFrame()
+    {   std::lock_guard<std::mutex> Lock(Mutex);
+        rollOverFrame(Totals);
+        for (auto &Tag : ByTag)
+        {   rollOverFrame(Tag.second);
+        }
+        for (auto &Site : BySite)
+        {   rollOverFrame(Site.second);
+        }
+    }
+
+    allocationStats allocationTracker::totals() const
+    {   std::lock_guard<std::mutex> Lock(Mutex);
+        return Totals;
+    }
+
+    allocationStats allocationTracker::stats(const char *Tag) const
+    {   std::lock_guard<std::mutex> Lock(Mutex);
+        auto Found = ByTag.find(Tag);
+        return Found == ByTag.end() ? allocationStats() : Found->second;
+    }
+
+    void allocationTracker::report(std::ostream &Out, index TopCount) const
+    {   std::lock_guard<std::mutex> Lock(Mutex);
+        Out << "allocations: " << Totals << "\n";
+        std::vector<std::pair<std::pair<std::string_view, std::string_view>, allocationStats>> Sites
+        (   BySite.begin(), BySite.end()
+        );
+        std::sort
+        (   Sites.begin(), Sites.end(),
+            [](const auto &A, const auto &B) { return A.second.BytesAllocated > B.second.BytesAllocated; }
+        );
+        for (index I = 0; I < std::min(TopCount, (index)Sites.size()); ++I)
+        {   const auto &Site = Sites[I];
+            Out << "  " << (Site.first.first.empty() ? "(no scope)" : Site.first.first)
+                    << " / " << Site.first.second << ": " << Site.second << "\n";
+        }
+    }
+
+    void allocationTracker::clear()
+    {   std::lock_guard<std::mutex> Lock(Mutex);
+        Live.clear();
+        Totals = allocationStats();
+        ByTag.clear();
+        BySite.clear();
+    }
+
+    void *heapResource::allocateBytes(index Bytes, index Alignment, const char *Kind)
+    {   return allocateInline(Bytes, Alignment, Kind);
+    }
+
+    void heapResource::deallocateBytes(void *Pointer, index, index Alignment)
+    {   deallocateInline(Pointer, Alignment);
+    }
+
+    resource &heap()
+    {   static heapResource Heap;
+        return Heap;
+    }
+
+    arena::arena(index _ChunkSize)
+    :   ChunkSize(_ChunkSize)
+    {   ASSERT(ChunkSize > 0);
+    }
+
+    arena::~arena()
+    {   deallocate();
+    }
+
+    void arena::rewind(marker Marker)
+    {   if (Marker.Chunk == Null)
+        {   // Back to the very beginning, but keep the chunks.
+            Current = First;
+            if (Current != Null)
+            {   Current->Used = 0;
+            }
+            UsedBeforeCurrent = 0;
+            return;
+        }
+        Current = Marker.Chunk;
+        Current->Used = Marker.Used;
+        UsedBeforeCurrent = Marker.UsedBeforeChunk;
+    }
+
+    void arena::deallocate()
+    {   chunk *Chunk = First;
+        while (Chunk != Null)
+        {   chunk *Next = Chunk->Next;
+            memory::deallocate((u8 *)Chunk);
+            Chunk = Next;
+        }
+        First = Null;
+        Current = Null;
+        UsedBeforeCurrent = 0;
+    }
+
+    index arena::chunkCount() const
+    {   index Count = 0;
+        for (const chunk *Chunk = First; Chunk != Null; Chunk = Chunk->Next)
+        {   ++Count;
+        }
+        return Count;
+    }
+
+    void *arena::allocateInNextChunk(index Bytes, index Alignment)
+    {   chunk *Next = Current == Null ? First : Current->Next;
+        index Start = 0;
+        if (Next == Null || (Start = alignUp(Next, 0, Alignment)) + Bytes > Next->Capacity)
+        {   // Chunks after `Current` are kept in order, so a new chunk goes right after `Current`
+            // (and any too-small chunk after it gets reused on a later frame).
+            const index Capacity = std::max(ChunkSize, Bytes + Alignment - 1);
+            chunk *NewChunk = (chunk *)memory::allocate<u8>(sizeof(chunk) + Capacity, "arena");
+            if (NewChunk == Null)
+            {   throw error(ArenaAllocationErrorMsg, AT);
+            }
+            NewChunk->Next = Next;
+            NewChunk->Capacity = Capacity;
+            if (Current == Null)
+            {   First = NewChunk;
+            }
+            else
+            {   Current->Next = NewChunk;
+            }
+            Next = NewChunk;
+            Start = alignUp(Next, 0, Alignment);
+        }
+        if (Current != Null)
+        {   UsedBeforeCurrent += Current->Used;
+        }
+        Current = Next;
+        Current->Used = Start + Bytes;
+        return Current->bytes() + Start;
+    }
+
+    arena &frameArena()
+    {   static arena FrameArena;
+        return FrameArena;
+    }
+}
+
 #ifndef NDEBUG
 using test::noisy;
+using test::parent;
 using namespace memory;
+
+namespace
+{   using arenaVector = std::vector<i32, arenaAllocator<i32>>;
+}
+
 void test__core__memory()
 {   TEST
     (   "allocate + deallocate works with primitive type",
@@ -25,7 +248,212 @@ void test__core__memory()
         );
     );
 
-    // TODO: reallocate
+    TEST
+    (   "arena allocations are aligned and bump within a chunk",
+        arena Arena(1024);
+        EXPECT_EQUAL(Arena.chunkCount(), 0);
+        u8 *Byte = Arena.allocate<u8>(1);
+        i64 *Ints = Arena.allocate<i64>(4);
+        EXPECT_EQUAL((size_t)Ints % alignof(i64), (size_t)0);
+        EXPECT_EQUAL((u8 *)Ints > Byte, True);
+        EXPECT_EQUAL(Arena.bytesUsed(), 40);
+        void *Aligned = Arena.allocate(3, 64);
+        EXPECT_EQUAL((size_t)Aligned % 64, (size_t)0);
+        EXPECT_EQUAL(Arena.chunkCount(), 1);
+        // The chunk comes from `memory::allocate`:
+        ASSERT_STRING(TestPrintOutput.pull(), contains("allocate<1x>("));
+    );
+
+    TEST
+    (   "arena can rewind to a mark and reuse chunks after a reset",
+        arena Arena(256);
+        Arena.allocate<u8>(100);
+        arena::marker Marker = Arena.mark();
+        u8 *AfterMark = Arena.allocate<u8>(100);
+        // Doesn't fit in the first chunk:
+        Arena.allocate<u8>(100);
+        EXPECT_EQUAL(Arena.chunkCount(), 2);
+        EXPECT_EQUAL(Arena.bytesUsed(), 300);
+
+        Arena.rewind(Marker);
+        EXPECT_EQUAL(Arena.bytesUsed(), 100);
+        EXPECT_EQUAL(Arena.allocate<u8>(100), AfterMark);
+
+        Arena.reset();
+        EXPECT_EQUAL(Arena.bytesUsed(), 0);
+        for (int Frame = 0; Frame < 3; ++Frame)
+        {   Arena.allocate<u8>(200);
+            Arena.allocate<u8>(200);
+            Arena.allocate<u8>(200);
+            EXPECT_EQUAL(Arena.chunkCount(), 3);
+            Arena.reset();
+        }
+        // Bigger than a chunk:
+        u8 *Big = Arena.allocate<u8>(1000);
+        Big[999] = 1;
+        EXPECT_EQUAL(Arena.chunkCount(), 4);
+        EXPECT_EQUAL(Arena.bytesUsed(), 1000);
+        Arena.deallocate();
+        EXPECT_EQUAL(Arena.chunkCount(), 0);
+        EXPECT_EQUAL(Arena.bytesUsed(), 0);
+        // Unlike `reset`, this frees the chunks:
+        ASSERT_STRING(TestPrintOutput.pull(), contains("deallocate("));
+    );
+
+    TEST
+    (   "arenaAllocator works with standard containers",
+        arena Arena(128);
+        {   arenaVector Vector{arenaAllocator<i32>(Arena)};
+            for (i32 I = 0; I < 100; ++I)
+            {   Vector.push_back(I);
+            }
+            EXPECT_EQUAL(Vector[99], 99);
+            EXPECT_EQUAL(Arena.bytesUsed() >= 100 * (index)sizeof(i32), True);
+        }
+        EXPECT_EQUAL(arenaAllocator<i32>(Arena) == arenaAllocator<i64>(Arena), True);
+        Arena.reset();
+        EXPECT_EQUAL(Arena.bytesUsed(), 0);
+        ASSERT_STRING(TestPrintOutput.pull(), contains("allocate<1x>("));
+    );
+
+    TEST
+    (   "pool reuses freed slots and detects stale handles",
+        pool<parent> Parents;
+        poolHandle First = Parents.create(1);
+        poolHandle Second = Parents.create(2);
+        ASSERT_STRING(TestPrintOutput.pull(), contains("parent(1)parent(2)"));
+        EXPECT_EQUAL(Parents.count(), 2);
+        EXPECT_EQUAL(Parents.capacity(), pool<parent>::SlotsPerSlab);
+        EXPECT_EQUAL(Parents[Second].Value, 2);
+        parent *SecondPointer = Parents.get(Second);
+
+        Parents.destroy(Second);
+        ASSERT_STRING(TestPrintOutput.pull(), contains("~parent(2)"));
+        EXPECT_EQUAL(Parents.contains(Second), False);
+        EXPECT_EQUAL(Parents.get(Second), (parent *)Null);
+        EXPECT_THROW(Parents[Second], PoolStaleHandleErrorMsg);
+        EXPECT_THROW(Parents.destroy(Second), PoolStaleHandleErrorMsg);
+        EXPECT_EQUAL(Parents.contains(poolHandle()), False);
+
+        // The slot gets reused, but the old handle stays stale:
+        poolHandle Third = Parents.create(3);
+        EXPECT_EQUAL(Parents.get(Third), SecondPointer);
+        EXPECT_EQUAL(Third.Index, Second.Index);
+        EXPECT_EQUAL(Third == Second, False);
+        EXPECT_EQUAL(Parents.contains(Second), False);
+        EXPECT_EQUAL(Parents[First].Value, 1);
+        ASSERT_STRING(TestPrintOutput.pull(), contains("parent(3)"));
+
+        Parents.deallocate();
+        ASSERT_STRING(TestPrintOutput.pull(), contains("~parent(1)~parent(3)"));
+        EXPECT_EQUAL(Parents.count(), 0);
+        EXPECT_EQUAL(Parents.contains(First), False);
+    );
+
+    TEST
+    (   "pool grows by cache-line aligned slabs without moving objects",
+        pool<i64> Ints;
+        array<poolHandle> Handles;
+        array<i64 *> Pointers;
+        for (i64 I = 0; I < 3 * pool<i64>::SlotsPerSlab; ++I)
+        {   Handles.append(Ints.create(I));
+            Pointers.append(Ints.get(Handles[-1]));
+        }
+        EXPECT_EQUAL(Ints.capacity(), 3 * pool<i64>::SlotsPerSlab);
+        for (index I = 0; I < Handles.count(); ++I)
+        {   EXPECT_EQUAL(Ints.get(Handles[I]), Pointers[I]);
+            EXPECT_EQUAL(*Pointers[I], I);
+        }
+        for (index Slab = 0; Slab < 3; ++Slab)
+        {   i64 *SlabStart = Pointers[Slab * pool<i64>::SlotsPerSlab];
+            EXPECT_EQUAL((size_t)SlabStart % pool<i64>::CacheLineBytes, (size_t)0);
+        }
+        // Slabs come from `memory::allocate`:
+        ASSERT_STRING(TestPrintOutput.pull(), contains("allocate<1x>("));
+    );
+
+    TEST
+    (   "pool can hand out owning pointers",
+        pool<parent> Parents;
+        {   pointer<parent> Pointer = Parents.createOwned(7);
+            EXPECT_EQUAL(Pointer->Value, 7);
+            EXPECT_EQUAL(Pointer.isOwned(), True);
+            EXPECT_EQUAL(Parents.count(), 1);
+            ASSERT_STRING(TestPrintOutput.pull(), contains("parent(7)"));
+        }
+        ASSERT_STRING(TestPrintOutput.pull(), contains("~parent(7)"));
+        EXPECT_EQUAL(Parents.count(), 0);
+        poolHandle Reused = Parents.create(8);
+        EXPECT_EQUAL(Reused.Index, (u32)0);
+        EXPECT_EQUAL(Reused.Generation, (u32)3);
+        ASSERT_STRING(TestPrintOutput.pull(), contains("parent(8)"));
+    );
+
+    TEST
+    (   "allocationTracker counts containers by kind and scope",
+        allocationTracker::enable();
+        allocationTracker *Tracker = allocationTracker::get();
+        Tracker->clear();
+        {   array<i64> Ints;
+            Ints.reserve(10);
+            EXPECT_EQUAL(Tracker->stats("array").Allocations, 1);
+            EXPECT_EQUAL(Tracker->stats("array").BytesLive, 80);
+            {   allocationScope Scope("font::write");
+                string Text = "long enough to not fit in a small string";
+                Text.reserve(100);
+                i64 *Raw = allocate<i64>(4);
+                deallocate(Raw);
+            }
+            allocationStats FontWrite = Tracker->stats("font::write");
+            EXPECT_EQUAL(FontWrite.Allocations >= 3, True);
+            EXPECT_EQUAL(FontWrite.BytesLive, 0);
+            EXPECT_EQUAL(FontWrite.BytesPeak >= 100 + 32, True);
+            EXPECT_EQUAL(Tracker->stats("string").Deallocations, Tracker->stats("string").Allocations);
+            EXPECT_EQUAL(Tracker->stats("memory").Allocations, 1);
+            EXPECT_EQUAL(Tracker->stats("memory").BytesAllocated, 32);
+        }
+        allocationStats Totals = Tracker->totals();
+        EXPECT_EQUAL(Totals.BytesLive, 0);
+        EXPECT_EQUAL(Totals.Allocations, Totals.Deallocations);
+        EXPECT_EQUAL(Tracker->stats("nothing").Allocations, 0);
+
+        Tracker->endFrame();
+        EXPECT_EQUAL(Tracker->totals().AllocationsLastFrame, Totals.Allocations);
+        EXPECT_EQUAL(Tracker->stats("array").BytesLastFrame, 80);
+        Tracker->endFrame();
+        EXPECT_EQUAL(Tracker->totals().AllocationsLastFrame, 0);
+
+        std::ostringstream Report;
+        Tracker->report(Report, 2);
+        ASSERT_STRING(Report.str(), contains("font::write / string: "));
+        ASSERT_STRING(Report.str(), contains("(no scope) / array: "));
+
+        allocationTracker::enable(False);
+        const index TrackedAllocations = Tracker->totals().Allocations;
+        array<i64> Untracked({1, 2, 3});
+        EXPECT_EQUAL(Tracker->totals().Allocations, TrackedAllocations);
+        Tracker->clear();
+        ASSERT_STRING(TestPrintOutput.pull(), contains("allocate<8x>(4)"));
+    );
+
+    TEST
+    (   "reallocate reports the old and new allocations to the allocationTracker",
+        allocationTracker::enable();
+        allocationTracker *Tracker = allocationTracker::get();
+        Tracker->clear();
+        i64 *Ints = allocate<i64>(4);
+        Ints = reallocate(Ints, 1000);
+        EXPECT_EQUAL(Tracker->totals().Allocations, 2);
+        EXPECT_EQUAL(Tracker->totals().BytesLive, 8000);
+        Ints = reallocate(Ints, 2);
+        EXPECT_EQUAL(Tracker->totals().BytesLive, 16);
+        deallocate(Ints);
+        EXPECT_EQUAL(Tracker->totals().BytesLive, 0);
+        EXPECT_EQUAL(Tracker->totals().Deallocations, 3);
+        allocationTracker::enable(False);
+        Tracker->clear();
+        ASSERT_STRING(TestPrintOutput.pull(), contains("reallocate<8x>("));
+    );
 }
 #endif
 
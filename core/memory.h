@@ -2,24 +2,129 @@
 
 #include "arg.h"
 #include "error.h"
+#include "pointer.h"
 #include "types.h"
 
+#include <algorithm>  // std::max
+#include <atomic>
+#include <cstddef>    // std::max_align_t
+#include <map>
+#include <new>        // std::align_val_t
+#include <mutex>
 #include <stdlib.h> // malloc, realloc, oh yeah i'm weird
+#include <string_view>
+#include <unordered_map>
+#include <utility>    // std::pair
 
 BVMT
 
-DEBUG_ONLY(static bool MemoryDebug = False);
+DEBUG_ONLY(inline bool MemoryDebug = False);
 
 #define LOG_MEMORY(X) DEBUG_ONLY \
 (   if (TestOnly || MemoryDebug) std::cout << X \
 )
 
+extern const char *const ArenaAllocationErrorMsg;
+extern const char *const PoolAllocationErrorMsg;
+extern const char *const PoolStaleHandleErrorMsg;
+
 namespace memory
-{   // Allocates a number of elements without initialization.
+{   // Counts for allocations with some tag, see `allocationTracker`.
+    struct allocationStats
+    {   index Allocations = 0;
+        index Deallocations = 0;
+        // Total bytes ever allocated, i.e., the churn.
+        index BytesAllocated = 0;
+        index BytesLive = 0;
+        index BytesPeak = 0;
+        index AllocationsLastFrame = 0;
+        index BytesLastFrame = 0;
+        // Counts for the frame in progress, which become `...LastFrame` on `endFrame()`.
+        index AllocationsThisFrame = 0;
+        index BytesThisFrame = 0;
+    };
+
+    std::ostream &operator << (std::ostream &Out, const allocationStats &Stats);
+
+    // Tracks which subsystems allocate (and churn) how much memory, without a full heap profiler.
+    // `memory::allocate`/`reallocate`/`deallocate`, `array`, and `string` all report here when
+    // tracking is enabled; it costs one relaxed atomic load per allocation when it's not.
+    // Each allocation is tagged by its kind (e.g., "array", "hashTable") and by the innermost
+    // `allocationScope` on the allocating thread (e.g., "font::write"), if any; stats can be
+    // queried for either, and the report lists the top (scope, kind) pairs as the call sites.
+    // Tags must outlive the tracker, so use string literals.
+    // Its bookkeeping uses the standard allocator so it doesn't track itself.
+    class allocationTracker
+    {   SINGLETON_H(allocationTracker)
+    public:
+        static inline bool enabled()
+        {   return Enabled.load(std::memory_order_relaxed);
+        }
+
+        // Start tracking before creating any worker threads; allocations made before tracking
+        // is enabled are ignored when freed.
+        static void enable(bool Enable = True);
+
+        void allocated(const void *Pointer, index Bytes, const char *Kind);
+        void deallocated(const void *Pointer);
+
+        // Rolls the per-frame counts over; `window::draw` calls this after each frame.
+        void endFrame();
+
+        allocationStats totals() const;
+        // Stats for all allocations with `Tag` as their kind or scope.
+        allocationStats stats(const char *Tag) const;
+
+        // Prints the totals and the `TopCount` call sites that allocated the most bytes.
+        void report(std::ostream &Out, index TopCount = 10) const;
+
+        // Forgets everything tracked so far.
+        void clear();
+
+    private:
+        struct liveAllocation
+        {   index Bytes;
+            const char *Kind;
+            const char *Scope;
+        };
+
+        static inline std::atomic<bool> Enabled = False;
+        static inline thread_local const char *CurrentScope = Null;
+
+        mutable std::mutex Mutex;
+        std::unordered_map<const void *, liveAllocation> Live;
+        allocationStats Totals;
+        std::map<std::string_view, allocationStats> ByTag;
+        // Keyed by (scope, kind), where an allocation outside of any scope has an empty scope.
+        std::map<std::pair<std::string_view, std::string_view>, allocationStats> BySite;
+
+        friend class allocationScope;
+    };
+
+    // Tags allocations on this thread with `Scope` until descoped, e.g.,
+    //     memory::allocationScope Scope("font::write");
+    class allocationScope
+    {   const char *Previous;
+    public:
+        explicit allocationScope(const char *Scope)
+        :   Previous(allocationTracker::CurrentScope)
+        {   allocationTracker::CurrentScope = Scope;
+        }
+
+        ~allocationScope()
+        {   allocationTracker::CurrentScope = Previous;
+        }
+
+        UNCOPYABLE_CLASS(allocationScope)
+        UNMOVABLE_CLASS(allocationScope)
+    };
+
+    // Allocates a number of elements without initialization.
     // Will update the Number passed in if the memory allocator returns more space than you asked for.
     // Will return Null if we can't allocate that much memory.
+    // `Kind` tags the allocation for the `allocationTracker`.
     template <class t>
-    t *allocate(suggestingAtLeast<index> Number)
+    t *allocate(suggestingAtLeast<index> Number, const char *Kind = "memory")
     {   size_t Memory = *Number * sizeof(t);
         if (*Number < 0 || Memory < (size_t)*Number)
         {   // overflow or something else weird
@@ -28,12 +133,15 @@ namespace memory
         }
         t *Result = (t *)malloc(Memory);
         LOG_MEMORY("allocate<" << sizeof(t) << "x>(" << *Number << ")|"  << (int *)Result << "|");
+        if (allocationTracker::enabled() && Result != Null)
+        {   allocationTracker::get()->allocated(Result, Memory, Kind);
+        }
         return Result;
     }
 
     template <class t>
-    inline t *allocate(index Number)
-    {   return allocate<t>(suggestingAtLeast(Number));
+    inline t *allocate(index Number, const char *Kind = "memory")
+    {   return allocate<t>(suggestingAtLeast(Number), Kind);
     }
 
     template <class t>
@@ -60,7 +168,7 @@ namespace memory
     // Will update the Number passed in if the memory allocator returns more space than you asked for.
     // Will return Null if we can't allocate that much memory.
     template <class t>
-    t *reallocate(t *CurrentPointer, suggestingAtLeast<index> Number)
+    t *reallocate(t *CurrentPointer, suggestingAtLeast<index> Number, const char *Kind = "memory")
     {   size_t Memory = *Number * sizeof(t);
         if (*Number < 0 || Memory < (size_t)*Number)
         {   // overflow or something else weird
@@ -70,24 +178,523 @@ namespace memory
             );
             return Null;
         }
-        t *Result = (t *)realloc(CurrentPointer, Memory);
         LOG_MEMORY
         (   "reallocate<" << sizeof(t) << "x>(" << (int *)CurrentPointer << ", " << *Number << ")"
-                    "|" << (int *)Result << "|"
         );
+        // `CurrentPointer` can't be used after `realloc`, so it's untracked beforehand.
+        // If `realloc` fails, it stays untracked, like memory allocated before tracking.
+        const bool Tracking = allocationTracker::enabled();
+        if (Tracking && CurrentPointer != Null)
+        {   allocationTracker::get()->deallocated(CurrentPointer);
+        }
+        t *Result = (t *)realloc(CurrentPointer, Memory);
+        LOG_MEMORY("|" << (int *)Result << "|");
+        if (Tracking && Result != Null)
+        {   allocationTracker::get()->allocated(Result, Memory, Kind);
+        }
         return Result;
     }
 
     template <class t>
-    inline t *reallocate(t *CurrentPointer, index Number)
-    {   return reallocate(CurrentPointer, suggestingAtLeast(Number));
+    inline t *reallocate(t *CurrentPointer, index Number, const char *Kind = "memory")
+    {   return reallocate(CurrentPointer, suggestingAtLeast(Number), Kind);
     }
 
     template <class t>
     inline void deallocate(t *Pointer)
     {   LOG_MEMORY("deallocate(" << (int *)Pointer << ")");
+        if (allocationTracker::enabled() && Pointer != Null)
+        {   allocationTracker::get()->deallocated(Pointer);
+        }
         free(Pointer);
     }
+
+    // Somewhere that containers like `array` and `string` can get their memory from, e.g.,
+    // an `arena` for per-frame scratch or for long-lived level data, instead of the heap.
+    // The resource must outlive everything allocated from it.
+    class resource
+    {
+    public:
+        virtual ~resource() {}
+
+        // `Kind` is for the `allocationTracker`, e.g., "array".
+        virtual void *allocateBytes(index Bytes, index Alignment, const char *Kind) = 0;
+        virtual void deallocateBytes(void *Pointer, index Bytes, index Alignment) = 0;
+    };
+
+    // The general heap, which is what containers use by default.
+    // Reports to the `allocationTracker` when tracking is enabled.
+    class heapResource : public resource
+    {
+    public:
+        void *allocateBytes(index Bytes, index Alignment, const char *Kind) override;
+        void deallocateBytes(void *Pointer, index Bytes, index Alignment) override;
+
+        static inline void *allocateInline(index Bytes, index Alignment, const char *Kind)
+        {   void *Result = ::operator new((size_t)Bytes, std::align_val_t((size_t)Alignment));
+            if (allocationTracker::enabled())
+            {   allocationTracker::get()->allocated(Result, Bytes, Kind);
+            }
+            return Result;
+        }
+
+        static inline void deallocateInline(void *Pointer, index Alignment)
+        {   if (allocationTracker::enabled())
+            {   allocationTracker::get()->deallocated(Pointer);
+            }
+            ::operator delete(Pointer, std::align_val_t((size_t)Alignment));
+        }
+    };
+
+    resource &heap();
+
+    // An STL-style allocator for a `resource`, tagged with `tag::Name` for the
+    // `allocationTracker`; e.g., for `array`'s std::vector.
+    // Like std::pmr allocators, the resource sticks to the container: assigning or swapping
+    // containers moves elements between resources if they differ, and a copy-constructed
+    // container goes on the heap, while a move-constructed one takes the resource along.
+    template <class t, class tag>
+    class resourceAllocator
+    {   // Null means the heap, so that default-constructed containers don't need to look it up.
+        resource *Resource = Null;
+
+        template <class u, class tag2>
+        friend class resourceAllocator;
+    public:
+        typedef t value_type;
+
+        resourceAllocator() {}
+
+        resourceAllocator(resource &_Resource)
+        :   Resource(&_Resource == &heap() ? Null : &_Resource)
+        {}
+
+        template <class u>
+        resourceAllocator(const resourceAllocator<u, tag> &Other)
+        :   Resource(Other.Resource)
+        {}
+
+        inline resource &getResource() const
+        {   return Resource == Null ? heap() : *Resource;
+        }
+
+        inline t *allocate(size_t Count)
+        {   return Resource == Null
+                ?   (t *)heapResource::allocateInline(Count * sizeof(t), alignof(t), tag::Name)
+                :   (t *)Resource->allocateBytes(Count * sizeof(t), alignof(t), tag::Name);
+        }
+
+        inline void deallocate(t *Pointer, size_t Count)
+        {   if (Resource == Null)
+            {   heapResource::deallocateInline(Pointer, alignof(t));
+            }
+            else
+            {   Resource->deallocateBytes(Pointer, Count * sizeof(t), alignof(t));
+            }
+        }
+
+        inline resourceAllocator select_on_container_copy_construction() const
+        {   return resourceAllocator();
+        }
+
+        template <class u>
+        inline bool operator == (const resourceAllocator<u, tag> &Other) const
+        {   return Resource == Other.Resource;
+        }
+
+        template <class u>
+        inline bool operator != (const resourceAllocator<u, tag> &Other) const
+        {   return Resource != Other.Resource;
+        }
+    };
+
+    // A bump allocator: allocations just move a pointer forward in the current chunk,
+    // and everything is freed at once via `reset()` (or back to a `mark()` via `rewind`).
+    // Chunks are kept around after a reset, so an arena which is reset every frame
+    // stops calling `memory::allocate` once it has grown to fit a frame's allocations.
+    // NOTE! Destructors are never called for things in the arena, so only put types
+    // there that don't need them, or call them yourself before rewinding.
+    // An arena is not thread-safe; use one per thread.
+    // It's also a `resource`, e.g., `array<int> Scratch(memory::frameArena());`.
+    class arena : public resource
+    {   struct chunk
+        {   chunk *Next;
+            index Capacity;
+            index Used;
+
+            inline u8 *bytes()
+            {   return (u8 *)(this + 1);
+            }
+        };
+
+        chunk *First = Null;
+        chunk *Current = Null;
+        // Minimum size of each chunk's bytes.
+        index ChunkSize;
+        // Bytes used in all chunks before `Current`, so that `bytesUsed()` is O(1).
+        index UsedBeforeCurrent = 0;
+    public:
+        // Where to `rewind` back to; see `arena::mark`.
+        struct marker
+        {   chunk *Chunk = Null;
+            index Used = 0;
+            index UsedBeforeChunk = 0;
+        };
+
+        static constexpr index DefaultChunkSize = 64 * 1024;
+
+        explicit arena(index _ChunkSize = DefaultChunkSize);
+        ~arena();
+
+        UNCOPYABLE_CLASS(arena)
+        UNMOVABLE_CLASS(arena)
+
+        // Returns uninitialized memory for `Bytes` bytes, aligned to `Alignment` (a power of two).
+        // Throws `ArenaAllocationErrorMsg` if a new chunk is needed and can't be allocated.
+        inline void *allocate(index Bytes, index Alignment = alignof(std::max_align_t))
+        {   ASSERT(Bytes >= 0 && Alignment > 0 && (Alignment & (Alignment - 1)) == 0);
+            if (Current != Null)
+            {   const index Start = alignUp(Current, Current->Used, Alignment);
+                if (Start + Bytes <= Current->Capacity)
+                {   Current->Used = Start + Bytes;
+                    return Current->bytes() + Start;
+                }
+            }
+            return allocateInNextChunk(Bytes, Alignment);
+        }
+
+        // Returns uninitialized memory for `Count` elements of type `t`.
+        template <class t>
+        inline t *allocate(index Count)
+        {   return (t *)allocate(Count * sizeof(t), alignof(t));
+        }
+
+        void *allocateBytes(index Bytes, index Alignment, const char *) override
+        {   return allocate(Bytes, Alignment);
+        }
+
+        // Memory only comes back on `rewind`/`reset`.
+        void deallocateBytes(void *, index, index) override {}
+
+        // Everything allocated after this can be freed via `rewind(Marker)`.
+        inline marker mark() const
+        {   return marker
+            {   .Chunk = Current,
+                .Used = Current == Null ? 0 : Current->Used,
+                .UsedBeforeChunk = UsedBeforeCurrent,
+            };
+        }
+
+        // Frees everything allocated since `Marker` was made.  Markers made after
+        // `Marker` are no longer valid.
+        void rewind(marker Marker);
+
+        // Frees everything in the arena, but keeps the chunks for reuse.
+        inline void reset()
+        {   rewind(marker());
+        }
+
+        // Frees everything in the arena, including the chunks.
+        void deallocate();
+
+        // Bytes handed out since the last reset, including padding for alignment.
+        inline index bytesUsed() const
+        {   return UsedBeforeCurrent + (Current == Null ? 0 : Current->Used);
+        }
+
+        // Number of chunks, which only goes down via `deallocate()`.
+        index chunkCount() const;
+
+    private:
+        static inline index alignUp(chunk *Chunk, index Used, index Alignment)
+        {   const size_t Address = (size_t)(Chunk->bytes() + Used);
+            return Used + (index)((Alignment - Address % Alignment) % Alignment);
+        }
+
+        void *allocateInNextChunk(index Bytes, index Alignment);
+    };
+
+    // The arena for allocations which only need to last until the end of the current frame,
+    // e.g., for formatting text or temporary arrays.  `window::draw` resets it after each frame.
+    // Only for use on the main thread.
+    arena &frameArena();
+
+    // A handle to an object in a `pool<t>`.  Unlike a raw pointer, a handle to a destroyed
+    // object is detected as stale (even if its slot was reused for a new object),
+    // so holding onto one past its object's lifetime is safe; see `pool::get`.
+    struct poolHandle
+    {   u32 Index = 0;
+        // Odd while the object is alive; zero (the default) is never valid.
+        u32 Generation = 0;
+
+        inline bool operator == (const poolHandle &Other) const
+        {   return Index == Other.Index && Generation == Other.Generation;
+        }
+
+        inline bool operator != (const poolHandle &Other) const
+        {   return !(*this == Other);
+        }
+    };
+
+    inline std::ostream &operator << (std::ostream &Out, const poolHandle &Handle)
+    {   return Out << "poolHandle(" << Handle.Index << ", " << Handle.Generation << ")";
+    }
+
+    // A typed pool for objects that are frequently created and destroyed (e.g., game objects),
+    // with O(1) `create`/`destroy`.  Objects live in fixed-size slabs which are never moved or freed
+    // until the pool is, so pointers to live objects stay valid, and freed slots are reused via
+    // a free list instead of going back to the general heap.  Slabs are aligned to cache lines.
+    // Not thread-safe.
+    template <class t>
+    class pool
+    {   static constexpr u32 NoSlot = (u32)-1;
+
+        struct slot
+        {   // Needs to be first so that a `t *` can be converted back to its `slot *`.
+            alignas(t) u8 Storage[sizeof(t)];
+            // Bumped on create and destroy, so that it's odd while the object is alive.
+            u32 Generation;
+            u32 Index;
+            u32 NextFree;
+
+            inline t *value()
+            {   return (t *)Storage;
+            }
+
+            inline bool alive() const
+            {   return Generation % 2 == 1;
+            }
+        };
+
+        // Each slab is allocated separately (with some extra room for aligning to a cache line).
+        u8 **SlabAllocations = Null;
+        slot **Slabs = Null;
+        index SlabCount = 0;
+        index SlabCapacity = 0;
+        u32 SlotCount = 0;
+        u32 FirstFree = NoSlot;
+        index LiveCount = 0;
+
+    public:
+        static constexpr index SlotsPerSlab = 64;
+        static constexpr index CacheLineBytes = 64;
+
+        pool() {}
+
+        ~pool()
+        {   deallocate();
+        }
+
+        UNCOPYABLE_CLASS(pool)
+        UNMOVABLE_CLASS(pool)
+
+        // Constructs a `t` with `Args` in a free slot, allocating a new slab if there are none.
+        template <class... args>
+        poolHandle create(args &&... Args)
+        {   slot *Slot = acquireSlot();
+            try
+            {   new (Slot->Storage) t(std::forward<args>(Args)...);
+            }
+            catch (...)
+            {   Slot->NextFree = FirstFree;
+                FirstFree = Slot->Index;
+                throw;
+            }
+            ++Slot->Generation;
+            ++LiveCount;
+            return poolHandle{.Index = Slot->Index, .Generation = Slot->Generation};
+        }
+
+        // Like `create`, but the returned `pointer` destroys the object when descoped,
+        // i.e., like `pointer::deleteOnDescope` but with the pool instead of the heap.
+        // The pool must outlive the pointer.
+        template <class... args>
+        pointer<t> createOwned(args &&... Args)
+        {   poolHandle Handle = create(std::forward<args>(Args)...);
+            return pointer<t>
+            (   slotAt(Handle.Index)->value(),
+                [this](t *Value) { destroySlot((slot *)Value); }
+            );
+        }
+
+        // Destroys the object for `Handle` and frees its slot for reuse.
+        // Throws if the handle is stale, e.g., it was already destroyed.
+        void destroy(poolHandle Handle)
+        {   slot *Slot = liveSlot(Handle);
+            if (Slot == Null)
+            {   throw error(PoolStaleHandleErrorMsg, AT);
+            }
+            destroySlot(Slot);
+        }
+
+        // Returns Null if `Handle` is stale, i.e., its object was destroyed.
+        inline t *get(poolHandle Handle)
+        {   slot *Slot = liveSlot(Handle);
+            return Slot == Null ? Null : Slot->value();
+        }
+
+        inline const t *get(poolHandle Handle) const
+        {   return const_cast<pool *>(this)->get(Handle);
+        }
+
+        inline bool contains(poolHandle Handle) const
+        {   return get(Handle) != Null;
+        }
+
+        // Throws if `Handle` is stale.
+        inline t &operator[] (poolHandle Handle)
+        {   t *Value = get(Handle);
+            if (Value == Null)
+            {   throw error(PoolStaleHandleErrorMsg, AT);
+            }
+            return *Value;
+        }
+
+        inline const t &operator[] (poolHandle Handle) const
+        {   return const_cast<pool *>(this)->operator[](Handle);
+        }
+
+        // Number of live objects.
+        inline index count() const
+        {   return LiveCount;
+        }
+
+        inline bool empty() const
+        {   return LiveCount == 0;
+        }
+
+        // Number of slots, live or free; only grows (by `SlotsPerSlab` at a time) until `deallocate()`.
+        inline index capacity() const
+        {   return SlotCount;
+        }
+
+        // Destroys all live objects and frees all slabs.  All handles become stale,
+        // and (unlike after `destroy`) a later handle may compare equal to an old one.
+        void deallocate()
+        {   for (u32 Index = 0; Index < SlotCount; ++Index)
+            {   slot *Slot = slotAt(Index);
+                if (Slot->alive())
+                {   deconstruct(Slot->value());
+                }
+            }
+            for (index I = 0; I < SlabCount; ++I)
+            {   memory::deallocate(SlabAllocations[I]);
+            }
+            memory::deallocate(SlabAllocations);
+            memory::deallocate(Slabs);
+            SlabAllocations = Null;
+            Slabs = Null;
+            SlabCount = 0;
+            SlabCapacity = 0;
+            SlotCount = 0;
+            FirstFree = NoSlot;
+            LiveCount = 0;
+        }
+
+    private:
+        inline slot *slotAt(u32 Index) const
+        {   return &Slabs[Index / SlotsPerSlab][Index % SlotsPerSlab];
+        }
+
+        inline slot *liveSlot(poolHandle Handle) const
+        {   if (Handle.Index >= SlotCount)
+            {   return Null;
+            }
+            slot *Slot = slotAt(Handle.Index);
+            return Slot->Generation == Handle.Generation && Slot->alive() ? Slot : Null;
+        }
+
+        void destroySlot(slot *Slot)
+        {   ASSERT(Slot->alive());
+            ++Slot->Generation;
+            --LiveCount;
+            Slot->NextFree = FirstFree;
+            FirstFree = Slot->Index;
+            // Free the slot first in case the destructor throws.
+            deconstruct(Slot->value());
+        }
+
+        slot *acquireSlot()
+        {   if (FirstFree == NoSlot)
+            {   addSlab();
+            }
+            slot *Slot = slotAt(FirstFree);
+            FirstFree = Slot->NextFree;
+            return Slot;
+        }
+
+        void addSlab()
+        {   if (SlotCount > NoSlot - SlotsPerSlab)
+            {   throw error(PoolAllocationErrorMsg, AT);
+            }
+            if (SlabCount == SlabCapacity)
+            {   index NewCapacity = std::max(SlabCapacity * 2, (index)4);
+                u8 **NewAllocations = memory::reallocate<u8 *>(SlabAllocations, NewCapacity, "pool");
+                if (NewAllocations == Null)
+                {   throw error(PoolAllocationErrorMsg, AT);
+                }
+                SlabAllocations = NewAllocations;
+                slot **NewSlabs = memory::reallocate<slot *>(Slabs, NewCapacity, "pool");
+                if (NewSlabs == Null)
+                {   throw error(PoolAllocationErrorMsg, AT);
+                }
+                Slabs = NewSlabs;
+                SlabCapacity = NewCapacity;
+            }
+            const index Alignment = std::max(CacheLineBytes, (index)alignof(slot));
+            u8 *Allocation = memory::allocate<u8>(SlotsPerSlab * sizeof(slot) + Alignment - 1, "pool");
+            if (Allocation == Null)
+            {   throw error(PoolAllocationErrorMsg, AT);
+            }
+            const size_t Address = (size_t)Allocation;
+            slot *Slab = (slot *)(Allocation + (Alignment - Address % Alignment) % Alignment);
+            // Chain the new slots onto the free list in order, so they're handed out in order.
+            for (index I = 0; I < SlotsPerSlab; ++I)
+            {   slot &Slot = Slab[I];
+                Slot.Generation = 0;
+                Slot.Index = SlotCount + I;
+                Slot.NextFree = I + 1 < SlotsPerSlab ? SlotCount + I + 1 : FirstFree;
+            }
+            FirstFree = SlotCount;
+            SlabAllocations[SlabCount] = Allocation;
+            Slabs[SlabCount] = Slab;
+            ++SlabCount;
+            SlotCount += SlotsPerSlab;
+        }
+    };
+
+    // An STL-style allocator for an `arena`, e.g., `std::vector<int, arenaAllocator<int>>`.
+    // Deallocating is a no-op; the memory comes back when the arena is reset.
+    template <class t>
+    class arenaAllocator
+    {   arena *Arena;
+
+        template <class u>
+        friend class arenaAllocator;
+    public:
+        typedef t value_type;
+
+        arenaAllocator(arena &_Arena) : Arena(&_Arena) {}
+
+        template <class u>
+        arenaAllocator(const arenaAllocator<u> &Other) : Arena(Other.Arena) {}
+
+        inline t *allocate(size_t Count)
+        {   return Arena->allocate<t>(Count);
+        }
+
+        inline void deallocate(t *, size_t) {}
+
+        template <class u>
+        inline bool operator == (const arenaAllocator<u> &Other) const
+        {   return Arena == Other.Arena;
+        }
+
+        template <class u>
+        inline bool operator != (const arenaAllocator<u> &Other) const
+        {   return Arena != Other.Arena;
+        }
+    };
 }
 
 TMVB
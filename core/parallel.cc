@@ -0,0 +1,109 @@
+#include "parallel.h"
+
+BVMT
+
+#ifndef NDEBUG
+void test__core__parallel()
+{   TEST
+    (   "parallelFor works",
+        TEST
+        (   "over an arrayView",
+            array<int> Array(iterator<int>::range(10000));
+            parallelFor(Array.view(), [](int &Int) { Int *= 2; });
+            for (index I = 0; I < Array.count(); ++I)
+            {   EXPECT_EQUAL(Array[I], 2 * I);
+            }
+        );
+
+        TEST
+        (   "over an iteratorRange",
+            array<int> Array = array<int>::fixedCount(777);
+            parallelFor
+            (   iteratorRange<index>({.Start = 7, .EndBefore = 777}),
+                [&Array](index I) { Array[I] = I + 1; },
+                parallelOptions({.ChunkSize = 10})
+            );
+            for (index I = 0; I < Array.count(); ++I)
+            {   EXPECT_EQUAL(Array[I], I < 7 ? 0 : I + 1);
+            }
+        );
+
+        TEST
+        (   "errors are rethrown",
+            array<int> Array(iterator<int>::range(100));
+            EXPECT_THROW
+            (   parallelFor
+                (   Array.view(),
+                    [](int &Int) { if (Int == 50) throw error("fifty", AT); },
+                    parallelOptions({.ChunkSize = 1})
+                ),
+                "fifty"
+            );
+        );
+    );
+
+    TEST
+    (   "parallelReduce works",
+        TEST
+        (   "for sums",
+            array<i64> Array(iterator<i64>::range(100000));
+            i64 Sum = parallelReduce
+            (   Array.view(), (i64)0,
+                [](i64 &Value) { return Value; },
+                [](i64 A, i64 B) { return A + B; }
+            );
+            EXPECT_EQUAL(Sum, (i64)4999950000);
+
+            i64 RangeSum = parallelReduce
+            (   iteratorRange<i64>({.Start = 1, .EndBefore = 101}), (i64)1000,
+                [](i64 Value) { return Value; },
+                [](i64 A, i64 B) { return A + B; },
+                parallelOptions({.ChunkSize = 7})
+            );
+            EXPECT_EQUAL(RangeSum, (i64)6050);
+        );
+
+        TEST
+        (   "deterministically reduces in chunk order",
+            auto mapIndex = [](index I) { return 1.0 / dbl(I + 1); };
+            auto sum = [](dbl A, dbl B) { return A + B; };
+            const index Count = 10000;
+            const index ChunkSize = 100;
+            // What we'd expect if we reduced each chunk on one thread, in order:
+            dbl Expected = 0.0;
+            for (index Start = 0; Start < Count; Start += ChunkSize)
+            {   dbl Partial = mapIndex(Start);
+                for (index I = Start + 1; I < Start + ChunkSize; ++I)
+                {   Partial += mapIndex(I);
+                }
+                Expected += Partial;
+            }
+            for (int Run = 0; Run < 10; ++Run)
+            {   dbl Result = parallelReduce
+                (   iteratorRange<index>({.EndBefore = Count}), 0.0, mapIndex, sum,
+                    parallelOptions({.ChunkSize = ChunkSize, .Deterministic = True})
+                );
+                // Exact comparison on purpose:
+                EXPECT_EQUAL(Result == Expected, True);
+            }
+        );
+
+        TEST
+        (   "results can be containers, kept in order when deterministic",
+            array<int> Array(iterator<int>::range(50));
+            array<int> Evens = parallelReduce
+            (   Array.view(), array<int>(),
+                [](int &Int) { return Int % 2 ? array<int>() : array<int>({Int}); },
+                [](array<int> A, array<int> B) { A += B; return A; },
+                parallelOptions({.ChunkSize = 4, .Deterministic = True})
+            );
+            EXPECT_EQUAL(Evens.count(), 25);
+            for (index I = 0; I < Evens.count(); ++I)
+            {   EXPECT_EQUAL(Evens[I], 2 * I);
+            }
+        );
+    );
+}
+#endif
+
+TMVB
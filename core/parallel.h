@@ -0,0 +1,168 @@
+#pragma once
+
+#include "array.h"
+#include "iterator.h"
+#include "job.h"
+
+#include <algorithm> // std::max, std::min
+#include <mutex>
+#include <type_traits>
+
+BVMT
+
+struct parallelOptions
+{   // How many values each job handles.  If 0, this is picked based on the number of
+    // threads in `jobs`, unless `Deterministic` is set (see below).
+    index ChunkSize = 0;
+    // If True, `parallelReduce` combines the results of each chunk in order, and the
+    // default `ChunkSize` doesn't depend on the number of threads, so that results
+    // (e.g., floating-point sums of game state) are the same on every run and every machine.
+    // Otherwise, chunk results are combined in whatever order the chunks finish.
+    bool Deterministic = False;
+};
+
+namespace detail
+{   // Default chunk size for deterministic reductions, which can't depend on the thread count.
+    constexpr index DeterministicChunkSize = 1024;
+
+    inline index parallelChunkSize(index Count, const parallelOptions &Options)
+    {   if (Options.ChunkSize > 0)
+        {   return Options.ChunkSize;
+        }
+        if (Options.Deterministic)
+        {   return DeterministicChunkSize;
+        }
+        // A few chunks per thread, so that threads which finish early can steal the rest.
+        const index Chunks = 4 * jobs::get()->threadCount();
+        return std::max((Count + Chunks - 1) / Chunks, (index)1);
+    }
+
+    // Calls `runChunk(Chunk, Start, EndBefore)` for each chunk of [0, Count) as jobs,
+    // and waits for all of them to finish.
+    template <class chunkRunner>
+    void parallelChunks(index Count, index ChunkSize, chunkRunner &runChunk)
+    {   ASSERT(ChunkSize > 0);
+        const index ChunkCount = (Count + ChunkSize - 1) / ChunkSize;
+        if (ChunkCount <= 1)
+        {   if (Count > 0)
+            {   runChunk(0, 0, Count);
+            }
+            return;
+        }
+        jobs *Jobs = jobs::get();
+        jobCounter Counter;
+        for (index Chunk = 0; Chunk < ChunkCount; ++Chunk)
+        {   const index Start = Chunk * ChunkSize;
+            const index EndBefore = std::min(Start + ChunkSize, Count);
+            Jobs->run
+            (   [&runChunk, Chunk, Start, EndBefore]()
+                {   runChunk(Chunk, Start, EndBefore);
+                },
+                &Counter
+            );
+        }
+        Jobs->wait(Counter);
+    }
+
+    // Reduces `mapIndexToU(I)` for I in [0, Count) using `combine`, in parallel.
+    template <class u, class indexMapper, class reducer>
+    u parallelReduce
+    (   index Count,
+        u Initial,
+        indexMapper &mapIndexToU,
+        reducer &combine,
+        const parallelOptions &Options
+    )
+    {   const index ChunkSize = parallelChunkSize(Count, Options);
+        auto reduceChunk = [&mapIndexToU, &combine](index Start, index EndBefore)
+        {   u Partial = mapIndexToU(Start);
+            for (index I = Start + 1; I < EndBefore; ++I)
+            {   Partial = combine(std::move(Partial), mapIndexToU(I));
+            }
+            return Partial;
+        };
+        if (Options.Deterministic)
+        {   array<optional<u>> Partials;
+            Partials.count((Count + ChunkSize - 1) / ChunkSize);
+            auto runChunk = [&reduceChunk, &Partials](index Chunk, index Start, index EndBefore)
+            {   Partials[Chunk] = reduceChunk(Start, EndBefore);
+            };
+            parallelChunks(Count, ChunkSize, runChunk);
+            for (index Chunk = 0; Chunk < Partials.count(); ++Chunk)
+            {   Initial = combine(std::move(Initial), std::move(*Partials[Chunk]));
+            }
+            return Initial;
+        }
+        std::mutex InitialMutex;
+        auto runChunk = [&](index /*Chunk*/, index Start, index EndBefore)
+        {   u Partial = reduceChunk(Start, EndBefore);
+            std::lock_guard<std::mutex> Lock(InitialMutex);
+            Initial = combine(std::move(Initial), std::move(Partial));
+        };
+        parallelChunks(Count, ChunkSize, runChunk);
+        return Initial;
+    }
+}
+
+// Calls `each(T)` for every element `T` of `View`, split into chunks which run on `jobs`.
+// Calls for different elements can happen at the same time, so `each` must be thread-safe.
+template <class t, class perElement>
+void parallelFor(arrayView<t> View, perElement each, parallelOptions Options = {})
+{   auto runChunk = [&View, &each](index, index Start, index EndBefore)
+    {   for (index I = Start; I < EndBefore; ++I)
+        {   each(View[I]);
+        }
+    };
+    detail::parallelChunks(View.count(), detail::parallelChunkSize(View.count(), Options), runChunk);
+}
+
+// Calls `each(I)` for every `I` in `Range`, split into chunks which run on `jobs`.
+template <class t, class perIndex>
+void parallelFor(iteratorRange<t> Range, perIndex each, parallelOptions Options = {})
+{   static_assert(std::is_integral_v<t>, "parallelFor only supports integer ranges");
+    const index Count = std::max((index)(Range.EndBefore - Range.Start), (index)0);
+    auto runChunk = [&Range, &each](index, index Start, index EndBefore)
+    {   for (index I = Start; I < EndBefore; ++I)
+        {   each(t(Range.Start + I));
+        }
+    };
+    detail::parallelChunks(Count, detail::parallelChunkSize(Count, Options), runChunk);
+}
+
+// Maps each element of `View` via `mapTToU(T)` and combines the results into `Initial`
+// via `combine(u Left, u Right)`, which should be associative.  Unless `Options.Deterministic`
+// is set, chunk results are combined in whatever order the chunks finish, so `combine` must
+// also be commutative; e.g., appending arrays needs `Deterministic` to keep their order.
+// E.g., `parallelReduce(Array.view(), 0, [](int &I) { return I; }, std::plus<int>())`.
+template <class u, class t, class mapper, class reducer>
+u parallelReduce
+(   arrayView<t> View,
+    u Initial,
+    mapper mapTToU,
+    reducer combine,
+    parallelOptions Options = {}
+)
+{   auto mapIndexToU = [&View, &mapTToU](index I) -> u
+    {   return mapTToU(View[I]);
+    };
+    return detail::parallelReduce(View.count(), std::move(Initial), mapIndexToU, combine, Options);
+}
+
+// Like `parallelReduce` on an `arrayView`, but `mapTToU` is called with each value in `Range`.
+template <class u, class t, class mapper, class reducer>
+u parallelReduce
+(   iteratorRange<t> Range,
+    u Initial,
+    mapper mapTToU,
+    reducer combine,
+    parallelOptions Options = {}
+)
+{   static_assert(std::is_integral_v<t>, "parallelReduce only supports integer ranges");
+    const index Count = std::max((index)(Range.EndBefore - Range.Start), (index)0);
+    auto mapIndexToU = [&Range, &mapTToU](index I) -> u
+    {   return mapTToU(t(Range.Start + I));
+    };
+    return detail::parallelReduce(Count, std::move(Initial), mapIndexToU, combine, Options);
+}
+
+TMVB
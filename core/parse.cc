@@ -0,0 +1,302 @@
+#include "parse.h"
+
+#include <charconv>     // std::from_chars
+#include <limits>
+
+#ifndef NDEBUG
+#include "error.h"
+#include "format.h"
+
+#include <cstring>      // strlen
+#endif
+
+BVMT
+
+namespace parse
+{   namespace
+    {   // Real numbers with underscores are copied without them into a buffer this big.
+        constexpr index MaxRealBytes = 256;
+
+        // Returns the value of a (hexadecimal or lower) digit, or 99 for anything else.
+        inline int digitValue(char Byte)
+        {   if (Byte >= '0' && Byte <= '9')
+            {   return Byte - '0';
+            }
+            const char Lower = Byte | 0x20;
+            if (Lower >= 'a' && Lower <= 'f')
+            {   return Lower - 'a' + 10;
+            }
+            return 99;
+        }
+
+        // Reads an optional sign and base prefix, returning the byte of the first digit;
+        // a prefix only counts if a digit follows it, e.g., "0x" alone is just the 0.
+        index signAndBase(const char *Chars, index Count, bool AllowBinary, bool &Negative, int &Base)
+        {   index Byte = 0;
+            Negative = False;
+            if (Count > 0 && (Chars[0] == '-' || Chars[0] == '+'))
+            {   Negative = Chars[0] == '-';
+                Byte = 1;
+            }
+            Base = 10;
+            if (Byte + 2 < Count && Chars[Byte] == '0')
+            {   const char Prefix = Chars[Byte + 1] | 0x20;
+                const int PrefixBase = Prefix == 'x' ? 16 : Prefix == 'b' && AllowBinary ? 2 : 0;
+                if (PrefixBase > 0 && digitValue(Chars[Byte + 2]) < PrefixBase)
+                {   Base = PrefixBase;
+                    Byte += 2;
+                }
+            }
+            return Byte;
+        }
+
+        // Returns the end of the digits starting at `Byte`, including any underscores between them.
+        index scanDigits(const char *Chars, index Byte, index Count, int Base, bool &Underscores)
+        {   while (Byte < Count)
+            {   if (digitValue(Chars[Byte]) < Base)
+                {   ++Byte;
+                }
+                else if (Chars[Byte] == '_' && Byte + 1 < Count && digitValue(Chars[Byte + 1]) < Base)
+                {   Underscores = True;
+                    ++Byte;
+                }
+                else
+                {   break;
+                }
+            }
+            return Byte;
+        }
+
+        template <class t>
+        index realLike(const char *Chars, index Count, t &Value)
+        {   bool Negative;
+            int Base;
+            const index Start = signAndBase(Chars, Count, False, Negative, Base);
+            if (Start >= Count || digitValue(Chars[Start]) >= Base)
+            {   return 0;
+            }
+            bool Underscores = False;
+            index End = scanDigits(Chars, Start, Count, Base, Underscores);
+            if (End < Count && Chars[End] == '.')
+            {   ++End;
+                End = scanDigits(Chars, End, Count, Base, Underscores);
+            }
+            // An exponent only counts if it has digits, e.g., "3em" is 3 followed by "em".
+            if (End < Count && (Chars[End] | 0x20) == (Base == 16 ? 'p' : 'e'))
+            {   index Digits = End + 1;
+                if (Digits < Count && (Chars[Digits] == '-' || Chars[Digits] == '+'))
+                {   ++Digits;
+                }
+                if (Digits < Count && Chars[Digits] >= '0' && Chars[Digits] <= '9')
+                {   End = Digits;
+                    while (End < Count && Chars[End] >= '0' && Chars[End] <= '9')
+                    {   ++End;
+                    }
+                }
+            }
+            const char *First = Chars + Start;
+            const char *Last = Chars + End;
+            char Copy[MaxRealBytes];
+            if (Underscores)
+            {   index Copied = 0;
+                for (const char *Char = First; Char < Last; ++Char)
+                {   if (*Char == '_')
+                    {   continue;
+                    }
+                    if (Copied == MaxRealBytes)
+                    {   return 0;
+                    }
+                    Copy[Copied++] = *Char;
+                }
+                First = Copy;
+                Last = Copy + Copied;
+            }
+            t Result;
+            // The sign is handled here since from_chars doesn't take a + (or a - before hex digits),
+            // which is fine since rounding is symmetric.
+            const std::from_chars_result Parsed = std::from_chars
+            (   First, Last, Result, Base == 16 ? std::chars_format::hex : std::chars_format::general
+            );
+            if (Parsed.ec != std::errc())
+            {   return 0;
+            }
+            Value = Negative ? -Result : Result;
+            return End;
+        }
+    }
+
+    index integerMagnitude(const char *Chars, index Count, u64 &Magnitude, bool &Negative)
+    {   int Base;
+        const index Start = signAndBase(Chars, Count, True, Negative, Base);
+        if (Start >= Count || digitValue(Chars[Start]) >= Base)
+        {   return 0;
+        }
+        u64 Result = 0;
+        index Byte = Start;
+        if (Base == 10)
+        {   // The common case; std::from_chars stops at any underscores, which go the slow way.
+            const std::from_chars_result Parsed = std::from_chars(Chars + Start, Chars + Count, Result);
+            if (Parsed.ec != std::errc())
+            {   return 0;
+            }
+            Byte = Parsed.ptr - Chars;
+            if (Byte + 1 >= Count || Chars[Byte] != '_' || digitValue(Chars[Byte + 1]) >= 10)
+            {   Magnitude = Result;
+                return Byte;
+            }
+        }
+        // Past this, another digit overflows (or past `LastDigit` for the last one).
+        const u64 Limit = std::numeric_limits<u64>::max() / Base;
+        const int LastDigit = std::numeric_limits<u64>::max() % Base;
+        for (; Byte < Count; ++Byte)
+        {   const int Digit = digitValue(Chars[Byte]);
+            if (Digit >= Base)
+            {   if (Chars[Byte] == '_' && Byte + 1 < Count && digitValue(Chars[Byte + 1]) < Base)
+                {   continue;
+                }
+                break;
+            }
+            if (Result >= Limit && (Result > Limit || Digit > LastDigit))
+            {   return 0;
+            }
+            Result = Result * Base + Digit;
+        }
+        Magnitude = Result;
+        return Byte;
+    }
+
+    index realChars(const char *Chars, index Count, float &Value)
+    {   return realLike(Chars, Count, Value);
+    }
+
+    index realChars(const char *Chars, index Count, double &Value)
+    {   return realLike(Chars, Count, Value);
+    }
+
+    index realChars(const char *Chars, index Count, long double &Value)
+    {   return realLike(Chars, Count, Value);
+    }
+}
+
+#ifndef NDEBUG
+void test__core__parse()
+{   // Parses all of `Chars`, returning how many bytes were taken.
+    auto parsed = [](const char *Chars, auto &Value) -> index
+    {   return parse::number(Chars, strlen(Chars), Value);
+    };
+
+    TEST
+    (   "parse::integer reads integers of every width",
+        i64 Big = 0;
+        EXPECT_EQUAL(parsed("-9223372036854775808", Big), 20);
+        EXPECT_EQUAL(Big, std::numeric_limits<i64>::min());
+        u64 Unsigned = 0;
+        EXPECT_EQUAL(parsed("18446744073709551615", Unsigned), 20);
+        EXPECT_EQUAL(Unsigned, std::numeric_limits<u64>::max());
+        i8 Small = 5;
+        EXPECT_EQUAL(parsed("-128", Small), 4);
+        EXPECT_EQUAL(Small, -128);
+        u16 Medium = 7;
+        EXPECT_EQUAL(parsed("65535 tiles", Medium), 5);
+        EXPECT_EQUAL(Medium, 65535);
+    );
+
+    TEST
+    (   "parse::integer doesn't read integers which don't fit",
+        i8 Small = 5;
+        EXPECT_EQUAL(parsed("128", Small), 0);
+        EXPECT_EQUAL(parsed("-129", Small), 0);
+        EXPECT_EQUAL(Small, 5);
+        u16 Unsigned = 7;
+        EXPECT_EQUAL(parsed("-1", Unsigned), 0);
+        EXPECT_EQUAL(parsed("-0", Unsigned), 2);
+        EXPECT_EQUAL(Unsigned, 0);
+        u64 Big = 3;
+        EXPECT_EQUAL(parsed("18446744073709551616", Big), 0);
+        EXPECT_EQUAL(Big, (u64)3);
+    );
+
+    TEST
+    (   "parse::integer reads hex, binary, and underscores",
+        int Number = 0;
+        EXPECT_EQUAL(parsed("0xff", Number), 4);
+        EXPECT_EQUAL(Number, 255);
+        EXPECT_EQUAL(parsed("-0X1F,", Number), 5);
+        EXPECT_EQUAL(Number, -31);
+        EXPECT_EQUAL(parsed("0b110", Number), 5);
+        EXPECT_EQUAL(Number, 6);
+        EXPECT_EQUAL(parsed("1_000_000", Number), 9);
+        EXPECT_EQUAL(Number, 1000000);
+        EXPECT_EQUAL(parsed("0xdead_beef", Number), 0);
+        EXPECT_EQUAL(parsed("0x7ead_beef", Number), 11);
+        EXPECT_EQUAL(Number, 0x7eadbeef);
+        // Prefixes and underscores only count with digits after them:
+        EXPECT_EQUAL(parsed("0x", Number), 1);
+        EXPECT_EQUAL(Number, 0);
+        EXPECT_EQUAL(parsed("0b2", Number), 1);
+        EXPECT_EQUAL(parsed("12_", Number), 2);
+        EXPECT_EQUAL(Number, 12);
+        EXPECT_EQUAL(parsed("3__4", Number), 1);
+        EXPECT_EQUAL(parsed("_3", Number), 0);
+        EXPECT_EQUAL(parsed("-", Number), 0);
+    );
+
+    TEST
+    (   "parse::real reads correctly rounded floats",
+        double Double = 0;
+        EXPECT_EQUAL(parsed("0.1", Double), 3);
+        EXPECT_EQUAL(Double == 0.1, True);
+        EXPECT_EQUAL(parsed("-12.5e3x", Double), 7);
+        EXPECT_EQUAL(Double, -12500.0);
+        EXPECT_EQUAL(parsed("2.2250738585072014e-308", Double), 23);
+        EXPECT_EQUAL(Double == std::numeric_limits<dbl>::min(), True);
+        EXPECT_EQUAL(parsed("1_000.000_5", Double), 11);
+        EXPECT_EQUAL(Double == 1000.0005, True);
+        float Float = 0;
+        EXPECT_EQUAL(parsed("16777217", Float), 8);
+        EXPECT_EQUAL(Float == 16777216.0f, True);
+        EXPECT_EQUAL(parsed("0x1.8p3", Float), 7);
+        EXPECT_EQUAL(Float, 12.0f);
+        EXPECT_EQUAL(parsed("+128.", Float), 5);
+        EXPECT_EQUAL(Float, 128.0f);
+        EXPECT_EQUAL(parsed("3em", Float), 1);
+        EXPECT_EQUAL(Float, 3.0f);
+        EXPECT_EQUAL(parsed(".5", Float), 0);
+        EXPECT_EQUAL(parsed("1e999", Float), 0);
+        EXPECT_EQUAL(Float, 3.0f);
+    );
+
+    TEST
+    (   "parse::real round-trips what format::write writes",
+        auto roundTrips = [](dbl Value) -> bool
+        {   char Buffer[format::MaxBytes];
+            const index Count = format::write(Buffer, format::MaxBytes, Value);
+            dbl Parsed = 0;
+            return parse::real(Buffer, Count, Parsed) == Count && Parsed == Value;
+        };
+        for (dbl Value = 1e-7; Value < 1e9; Value *= 3.3)
+        {   EXPECT_EQUAL(roundTrips(Value), True);
+            EXPECT_EQUAL(roundTrips(-Value / 7), True);
+        }
+    );
+
+    TEST
+    (   "parse::list reads exactly the expected count of numbers",
+        int Tiles[4];
+        const char *Row = " 3, 4 ,4,\t0x7\n";
+        EXPECT_EQUAL(parse::list(Row, strlen(Row), ',', Tiles, 4), True);
+        EXPECT_EQUAL(Tiles[0], 3);
+        EXPECT_EQUAL(Tiles[3], 7);
+        EXPECT_EQUAL(parse::list(Row, strlen(Row), ',', Tiles, 3), False);
+        EXPECT_EQUAL(parse::list("1,2,,4", 6, ',', Tiles, 4), False);
+        EXPECT_EQUAL(parse::list("1,2,3", 5, ',', Tiles, 4), False);
+        float Coordinates[3];
+        EXPECT_EQUAL(parse::list("0.5  -1 2e1", 11, ' ', Coordinates, 3), True);
+        EXPECT_EQUAL(Coordinates[1], -1.0f);
+        EXPECT_EQUAL(Coordinates[2], 20.0f);
+        EXPECT_EQUAL(parse::list("  ", 2, ',', Tiles, 0), True);
+    );
+}
+#endif
+
+TMVB
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "types.h"
+
+#include <limits>
+#include <type_traits>
+
+BVMT
+
+// Number parsing which reads straight from bytes (e.g., a `stringView` of a level or logic
+// file), i.e., without streams, locales, or allocations; the counterpart of `format`.
+// Each parser reads a number from the start of `Chars` and returns how many bytes it took,
+// or 0 (leaving `Value` alone) if the bytes don't start with a number which fits into `Value`.
+// See also `stringView::shiftInteger`, `shiftReal`, and `numbers`, which use it.
+namespace parse
+{   // Parses the magnitude and sign of an integer: an optional + or -, then decimal digits,
+    // or binary digits after `0b`, or hexadecimal digits after `0x`.  Underscores can separate
+    // digits, e.g., "1_000_000".  Returns 0 if the magnitude doesn't fit into 64 bits.
+    index integerMagnitude(const char *Chars, index Count, u64 &Magnitude, bool &Negative);
+
+    // Parses a real number, correctly rounded (via std::from_chars): an optional + or -,
+    // then decimal digits, an optional period and more digits, and an optional exponent,
+    // e.g., "-12.5e3"; or a hexadecimal float after `0x`, e.g., "0x1.8p3".  Underscores can
+    // separate digits, and a trailing period is taken, e.g., "128.", but not a leading one.
+    index realChars(const char *Chars, index Count, float &Value);
+    index realChars(const char *Chars, index Count, double &Value);
+    index realChars(const char *Chars, index Count, long double &Value);
+
+    // Returns the byte after any spaces, tabs, or newlines (other than `Except`) at `Byte`.
+    inline index skipWhitespace(const char *Chars, index Byte, index Count, char Except = 0)
+    {   while (Byte < Count)
+        {   const char Char = Chars[Byte];
+            if (Char == Except || (Char != ' ' && Char != '\t' && Char != '\n' && Char != '\r'))
+            {   break;
+            }
+            ++Byte;
+        }
+        return Byte;
+    }
+
+    template <class t>
+    index integer(const char *Chars, index Count, t &Value)
+    {   u64 Magnitude;
+        bool Negative;
+        const index Bytes = integerMagnitude(Chars, Count, Magnitude, Negative);
+        if (Bytes == 0)
+        {   return 0;
+        }
+        if constexpr (std::is_integral_v<t>)
+        {   using limits = std::numeric_limits<t>;
+            if (Negative)
+            {   if (Magnitude > u64(0) - (u64)limits::min())
+                {   return 0;
+                }
+                // Negating as unsigned also works for the most negative value.
+                Value = Magnitude == 0 ? t(0) : (t)(u64(0) - Magnitude);
+            }
+            else
+            {   if (Magnitude > (u64)limits::max())
+                {   return 0;
+                }
+                Value = (t)Magnitude;
+            }
+        }
+        else
+        {   Value = Negative ? -(t)Magnitude : (t)Magnitude;
+        }
+        return Bytes;
+    }
+
+    template <class t>
+    index real(const char *Chars, index Count, t &Value)
+    {   if constexpr (std::is_same_v<t, float> || std::is_same_v<t, double> || std::is_same_v<t, long double>)
+        {   return realChars(Chars, Count, Value);
+        }
+        else
+        {   double Double;
+            const index Bytes = realChars(Chars, Count, Double);
+            if (Bytes > 0)
+            {   Value = (t)Double;
+            }
+            return Bytes;
+        }
+    }
+
+    // Parses an integer into integer types and a real into floating-point types.
+    template <class t>
+    index number(const char *Chars, index Count, t &Value)
+    {   if constexpr (std::is_floating_point_v<t>)
+        {   return real(Chars, Count, Value);
+        }
+        else
+        {   return integer(Chars, Count, Value);
+        }
+    }
+
+    // Parses exactly `ValueCount` numbers separated by `Delimiter`, e.g., a row of tile ids
+    // like "3, 4, 4, 7", allowing whitespace around each number.  Returns False if `Chars`
+    // is anything else, in which case some of `Values` may have been written.
+    template <class t>
+    bool list(const char *Chars, index Count, char Delimiter, t *Values, index ValueCount)
+    {   index Byte = 0;
+        for (index I = 0; I < ValueCount; ++I)
+        {   if (I > 0)
+            {   Byte = skipWhitespace(Chars, Byte, Count, Delimiter);
+                if (Byte >= Count || Chars[Byte] != Delimiter)
+                {   return False;
+                }
+                ++Byte;
+            }
+            Byte = skipWhitespace(Chars, Byte, Count);
+            const index Bytes = number(Chars + Byte, Count - Byte, Values[I]);
+            if (Bytes == 0)
+            {   return False;
+            }
+            Byte += Bytes;
+        }
+        return skipWhitespace(Chars, Byte, Count) == Count;
+    }
+}
+
+TMVB
@@ -0,0 +1,277 @@
+#include "rune-index.h"
+
+#include <algorithm>    // std::max, std::min, std::upper_bound
+
+#ifndef NDEBUG
+#include "error.h"
+#include "parallel.h"
+#endif
+
+BVMT
+
+runeIndex::runeIndex(const string &String)
+:   Source(&String),
+    StartByte(0),
+    EndByte(-1),
+    Version(String.Version)
+{}
+
+runeIndex::runeIndex(const stringView &View)
+:   Source(View.Source),
+    StartByte(View.StartByte),
+    EndByte(View.EndByte),
+    Version(View.Source->Version)
+{}
+
+void runeIndex::check()
+{   if (Version != Source->Version)
+    {   Checkpoints.clear();
+        Version = Source->Version;
+    }
+}
+
+index runeIndex::endByte() const
+{   const index Bytes = Source->countBytes();
+    return std::max(EndByte < 0 ? Bytes : std::min(EndByte, Bytes), StartByte);
+}
+
+void runeIndex::indexUpTo(index Rune)
+{   check();
+    if (Checkpoints.empty())
+    {   Checkpoints.append(StartByte);
+    }
+    const index Count = Rune / Stride + 1;
+    while (Checkpoints.count() < Count)
+    {   stringView View(*Source, Checkpoints[-1], endByte());
+        index Shifted = 0;
+        while (Shifted < Stride && !View.empty())
+        {   View.shift();
+            ++Shifted;
+        }
+        if (Shifted < Stride)
+        {   // Hit the end of the string.
+            return;
+        }
+        Checkpoints.append(View.StartByte);
+    }
+}
+
+index runeIndex::byteOfRune(index Rune)
+{   if (Rune <= 0)
+    {   return 0;
+    }
+    indexUpTo(Rune);
+    const index Checkpoint = std::min(Rune / Stride, Checkpoints.count() - 1);
+    const index End = endByte();
+    stringView View(*Source, Checkpoints[Checkpoint], End);
+    for (index I = Checkpoint * Stride; I < Rune && !View.empty(); ++I)
+    {   View.shift();
+    }
+    return std::min(View.StartByte, End) - StartByte;
+}
+
+index runeIndex::runeOfByte(index Byte)
+{   indexUpTo(0);
+    const index End = endByte();
+    Byte = std::max(std::min(StartByte + Byte, End), StartByte);
+    // Add checkpoints until they cover `Byte`:
+    while (Checkpoints[-1] < Byte)
+    {   const index Count = Checkpoints.count();
+        indexUpTo(Count * Stride);
+        if (Checkpoints.count() == Count)
+        {   break;
+        }
+    }
+    // The last checkpoint at or before `Byte`:
+    const index *First = &Checkpoints[0];
+    const index Checkpoint = std::upper_bound(First, First + Checkpoints.count(), Byte) - First - 1;
+    stringView View(*Source, First[Checkpoint], End);
+    index Rune = Checkpoint * Stride;
+    while (!View.empty())
+    {   View.shift();
+        if (View.StartByte > Byte)
+        {   break;
+        }
+        ++Rune;
+    }
+    return Rune;
+}
+
+rune runeIndex::runeAt(index Rune)
+{   if (Rune < 0)
+    {   Rune += stringView(*Source, StartByte, endByte()).count();
+    }
+    if (Rune < 0)
+    {   return 0;
+    }
+    stringView View(*Source, StartByte + byteOfRune(Rune), endByte());
+    return View.shift();
+}
+
+stringView runeIndex::slice(index StartRune, index EndRune)
+{   const index SliceStart = StartByte + byteOfRune(StartRune);
+    return stringView(*Source, SliceStart, std::max(StartByte + byteOfRune(EndRune), SliceStart));
+}
+
+void runeIndex::changed(index FromByte)
+{   // A checkpoint at `FromByte` is still right, since a rune still starts there.
+    while (!Checkpoints.empty() && Checkpoints[-1] > StartByte + FromByte)
+    {   Checkpoints.pop();
+    }
+    Version = Source->Version;
+}
+
+#ifndef NDEBUG
+void test__core__rune_index()
+{   TEST
+    (   "runeIndex lookups match the string's",
+        string Text;
+        for (int I = 0; I < 100; ++I)
+        {   Text += "ab水🍌";
+        }
+        runeIndex Index(Text);
+        // Each "ab水🍌" is 2 + 3 + 4 bytes:
+        EXPECT_EQUAL(Index.byteOfRune(4 * 70 + 2), 9 * 70 + 2);
+        EXPECT_EQUAL(Index.byteOfRune(1000), Text.countBytes());
+        EXPECT_EQUAL(Index.runeOfByte(9 * 70 + 3), 4 * 70 + 2);
+        EXPECT_EQUAL(Index.runeOfByte(Text.countBytes()), 400);
+        EXPECT_EQUAL(Index.runeAt(-4), 'a');
+        EXPECT_EQUAL(Index.runeAt(-401), 0);
+        EXPECT_EQUAL(Index.slice(398, 1000), "水🍌");
+        EXPECT_EQUAL(Index.slice(5, 3), "");
+        for (index Rune = 0; Rune < 410; Rune += 7)
+        {   EXPECT_EQUAL(Index.byteOfRune(Rune), Text.byteOfRune(Rune));
+            EXPECT_EQUAL(Index.runeAt(Rune), Text.runeAt(Rune));
+        }
+        for (index Byte = 0; Byte < Text.countBytes(); Byte += 5)
+        {   EXPECT_EQUAL(Index.runeOfByte(Byte), Text.runeOfByte(Byte));
+        }
+    );
+
+    TEST
+    (   "runeIndex notices when its string changes",
+        string Text;
+        for (int I = 0; I < 100; ++I)
+        {   Text += "ab水🍌";
+        }
+        runeIndex Index(Text);
+        EXPECT_EQUAL(Index.runeAt(399), 0x1F34C);
+        EXPECT_EQUAL(Index.byteOfRune(300), 9 * 75);
+        Text.pop();
+        Text.pop();
+        Text += "xyz";
+        EXPECT_EQUAL(Index.runeAt(398), 'x');
+        EXPECT_EQUAL(Index.slice(396, 401), "abxyz");
+        EXPECT_EQUAL(Index.byteOfRune(401), Text.countBytes());
+
+        Text = string("ß") * 200;
+        EXPECT_EQUAL(Index.byteOfRune(300), Text.countBytes());
+        EXPECT_EQUAL(Index.runeOfByte(2 * 150), 150);
+        string Other = "水";
+        Text = std::move(Other);
+        EXPECT_EQUAL(Index.runeAt(0), 0x6C34);
+        EXPECT_EQUAL(Index.byteOfRune(1), 3);
+    );
+
+    TEST
+    (   "runeIndex keeps its checkpoints before a change it's told about",
+        string Text;
+        for (int I = 0; I < 100; ++I)
+        {   Text += "ab水🍌";
+        }
+        runeIndex Index(Text);
+        EXPECT_EQUAL(Index.byteOfRune(399), 9 * 99 + 5);
+        // Runes 0, 64, ..., 384:
+        EXPECT_EQUAL(Index.checkpointCount(), 7);
+        const index AppendedByte = Text.countBytes();
+        Text += "xyz";
+        Index.changed(AppendedByte);
+        EXPECT_EQUAL(Index.checkpointCount(), 7);
+        Text.pop();
+        // Pretend more changed, to drop the checkpoints after byte 450,
+        // i.e., keep those at runes 0, 64, 128, and 192 (byte 432):
+        Index.changed(9 * 50);
+        EXPECT_EQUAL(Index.checkpointCount(), 4);
+        EXPECT_EQUAL(Index.slice(399, 402), "🍌xy");
+        EXPECT_EQUAL(Index.runeOfByte(Text.countBytes()), 402);
+        EXPECT_EQUAL(Index.checkpointCount(), 7);
+    );
+
+    TEST
+    (   "runeIndex indexes a stringView's runes",
+        string Text;
+        for (int I = 0; I < 100; ++I)
+        {   Text += "ab水🍌";
+        }
+        // Runes 2 up to 396, i.e., from the first 水 to before the last "ab",
+        // so each "水🍌ab" in the view is 3 + 4 + 2 bytes:
+        const stringView View = Text.slice(2, 396);
+        runeIndex Index(View);
+        EXPECT_EQUAL(Index.runeAt(0), 0x6C34);
+        EXPECT_EQUAL(Index.runeAt(-1), 0x1F34C);
+        EXPECT_EQUAL(Index.byteOfRune(4 * 70 + 1), 9 * 70 + 3);
+        EXPECT_EQUAL(Index.byteOfRune(1000), View.countBytes());
+        EXPECT_EQUAL(Index.runeOfByte(9 * 70 + 4), 4 * 70 + 1);
+        EXPECT_EQUAL(Index.runeOfByte(-5), 0);
+        EXPECT_EQUAL(Index.slice(392, 1000), "水🍌");
+        for (index Rune = 0; Rune < 400; Rune += 7)
+        {   EXPECT_EQUAL(Index.runeAt(Rune), View.runeAt(Rune));
+            EXPECT_EQUAL(Index.slice(Rune, Rune + 3), View.slice(Rune, Rune + 3));
+        }
+    );
+
+    TEST
+    (   "const strings can be sliced from many threads at once",
+        string Text;
+        for (int I = 0; I < 500; ++I)
+        {   Text += "Grüße, 旅人! ";
+        }
+        array<string> Slices;
+        Slices.count(64);
+        parallelFor
+        (   iteratorRange<index>({.Start = 0, .EndBefore = Slices.count()}),
+            [&Text, &Slices](index I)
+            {   runeIndex Index(Text);
+                Slices[I] = string(Text.slice(I * 11, I * 11 + 5)) + string(Index.slice(I * 11 + 5, I * 11 + 11));
+            },
+            {.ChunkSize = 1}
+        );
+        for (const string &Slice : Slices.values())
+        {   EXPECT_EQUAL(Slice, "Grüße, 旅人! ");
+        }
+    );
+
+    TEST_BENCHMARK
+    (   "caret movement through long text, walking from the start vs. a runeIndex",
+        string Text;
+        for (int I = 0; I < 2000; ++I)
+        {   Text += "Grüße, 旅人! ";
+        }
+        const index Runes = Text.count();
+        index WalkedBytes = 0;
+        dbl WalkSeconds = test::secondsToRun
+        (   [&]()
+            {   for (index Caret = 0; Caret < Runes; Caret += 97)
+                {   WalkedBytes += Text.byteOfRune(Caret);
+                }
+            }
+        );
+        index IndexedBytes = 0;
+        dbl IndexSeconds = test::secondsToRun
+        (   [&]()
+            {   runeIndex Index(Text);
+                for (index Caret = 0; Caret < Runes; Caret += 97)
+                {   IndexedBytes += Index.byteOfRune(Caret);
+                }
+            }
+        );
+        LOG
+        (   Runes / 97 + 1 << " caret positions in " << Runes << " runes: walking " << WalkSeconds
+                    << "s, rune index " << IndexSeconds << "s"
+        );
+        EXPECT_EQUAL(IndexedBytes, WalkedBytes);
+    );
+}
+#endif
+
+TMVB
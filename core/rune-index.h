@@ -0,0 +1,59 @@
+#pragma once
+
+#include "array.h"
+#include "string.h"
+#include "types.h"
+
+BVMT
+
+// A sparse index of the runes in a `string` or `stringView`, i.e., the byte of every
+// `Stride`th rune, so that rune-indexed lookups (e.g., moving a caret through a long line
+// in a text box) walk at most `Stride` runes from the nearest checkpoint instead of from
+// the start.  Checkpoints are built as lookups need them, and are dropped (to be rebuilt)
+// when the string changes.  Owned by whoever does the lookups, and not thread-safe, but
+// the string isn't changed, so other threads can keep reading it (e.g., with
+// `string::slice` or their own `runeIndex`).  The string must outlive this.
+class runeIndex
+{   const string *Source;
+    // The indexed bytes of `Source`; `EndByte` is -1 to follow the end of the whole string.
+    index StartByte;
+    index EndByte;
+    // `Source->Version` when the checkpoints were built.
+    index Version;
+    // The byte of rune `I * Stride` is `Checkpoints[I]`.
+    array<index> Checkpoints;
+public:
+    static constexpr index Stride = 64;
+
+    explicit runeIndex(const string &String);
+    // Indexes the runes of the view, whose bytes are counted from the start of the view.
+    explicit runeIndex(const stringView &View);
+
+    // Same as `string::byteOfRune`, `runeOfByte`, `runeAt`, and `slice`.
+    index byteOfRune(index Rune);
+    index runeOfByte(index Byte);
+    rune runeAt(index Rune);
+    stringView slice(index StartRune, index EndRune);
+
+    // Optional: call right after changing the string only at or after `FromByte`, which
+    // is counted from before the change (e.g., `Text.countBytes()` from before appending
+    // to `Text`), to keep the checkpoints before it instead of rebuilding them all.
+    // Calling this before the change doesn't keep anything.
+    void changed(index FromByte);
+
+private:
+    VISIBLE_FOR_TESTING
+    (   index checkpointCount() const
+        {   return Checkpoints.count();
+        }
+    )
+
+    // Drops the checkpoints if `Source` changed since they were built.
+    void check();
+    // The end of the indexed bytes in `Source`.
+    index endByte() const;
+    // Adds checkpoints up to rune `Rune` (or the end of the string).
+    void indexUpTo(index Rune);
+};
+
+TMVB
@@ -0,0 +1,90 @@
+#include "set.h"
+
+#ifndef NDEBUG
+#include "array.h"
+#include "string.h"
+#endif
+
+BVMT
+
+const char *const SetMissingValueErrorMsg = "set does not have that value";
+
+#ifndef NDEBUG
+void test__core__set()
+{   TEST
+    (   "set can insert, check, and erase",
+        set<string> Speakers;
+        EXPECT_EQUAL(Speakers.insert("narrator"), True);
+        EXPECT_EQUAL(Speakers.insert("bob"), True);
+        EXPECT_EQUAL(Speakers.insert("narrator"), False);
+        EXPECT_EQUAL(Speakers.count(), 2);
+        EXPECT_EQUAL(Speakers.contains("bob"), True);
+        EXPECT_EQUAL(Speakers.contains("alice"), False);
+
+        EXPECT_EQUAL(Speakers.erase("bob"), True);
+        EXPECT_EQUAL(Speakers.erase("bob"), False);
+        EXPECT_EQUAL(Speakers.pop("narrator"), "narrator");
+        EXPECT_THROW(Speakers.pop("narrator"), SetMissingValueErrorMsg);
+        EXPECT_EQUAL(Speakers.empty(), True);
+    );
+
+    TEST
+    (   "set bulk inserts from iterators, presized from their hints",
+        set<i32> Set(iterator<i32>::range(1000));
+        EXPECT_EQUAL(Set.count(), 1000);
+        const index Capacity = Set.capacity();
+        // Reserving exactly shouldn't need to grow:
+        set<i32> Reserved;
+        Reserved.reserve(1000);
+        EXPECT_EQUAL(Reserved.capacity(), Capacity);
+
+        // Duplicates are fine:
+        array<i32> Values({5, 5, 6, 1000, 1001});
+        Set += Values.values();
+        EXPECT_EQUAL(Set.count(), 1002);
+
+        Set = iterator<i32>::range(10);
+        EXPECT_EQUAL(Set, set<i32>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+
+        i32 Sum = 0;
+        for (const i32 &Value : Set.values())
+        {   Sum += Value;
+        }
+        EXPECT_EQUAL(Sum, 45);
+        EXPECT_EQUAL(array<i32>(Set.values()).count(), 10);
+    );
+
+    TEST
+    (   "set union, intersection, and difference",
+        set<i32> Evens(iterator<i32>::range(iteratorRange<i32>({.Start = 0, .EndBefore = 20})));
+        Evens -= set<i32>({1, 3, 5, 7, 9, 11, 13, 15, 17, 19});
+        set<i32> Small({2, 3, 4, 100});
+
+        EXPECT_EQUAL(Evens.count(), 10);
+        EXPECT_EQUAL(Evens & Small, set<i32>({2, 4}));
+        EXPECT_EQUAL(Small & Evens, set<i32>({2, 4}));
+        EXPECT_EQUAL(Small - Evens, set<i32>({3, 100}));
+        EXPECT_EQUAL((Evens - Small).count(), 8);
+        EXPECT_EQUAL((Evens | Small).count(), 12);
+        EXPECT_EQUAL(Small | Evens, Evens | Small);
+
+        set<i32> InPlace = Small;
+        InPlace &= Evens;
+        EXPECT_EQUAL(InPlace, set<i32>({2, 4}));
+        InPlace |= set<i32>({7});
+        EXPECT_EQUAL(InPlace, set<i32>({2, 4, 7}));
+        InPlace -= InPlace;
+        EXPECT_EQUAL(InPlace.empty(), True);
+
+        // Both ways of making one pass for `-=`:
+        set<i32> Big = Evens;
+        Big -= Small;
+        EXPECT_EQUAL(Big, Evens - Small);
+        set<i32> Little = Small;
+        Little -= Evens;
+        EXPECT_EQUAL(Little, set<i32>({3, 100}));
+    );
+}
+#endif
+
+TMVB
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "error.h"
+#include "hash-table.h"
+#include "iterator.h"
+#include "types.h"
+
+#include <initializer_list>
+
+BVMT
+
+extern const char *const SetMissingValueErrorMsg;
+
+namespace setDetail
+{   struct sameKey
+    {   template <class t>
+        static inline const t &of(const t &Value)
+        {   return Value;
+        }
+    };
+}
+
+// A hash set of `t`s, stored flat in a `hashTable` like `map`, e.g., for tags or flags
+// that only need a membership check.  Values need `std::hash<t>` and `operator ==`.
+// Iteration order is arbitrary and changes as the set grows.
+template <class t>
+class set
+{   using table = hashTable<t, t, setDetail::sameKey>;
+    table Table;
+
+public:
+    typedef staticIterator<const t &, hashTableDetail::iteratorKernel<const table *, const t &, hashTableDetail::pickEntry>>
+            valuesIterator;
+
+    typedef t value;
+
+    set() {}
+
+    set(std::initializer_list<t> Values)
+    {   reserve(Values.size());
+        for (const t &Value : Values)
+        {   insert(Value);
+        }
+    }
+
+    // Bulk inserts are presized from the iterator's `remainingCount()`, so that we rehash
+    // at most once more for iterators that don't know exactly how many values they have.
+    ITERATOR_CONSTRUCTOR_TEMPLATES
+    (   set, reserve(Iterator.remainingCount().AtLeast),
+        t, T,
+        insert(T)
+    )
+
+    ITERATOR_ASSIGNMENT_TEMPLATES
+    (   set, clear(); reserve(Iterator.remainingCount().AtLeast),
+        t, T,
+        insert(T)
+    )
+
+    ITERATOR_PLUS_EQUAL_TEMPLATES
+    (   set, reserve(count() + Iterator.remainingCount().AtLeast),
+        t, T,
+        insert(T)
+    )
+
+    inline index count() const
+    {   return Table.count();
+    }
+
+    inline bool empty() const
+    {   return Table.empty();
+    }
+
+    // Makes room for `Count` values in total, so that inserting up to that many won't rehash.
+    inline void reserve(index Count)
+    {   Table.reserve(Count);
+    }
+
+    // Removes all values but does not reclaim any memory.
+    inline void clear()
+    {   Table.clear();
+    }
+
+    // Clears the set and frees memory.  It is safe to continue using the set after this call.
+    inline void deallocate()
+    {   Table.deallocate();
+    }
+
+    inline bool contains(const t &Value) const
+    {   return Table.find(Value) >= 0;
+    }
+
+    // Adds `Value` to the set.  Returns true iff it wasn't already in the set.
+    bool insert(t Value)
+    {   bool Inserted;
+        Table.insert
+        (   Value, determining<bool>(Inserted),
+            [&Value](t *Slot) { memory::moveConstruct(Slot, std::move(Value)); }
+        );
+        return Inserted;
+    }
+
+    // Removes `Value` from the set, if it's there.  Returns true iff it was.
+    bool erase(const t &Value)
+    {   const index Slot = Table.find(Value);
+        if (Slot < 0)
+        {   return False;
+        }
+        Table.erase(Slot);
+        return True;
+    }
+
+    // Removes `Value` from the set and returns it, throwing if it's not there.
+    t pop(const t &Value)
+    {   const index Slot = Table.find(Value);
+        if (Slot < 0)
+        {   throw error(SetMissingValueErrorMsg, AT);
+        }
+        t Result = std::move(*Table.at(Slot));
+        Table.erase(Slot);
+        return Result;
+    }
+
+    // Set algebra.  Each of these makes one pass over the control bytes of one of the sets
+    // (the smaller one, where that works), doing a lookup in the other set for each value.
+
+    // Adds all values in `Other` to this set.
+    set &operator |= (const set &Other)
+    {   if (&Other == this)
+        {   return This;
+        }
+        Other.Table.forEachFull
+        (   [this, &Other](index Slot) { insert(*Other.Table.at(Slot)); }
+        );
+        return This;
+    }
+
+    // Removes any values which aren't also in `Other`.
+    set &operator &= (const set &Other)
+    {   if (&Other == this)
+        {   return This;
+        }
+        Table.forEachFull
+        (   [this, &Other](index Slot)
+            {   if (!Other.contains(*Table.at(Slot)))
+                {   Table.erase(Slot);
+                }
+            }
+        );
+        return This;
+    }
+
+    // Removes any values which are in `Other`.
+    set &operator -= (const set &Other)
+    {   if (&Other == this)
+        {   clear();
+            return This;
+        }
+        if (Other.count() < count())
+        {   Other.Table.forEachFull
+            (   [this, &Other](index Slot) { erase(*Other.Table.at(Slot)); }
+            );
+        }
+        else
+        {   Table.forEachFull
+            (   [this, &Other](index Slot)
+                {   if (Other.contains(*Table.at(Slot)))
+                    {   Table.erase(Slot);
+                    }
+                }
+            );
+        }
+        return This;
+    }
+
+    // Returns all values in either set.
+    set operator | (const set &Other) const
+    {   // Copying the bigger set avoids rehashing its values.
+        if (Other.count() > count())
+        {   set Result = Other;
+            return Result |= This;
+        }
+        set Result = This;
+        return Result |= Other;
+    }
+
+    // Returns the values which are in both sets.
+    set operator & (const set &Other) const
+    {   const set &Smaller = Other.count() < count() ? Other : This;
+        const set &Bigger = Other.count() < count() ? This : Other;
+        set Result;
+        Result.reserve(Smaller.count());
+        Smaller.Table.forEachFull
+        (   [&Result, &Smaller, &Bigger](index Slot)
+            {   const t &Value = *Smaller.Table.at(Slot);
+                if (Bigger.contains(Value))
+                {   Result.insert(Value);
+                }
+            }
+        );
+        return Result;
+    }
+
+    // Returns the values in this set which aren't in `Other`.
+    set operator - (const set &Other) const
+    {   set Result;
+        Result.reserve(count());
+        Table.forEachFull
+        (   [this, &Result, &Other](index Slot)
+            {   const t &Value = *Table.at(Slot);
+                if (!Other.contains(Value))
+                {   Result.insert(Value);
+                }
+            }
+        );
+        return Result;
+    }
+
+    bool operator == (const set &Other) const
+    {   if (count() != Other.count())
+        {   return False;
+        }
+        for (index Slot = Table.nextFull(-1); Slot >= 0; Slot = Table.nextFull(Slot))
+        {   if (!Other.contains(*Table.at(Slot)))
+            {   return False;
+            }
+        }
+        return True;
+    }
+
+    inline bool operator != (const set &Other) const
+    {   return !(*this == Other);
+    }
+
+    valuesIterator values() const &
+    {   return valuesIterator(&Table);
+    }
+
+private:
+    VISIBLE_FOR_TESTING
+    (   index capacity() const
+        {   return Table.capacity();
+        }
+    )
+};
+
+template <class t>
+std::ostream &operator << (std::ostream &Out, const set<t> &Set)
+{   Out << "set({ ";
+    for (const t &Value : Set.values())
+        Out << Value << ", ";
+    return Out << "})";
+}
+
+TMVB
@@ -0,0 +1,240 @@
+#include "small-array.h"
+
+#ifndef NDEBUG
+#include "string.h"
+#endif
+
+BVMT
+
+const char *const SmallArrayAllocationErrorMsg = "smallArray could not allocate on the heap";
+const char *const SmallArrayConstIndexErrorMsg = "smallArray index is past the end of a const smallArray";
+
+#ifndef NDEBUG
+using test::noisy;
+
+namespace
+{   const char *const ThrowsWhenMovedErrorMsg = "throwsWhenMoved was moved";
+
+    struct throwsWhenMoved
+    {   throwsWhenMoved() = default;
+        throwsWhenMoved(const throwsWhenMoved &) = default;
+        throwsWhenMoved(throwsWhenMoved &&)
+        {   throw error(ThrowsWhenMovedErrorMsg, AT);
+        }
+        throwsWhenMoved &operator = (const throwsWhenMoved &) = default;
+        throwsWhenMoved &operator = (throwsWhenMoved &&)
+        {   throw error(ThrowsWhenMovedErrorMsg, AT);
+        }
+    };
+
+    using smallInts = smallArray<i32, 4>;
+    using smallThrowers = smallArray<throwsWhenMoved, 4>;
+    using tinyThrowers = smallArray<throwsWhenMoved, 1>;
+    using smallStrings = smallArray<string, 2>;
+    using smallNoisies = smallArray<noisy, 2>;
+
+    // Appends `Count` values to `Array` and returns how many times that allocated,
+    // i.e., how many times the capacity had to grow.
+    template <class arrayType>
+    index appendCountingAllocations(arrayType &Array, i32 Count)
+    {   index Allocations = 0;
+        for (i32 I = 0; I < Count; ++I)
+        {   const index Capacity = Array.capacity();
+            Array.append(I);
+            Allocations += Array.capacity() != Capacity;
+        }
+        return Allocations;
+    }
+}
+
+void test__core__small_array()
+{   TEST
+    (   "smallArray stays inline until it grows past its inline count",
+        smallInts Array;
+        EXPECT_EQUAL(Array.onHeap(), False);
+        EXPECT_EQUAL(appendCountingAllocations(Array, 4), 0);
+        EXPECT_EQUAL(Array.onHeap(), False);
+        EXPECT_EQUAL(Array, smallInts({0, 1, 2, 3}));
+
+        EXPECT_EQUAL(appendCountingAllocations(Array, 1), 1);
+        EXPECT_EQUAL(Array.onHeap(), True);
+        EXPECT_EQUAL(Array.capacity(), 8);
+        EXPECT_EQUAL(Array, smallInts({0, 1, 2, 3, 0}));
+
+        Array.deallocate();
+        EXPECT_EQUAL(Array.onHeap(), False);
+        EXPECT_EQUAL(Array.count(), 0);
+    );
+
+    TEST
+    (   "smallArray has the same API as array",
+        smallInts Array({5, 6, 7});
+        Array.appendInPlace(8);
+        EXPECT_EQUAL(Array.pop(), 8);
+        EXPECT_EQUAL(Array.pop(0), 5);
+        EXPECT_EQUAL(Array, smallInts({6, 7}));
+
+        Array.insert(1, 100, 2);
+        EXPECT_EQUAL(Array, smallInts({6, 100, 100, 7}));
+        Array.insert(-1, 3);
+        EXPECT_EQUAL(Array, smallInts({6, 100, 100, 3, 7}));
+        EXPECT_EQUAL(Array.remove(100), 2);
+        EXPECT_EQUAL(Array, smallInts({6, 3, 7}));
+        Array.erase(0);
+        EXPECT_EQUAL(Array, smallInts({3, 7}));
+        Array.erase(1, 100);
+        EXPECT_EQUAL(Array, smallInts({3}));
+
+        // Growing via operator[] like array:
+        Array[3] = 9;
+        EXPECT_EQUAL(Array, smallInts({3, 0, 0, 9}));
+        EXPECT_EQUAL(Array[-1], 9);
+        EXPECT_THROW(Array.pop(-5), ArrayTooNegativeIndexErrorMsg);
+        const smallInts &ConstArray = Array;
+        EXPECT_THROW(ConstArray[4], SmallArrayConstIndexErrorMsg);
+
+        index Index = -1;
+        EXPECT_EQUAL(Array.findFirst(9, determining<index>(Index)), True);
+        EXPECT_EQUAL(Index, 3);
+        Array.sort().reverse();
+        EXPECT_EQUAL(Array, smallInts({9, 3, 0, 0}));
+
+        arrayView<i32> View = Array.view();
+        EXPECT_EQUAL(View.count(), 4);
+        View[1] = 4;
+        EXPECT_EQUAL(Array[1], 4);
+    );
+
+    TEST
+    (   "smallArray element pointers and iterators",
+        smallInts Array({1, 2, 3, 4, 5, 6});
+        smallInts::elementPointer Pointer = Array.get(-2);
+        EXPECT_EQUAL(*Pointer, 5);
+        EXPECT_EQUAL(Pointer.element().Index, 4);
+        EXPECT_EQUAL(Pointer.pop(), 5);
+        EXPECT_EQUAL(*Pointer, 6);
+        i32 Default = -1;
+        EXPECT_EQUAL(Array.get(10).otherwise(defaultTo(Default)), -1);
+
+        i32 Sum = 0;
+        for (i32 &Value : Array.values())
+        {   Sum += Value;
+        }
+        EXPECT_EQUAL(Sum, 16);
+        index Count = 0;
+        for (auto Element : Array)
+        {   EXPECT_EQUAL(Element.Value, Array[Element.Index]);
+            ++Count;
+        }
+        EXPECT_EQUAL(Count, 5);
+        array<i32> Copied = Array.values();
+        EXPECT_EQUAL(Copied, array<i32>({1, 2, 3, 4, 6}));
+        smallInts FromIterator = iterator<i32>::range(3);
+        EXPECT_EQUAL(FromIterator, smallInts({0, 1, 2}));
+    );
+
+    TEST
+    (   "smallArray copies and moves both inline and heap elements",
+        smallStrings Inline({"a", "b"});
+        smallStrings Heap({"c", "d", "e"});
+        EXPECT_EQUAL(Inline.onHeap(), False);
+        EXPECT_EQUAL(Heap.onHeap(), True);
+
+        smallStrings InlineCopy = Inline;
+        smallStrings HeapCopy = Heap;
+        EXPECT_EQUAL(InlineCopy, Inline);
+        EXPECT_EQUAL(HeapCopy, Heap);
+
+        smallStrings InlineMoved = std::move(InlineCopy);
+        smallStrings HeapMoved = std::move(HeapCopy);
+        EXPECT_EQUAL(InlineMoved, Inline);
+        EXPECT_EQUAL(HeapMoved, Heap);
+        EXPECT_EQUAL(InlineCopy.count(), 0);
+        EXPECT_EQUAL(HeapCopy.count(), 0);
+        EXPECT_EQUAL(HeapCopy.onHeap(), False);
+
+        InlineMoved = std::move(HeapMoved);
+        EXPECT_EQUAL(InlineMoved, Heap);
+        HeapCopy = Inline;
+        EXPECT_EQUAL(HeapCopy, Inline);
+        // Appending a reference to one of our own elements while growing:
+        HeapCopy.append(HeapCopy[0]);
+        EXPECT_EQUAL(HeapCopy, smallStrings({"a", "b", "a"}));
+    );
+
+    TEST
+    (   "smallArray destroys its elements",
+        {   smallNoisies Array;
+            Array.appendInPlace(1);
+            Array.appendInPlace(2);
+            Array.appendInPlace(3);
+            Array.erase(0);
+            // Shifts the rest down and destroys the moved-from last element:
+            ASSERT_STRING(TestPrintOutput.pull(), contains("noisy(2){MA}noisy(3){MA}~noisy(-3)"));
+        }
+        ASSERT_STRING(TestPrintOutput.pull(), contains("~noisy(3)~noisy(2)"));
+    );
+
+    TEST
+    (   "moving inline elements can throw, since they're moved one by one",
+        static_assert(std::is_nothrow_move_constructible_v<smallInts>);
+        static_assert(!std::is_nothrow_move_assignable_v<smallThrowers>);
+        smallThrowers Inline;
+        Inline.appendInPlace();
+        Inline.appendInPlace();
+        EXPECT_THROW(smallThrowers Moved(std::move(Inline)), ThrowsWhenMovedErrorMsg);
+        smallThrowers Other;
+        EXPECT_THROW(Other = std::move(Inline), ThrowsWhenMovedErrorMsg);
+        EXPECT_EQUAL(Inline.count(), 2);
+        // Heap storage is taken as a whole, so no elements are moved:
+        tinyThrowers Heap;
+        // Growing moves elements too, so spill onto the heap while still empty:
+        Heap.reserve(2);
+        Heap.appendInPlace();
+        Heap.appendInPlace();
+        tinyThrowers HeapMoved(std::move(Heap));
+        EXPECT_EQUAL(HeapMoved.count(), 2);
+        EXPECT_EQUAL(Heap.count(), 0);
+    );
+
+    TEST_BENCHMARK
+    (   "smallArray vs. array allocations for short per-entity lists",
+        const index EntityCount = 100000;
+        const int Frames = 10;
+        for (i32 ListCount = 2; ListCount <= 8; ListCount *= 2)
+        {   index ArrayAllocations = 0;
+            index SmallArrayAllocations = 0;
+            dbl ArraySeconds = test::secondsToRun
+            (   [&]()
+                {   for (int Frame = 0; Frame < Frames; ++Frame)
+                    {   for (index Entity = 0; Entity < EntityCount; ++Entity)
+                        {   array<i32> Components;
+                            ArrayAllocations += appendCountingAllocations(Components, ListCount);
+                        }
+                    }
+                }
+            );
+            dbl SmallArraySeconds = test::secondsToRun
+            (   [&]()
+                {   for (int Frame = 0; Frame < Frames; ++Frame)
+                    {   for (index Entity = 0; Entity < EntityCount; ++Entity)
+                        {   smallInts Components;
+                            SmallArrayAllocations += appendCountingAllocations(Components, ListCount);
+                        }
+                    }
+                }
+            );
+            LOG
+            (   ListCount << " components: array " << ArrayAllocations << " allocations in "
+                    << ArraySeconds << "s, smallArray<i32, 4> " << SmallArrayAllocations
+                    << " allocations in " << SmallArraySeconds << "s"
+            );
+            if (ListCount <= 4)
+            {   EXPECT_EQUAL(SmallArrayAllocations, 0);
+            }
+        }
+    );
+}
+#endif
+
+TMVB
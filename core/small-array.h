@@ -0,0 +1,454 @@
+#pragma once
+
+#include "array.h"
+#include "error.h"
+#include "iterator.h"
+#include "memory.h"
+#include "types.h"
+
+#include <algorithm>    // std::min, std::max, std::reverse, std::rotate, std::sort
+#include <initializer_list>
+#include <type_traits>  // std::is_nothrow_move_constructible_v
+
+BVMT
+
+extern const char *const SmallArrayAllocationErrorMsg;
+extern const char *const SmallArrayConstIndexErrorMsg;
+
+// An array which keeps up to `inlineCount` elements inside itself, and only allocates
+// on the heap when it grows past that, e.g., for per-entity lists which are usually short.
+// Has the same API as `array` (minus fixed counts), and works with `arrayView`,
+// `array::elementPointer`-style pointers, and `values()`/`elements()` iterators.
+// NOTE! Unlike `array`, moving a `smallArray` which hasn't spilled onto the heap
+// moves each element, so it's not free for large `inlineCount`s.
+template <class t, index inlineCount>
+class smallArray
+{   static_assert(inlineCount > 0, "use `array` if you don't want inline elements");
+
+    alignas(t) u8 Inline[inlineCount * sizeof(t)];
+    // Points at `Inline` until we need more than `inlineCount` elements.
+    t *Data = (t *)Inline;
+    index Count = 0;
+    index Capacity = inlineCount;
+
+public:
+    using element = arrayElement<t &>;
+    using constElement = arrayElement<const t &>;
+    typedef arrayDetail::elementPointer<smallArray *, t, element> elementPointer;
+    typedef arrayDetail::elementPointer<const smallArray *, const t, constElement> constElementPointer;
+    typedef staticIterator<t &, arrayDetail::arrayIteratorKernel<smallArray *, t &>> valuesIterator;
+    typedef staticIterator<const t &, arrayDetail::arrayIteratorKernel<const smallArray *, const t &>>
+            constValuesIterator;
+
+    typedef t value;
+
+    smallArray() {}
+
+    smallArray(std::initializer_list<t> Values)
+    {   reserve(Values.size());
+        for (const t &Value : Values)
+        {   appendInPlace(Value);
+        }
+    }
+
+    ~smallArray()
+    {   deallocate();
+    }
+
+    COPYABLE_TEMPLATE
+    (   smallArray, Array,
+        clear(),
+        reserve(Array.Count);
+        for (index I = 0; I < Array.Count; ++I)
+        {   memory::copyConstruct(&Data[I], Array.Data[I]);
+            ++Count;
+        }
+    )
+
+    // Not `MOVABLE_TEMPLATE`, since moving inline elements one by one can throw.
+    smallArray(smallArray &&Array) noexcept(std::is_nothrow_move_constructible_v<t>)
+    {   moveFrom(Array);
+    }
+
+    smallArray &operator = (smallArray &&Array) noexcept(std::is_nothrow_move_constructible_v<t>)
+    {   SET_EQUAL_GUARD(Array, deallocate(); moveFrom(Array));
+    }
+
+    ITERATOR_CONSTRUCTOR_TEMPLATES
+    (   smallArray, reserve(Iterator.remainingCount().AtLeast),
+        t, T,
+        append(T)
+    )
+
+    ITERATOR_ASSIGNMENT_TEMPLATES
+    (   smallArray, clear(); reserve(Iterator.remainingCount().AtLeast),
+        t, T,
+        append(T)
+    )
+
+    ITERATOR_PLUS_EQUAL_TEMPLATES
+    (   smallArray, reserveExtra(Iterator.remainingCount().AtLeast),
+        t, T,
+        append(T)
+    )
+
+    inline arrayView<t> view() &
+    {   return arrayView<t>(Data, Data + Count);
+    }
+
+    inline arrayView<const t> view() const &
+    {   return arrayView<const t>(Data, Data + Count);
+    }
+
+    // True if the elements have spilled out of the inline storage onto the heap.
+    inline bool onHeap() const
+    {   return Data != (const t *)Inline;
+    }
+
+    // Returns a pointer to an array element that is "safe" even if this array is resized.
+    // Note! this will normalize negative index values before passing to the pointer.
+    elementPointer get(index Index)
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index);
+        return elementPointer(this, Index);
+    }
+
+    // const version of the above.
+    constElementPointer get(index Index) const
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index);
+        return constElementPointer(this, Index);
+    }
+
+    // WARNING! It is not memory safe to hold onto a reference here and
+    // then expand/shrink the array.
+    const t &operator[] (index Index) const
+    {   return *getNonNullValue(Index);
+    }
+
+    // Like `array`, this grows the array if `Index` is past the end.
+    // WARNING! It is not memory safe to hold onto a reference here and
+    // then expand/shrink the array.
+    t &operator[] (index Index)
+    {   return *getNonNullValue(Index);
+    }
+
+    t swap(index Index, t T)
+    {   t Result = std::move(operator[](Index));
+        operator[](Index) = std::move(T);
+        return Result;
+    }
+
+    // See `array::swapIndices`.
+    void swapIndices(index Index1, index Index2)
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index1);
+        ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index2);
+        t &Value1 = operator[](Index1);
+        t &Value2 = operator[](Index2);
+        if (&Value1 == &Value2)
+            return;
+        std::swap(Value1, Value2);
+    }
+
+    inline t &append(t &&NewEnd) &
+    {   return appendInPlace(std::move(NewEnd));
+    }
+
+    template <class u = t> requires (type<u>::IsCopyConstructible)
+    inline t &append(const u &NewEnd) &
+    {   return appendInPlace(NewEnd);
+    }
+
+    template<class... arguments>
+    inline t &appendInPlace(arguments&&... Arguments) &
+    {   if (Count == Capacity)
+        {   // The arguments might refer to one of our elements, so construct before we move them:
+            t NewEnd(std::forward<arguments>(Arguments)...);
+            reserveExtra(1);
+            memory::moveConstruct(&Data[Count], std::move(NewEnd));
+        }
+        else
+        {   new (&Data[Count]) t(std::forward<arguments>(Arguments)...);
+        }
+        return Data[Count++];
+    }
+
+    inline t pop()
+    {   if (Count <= 0)
+            throw error(ArrayPoppingErrorMsg, AT);
+        t Result = std::move(Data[Count - 1]);
+        memory::deconstruct(&Data[--Count]);
+        return Result;
+    }
+
+    inline t pop(index Index)
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index)
+        else if (Index >= count())
+        {   throw error(ArrayPoppingErrorMsg, AT);
+        }
+        t Result = std::move(Data[Index]);
+        erase(Index, 1);
+        return Result;
+    }
+
+    void insert(index Index, t Value, index InsertCount = 1)
+    {   if (InsertCount == 0)
+            return;
+        if (InsertCount < 0)
+            throw error(ArrayInvalidArgumentErrorMsg, AT);
+        if (Index < 0)
+        {   Index += count();
+            if (Index < 0)
+                throw error(ArrayTooNegativeIndexErrorMsg, AT);
+        }
+        else if (Index >= count())
+        {   count(Index);
+        }
+        // Add the new values at the end, then rotate them into place:
+        const index OldCount = Count;
+        reserveExtra(InsertCount);
+        for (index I = 0; I < InsertCount; ++I)
+        {   memory::copyConstruct(&Data[Count++], Value);
+        }
+        std::rotate(Data + Index, Data + OldCount, Data + Count);
+    }
+
+    // Removes all elements in the Array that are equal to the passed in value.
+    // Returns the number of elements removed.
+    index remove(const t &T)
+    {   index Kept = 0;
+        for (index I = 0; I < Count; ++I)
+        {   if (Data[I] == T)
+            {   continue;
+            }
+            if (Kept != I)
+            {   Data[Kept] = std::move(Data[I]);
+            }
+            ++Kept;
+        }
+        const index Removed = Count - Kept;
+        count(Kept);
+        return Removed;
+    }
+
+    inline void erase(index Index)
+    {   erase(Index, 1);
+    }
+
+    // Erases elements from index `StartingFrom` to index `StartingFrom + EraseCount - 1`,
+    // stopping at the end of the array.
+    void erase(index StartingFrom, index EraseCount)
+    {   if (EraseCount == 0)
+            return;
+        if (EraseCount < 0)
+            throw error(ArrayInvalidArgumentErrorMsg, AT);
+        if (StartingFrom < 0) {
+            StartingFrom += count();
+            if (StartingFrom < 0)
+                throw error(ArrayTooNegativeIndexErrorMsg, AT);
+        }
+        EraseCount = std::min(EraseCount, Count - StartingFrom);
+        if (EraseCount <= 0)
+            return;
+        std::move(Data + StartingFrom + EraseCount, Data + Count, Data + StartingFrom);
+        count(Count - EraseCount);
+    }
+
+    // Returns true iff we found an element that compares equal to the passed-in element;
+    // If found, the passed-in pointer will be set to the index of the element in the array.
+    bool findFirst(const t &T, determining<index> Index) const
+    {   for (index I = 0; I < Count; ++I)
+        {   if (Data[I] == T)
+            {   Index = I;
+                return True;
+            }
+        }
+        return False;
+    }
+
+    smallArray &reverse()
+    {   std::reverse(Data, Data + Count);
+        return This;
+    }
+
+    smallArray &sort()
+    {   std::sort(Data, Data + Count);
+        return This;
+    }
+
+    inline bool empty() const
+    {   return Count == 0;
+    }
+
+    inline index count() const
+    {   return Count;
+    }
+
+    inline void count(index ResizeTo)
+    {   ASSERT(ResizeTo >= 0);
+        reserve(ResizeTo);
+        while (Count < ResizeTo)
+        {   memory::defaultConstruct(&Data[Count++]);
+        }
+        while (Count > ResizeTo)
+        {   memory::deconstruct(&Data[--Count]);
+        }
+    }
+
+    // Removes all elements from the array but does not reclaim any memory.
+    inline void clear()
+    {   count(0);
+    }
+
+    // Clears the array and frees any heap memory, going back to inline storage.
+    inline void deallocate()
+    {   clear();
+        if (onHeap())
+        {   memory::deallocate(Data);
+            Data = (t *)Inline;
+            Capacity = inlineCount;
+        }
+    }
+
+    inline void reserve(index ReserveCount)
+    {   ASSERT(ReserveCount >= 0);
+        if (ReserveCount > Capacity)
+        {   grow(ReserveCount);
+        }
+    }
+
+    // Reserves space for `Extra` more elements than we currently have, growing geometrically.
+    inline void reserveExtra(index Extra)
+    {   ASSERT(Extra >= 0);
+        const index Needed = Count + Extra;
+        if (Needed > Capacity)
+        {   grow(std::max(Needed, 2 * Capacity));
+        }
+    }
+
+    bool operator == (const smallArray &Other) const
+    {   if (Count != Other.Count)
+            return False;
+        for (index I = 0; I < Count; ++I)
+        {   if (Data[I] != Other.Data[I])
+            {   return False;
+            }
+        }
+        return True;
+    }
+
+    inline bool operator != (const smallArray &Other) const
+    {   return !(*this == Other);
+    }
+
+    valuesIterator values() &
+    {   return valuesIterator(this);
+    }
+
+    constValuesIterator values() const &
+    {   return constValuesIterator(this);
+    }
+
+    elementPointer first() &
+    {   return empty() ? elementPointer() : elementPointer(this, 0);
+    }
+
+    constElementPointer first() const &
+    {   return empty() ? constElementPointer() : constElementPointer(this, 0);
+    }
+
+    CONTAINER_ITERATOR(smallArray)
+    MUTABLE_CONTAINER_ITERATOR(smallArray)
+
+private:
+    VISIBLE_FOR_TESTING
+    (   index capacity() const
+        {   return Capacity;
+        }
+    )
+
+    // Takes `Array`'s heap storage, or moves its inline elements, leaving it empty.
+    // If an element's move throws, both arrays keep the elements they have so far.
+    void moveFrom(smallArray &Array)
+    {   ASSERT(Count == 0 && !onHeap());
+        if (Array.onHeap())
+        {   Data = Array.Data;
+            Capacity = Array.Capacity;
+            Count = Array.Count;
+            Array.Data = (t *)Array.Inline;
+            Array.Capacity = inlineCount;
+            Array.Count = 0;
+            return;
+        }
+        for (index I = 0; I < Array.Count; ++I)
+        {   memory::moveConstruct(&Data[I], std::move(Array.Data[I]));
+            ++Count;
+        }
+        Array.clear();
+    }
+
+    // Moves the elements into heap storage for `NewCapacity` elements.
+    void grow(index NewCapacity)
+    {   t *NewData = memory::allocate<t>(NewCapacity, "smallArray");
+        if (NewData == Null)
+        {   throw error(SmallArrayAllocationErrorMsg, AT);
+        }
+        for (index I = 0; I < Count; ++I)
+        {   memory::moveConstruct(&NewData[I], std::move(Data[I]));
+            memory::deconstruct(&Data[I]);
+        }
+        if (onHeap())
+        {   memory::deallocate(Data);
+        }
+        Data = NewData;
+        Capacity = NewCapacity;
+    }
+
+    t *getValue(index Index)
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index)
+        else if (Index >= count())
+        {   return Null;
+        }
+        return &Data[Index];
+    }
+
+    // const version of the above.
+    const t *getValue(index Index) const
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index)
+        else if (Index >= count())
+        {   return Null;
+        }
+        return &Data[Index];
+    }
+
+    inline t *getNonNullValue(index Index)
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index)
+        else if (Index >= count())
+        {   count(Index + 1);
+        }
+        return &Data[Index];
+    }
+
+    // const version of the above.
+    inline const t *getNonNullValue(index Index) const
+    {   ARRAY_ADJUST_INDEX_IF_NEGATIVE(Index)
+        else if (Index >= count())
+        {   throw error(SmallArrayConstIndexErrorMsg, AT);
+        }
+        return &Data[Index];
+    }
+
+    template <class a1, class t1, class e1>
+    friend class arrayDetail::elementPointer;
+    template <class a1, class t1>
+    friend class arrayDetail::arrayIteratorKernel;
+};
+
+template <class t, index inlineCount>
+std::ostream &operator << (std::ostream &Out, const smallArray<t, inlineCount> &Array)
+{   Out << "smallArray({ ";
+    const index Count = Array.count();
+    for (index I = 0; I < Count; ++I)
+        Out << Array[I] << ", ";
+    return Out << "})";
+}
+
+TMVB
@@ -0,0 +1,314 @@
+#include "string-buffer.h"
+
+#include <algorithm>    // std::max, std::min
+#include <cstdint>      // uintptr_t
+#include <cstring>      // memcpy, memmove, memset
+#include <new>          // placement new
+
+#ifndef NDEBUG
+#include "array.h"
+#include "parallel.h"
+#include "string.h"
+#endif
+
+BVMT
+
+stringBuffer::stringBuffer(memory::resource &_Resource)
+:   Resource(&_Resource == &memory::heap() ? Null : &_Resource)
+{   setInlineSize(0);
+}
+
+stringBuffer::stringBuffer(const char *Chars, index Count, memory::resource *_Resource)
+:   Resource(_Resource == &memory::heap() ? Null : _Resource)
+{   setInlineSize(0);
+    append(Chars, Count);
+}
+
+stringBuffer::stringBuffer(const stringBuffer &Buffer)
+{   if (!Buffer.isInline() && Buffer.Resource == Null && Buffer.Heap.Size > InlineCapacity)
+    {   Buffer.header()->References.fetch_add(1, std::memory_order_relaxed);
+        Heap = Buffer.Heap;
+        Inline[InlineCapacity] = (char)HeapTag;
+    }
+    else
+    {   setInlineSize(0);
+        append(Buffer.data(), Buffer.size());
+    }
+}
+
+stringBuffer::stringBuffer(stringBuffer &&Buffer) noexcept
+:   Resource(Buffer.Resource)
+{   memcpy(Inline, Buffer.Inline, sizeof(Inline));
+    Buffer.setInlineSize(0);
+}
+
+stringBuffer &stringBuffer::operator = (const stringBuffer &Buffer)
+{   if (this == &Buffer)
+    {   return This;
+    }
+    if (Resource == Null && Buffer.Resource == Null && !Buffer.isInline() && Buffer.Heap.Size > InlineCapacity)
+    {   if (isInline() || Heap.Chars != Buffer.Heap.Chars)
+        {   Buffer.header()->References.fetch_add(1, std::memory_order_relaxed);
+            release();
+            Heap = Buffer.Heap;
+            Inline[InlineCapacity] = (char)HeapTag;
+        }
+        return This;
+    }
+    assign(Buffer.data(), Buffer.size());
+    return This;
+}
+
+stringBuffer &stringBuffer::operator = (stringBuffer &&Buffer)
+{   if (this == &Buffer)
+    {   return This;
+    }
+    if (Resource == Buffer.Resource)
+    {   release();
+        memcpy(Inline, Buffer.Inline, sizeof(Inline));
+        Buffer.setInlineSize(0);
+    }
+    else
+    {   // Like a std::pmr container, the bytes move over to this buffer's resource.
+        assign(Buffer.data(), Buffer.size());
+        Buffer.clear();
+    }
+    return This;
+}
+
+memory::resource &stringBuffer::resource() const
+{   return Resource == Null ? memory::heap() : *Resource;
+}
+
+void stringBuffer::append(const char *Chars, index Count)
+{   if (Count <= 0)
+    {   return;
+    }
+    const index Size = size();
+    // `Chars` could be in our own bytes, which might move when we make room.
+    const uintptr_t Start = (uintptr_t)data();
+    const bool Aliased = (uintptr_t)Chars >= Start && (uintptr_t)Chars < Start + Size;
+    const index Offset = (uintptr_t)Chars - Start;
+    char *Bytes = mutableData(Size + Count);
+    memmove(Bytes + Size, Aliased ? Bytes + Offset : Chars, Count);
+    setSize(Size + Count);
+}
+
+void stringBuffer::assign(const char *Chars, index Count)
+{   if (isInline() ? Count <= InlineCapacity : Count <= Heap.Capacity && !shared())
+    {   // No need to reallocate, so `Chars` stays valid even if it's in our own bytes.
+        memmove(mutableData(Count), Chars, Count);
+        setSize(Count);
+        return;
+    }
+    stringBuffer Result(Chars, Count, Resource);
+    This = std::move(Result);
+}
+
+void stringBuffer::resize(index Size)
+{   const index OldSize = size();
+    char *Bytes = mutableData(Size);
+    if (Size > OldSize)
+    {   memset(Bytes + OldSize, 0, Size - OldSize);
+    }
+    setSize(Size);
+}
+
+void stringBuffer::reserve(index Capacity)
+{   mutableData(std::max(Capacity, size()));
+}
+
+void stringBuffer::clear()
+{   if (shared())
+    {   release();
+    }
+    else
+    {   setSize(0);
+    }
+}
+
+char *stringBuffer::reallocate(index Capacity)
+{   const index Size = size();
+    const index OldCapacity = capacity();
+    // Grow geometrically, but when only unsharing, take just what was asked for.
+    const index NewCapacity = Capacity > OldCapacity ? std::max(Capacity, 2 * OldCapacity) : Capacity;
+    const index CopyCount = std::min(Size, NewCapacity);
+    if (NewCapacity <= InlineCapacity)
+    {   // Unsharing a short heap buffer.
+        ASSERT(!isInline());
+        char Bytes[InlineCapacity];
+        memcpy(Bytes, Heap.Chars, CopyCount);
+        release();
+        memcpy(Inline, Bytes, CopyCount);
+        setInlineSize(CopyCount);
+        return Inline;
+    }
+    const index AllocationBytes = sizeof(sharedHeader) + NewCapacity + 1;
+    void *Allocation = Resource == Null
+        ?   memory::heapResource::allocateInline(AllocationBytes, alignof(sharedHeader), AllocationKind)
+        :   Resource->allocateBytes(AllocationBytes, alignof(sharedHeader), AllocationKind);
+    sharedHeader *Header = new (Allocation) sharedHeader();
+    Header->References.store(1, std::memory_order_relaxed);
+    char *Chars = (char *)(Header + 1);
+    memcpy(Chars, data(), CopyCount);
+    release();
+    Heap.Chars = Chars;
+    Heap.Size = CopyCount;
+    Heap.Capacity = NewCapacity;
+    Inline[InlineCapacity] = (char)HeapTag;
+    Chars[CopyCount] = 0;
+    return Chars;
+}
+
+void stringBuffer::release()
+{   if (isInline())
+    {   return;
+    }
+    sharedHeader *Header = header();
+    if (Header->References.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {   const index AllocationBytes = sizeof(sharedHeader) + Heap.Capacity + 1;
+        Header->~sharedHeader();
+        if (Resource == Null)
+        {   memory::heapResource::deallocateInline(Header, alignof(sharedHeader));
+        }
+        else
+        {   Resource->deallocateBytes(Header, AllocationBytes, alignof(sharedHeader));
+        }
+    }
+    setInlineSize(0);
+}
+
+std::ostream &operator << (std::ostream &Out, const stringBuffer &Buffer)
+{   return Out.write(Buffer.data(), Buffer.size());
+}
+
+#ifndef NDEBUG
+void test__core__string_buffer()
+{   TEST
+    (   "stringBuffer keeps short strings inline",
+        stringBuffer Buffer;
+        EXPECT_EQUAL(Buffer.isInline(), True);
+        EXPECT_EQUAL(Buffer.size(), 0);
+        EXPECT_EQUAL(string(Buffer.c_str()), "");
+        const char *Chars = "a line that just fits inline!!!";
+        EXPECT_EQUAL((index)strlen(Chars), stringBuffer::InlineCapacity);
+        Buffer.append(Chars, strlen(Chars));
+        EXPECT_EQUAL(Buffer.isInline(), True);
+        EXPECT_EQUAL(Buffer.size(), stringBuffer::InlineCapacity);
+        // The size byte doubles as the terminator when full:
+        EXPECT_EQUAL((index)strlen(Buffer.c_str()), stringBuffer::InlineCapacity);
+        EXPECT_EQUAL(Buffer, std::string_view(Chars));
+
+        Buffer.push_back('?');
+        EXPECT_EQUAL(Buffer.isInline(), False);
+        EXPECT_EQUAL(Buffer.size(), 32);
+        EXPECT_EQUAL(Buffer[31], '?');
+        EXPECT_EQUAL(Buffer.capacity() >= 62, True);
+        Buffer.pop_back();
+        EXPECT_EQUAL(Buffer, std::string_view(Chars));
+        Buffer.resize(3);
+        Buffer.resize(5);
+        EXPECT_EQUAL(Buffer, std::string_view("a l\0\0", 5));
+        Buffer.clear();
+        EXPECT_EQUAL(Buffer.size(), 0);
+        EXPECT_EQUAL(string(Buffer.c_str()), "");
+    );
+
+    TEST
+    (   "stringBuffer copies share long strings until one of them changes",
+        const char *Chars = "a dialogue line which is much too long to fit inline";
+        stringBuffer Original(Chars, strlen(Chars));
+        EXPECT_EQUAL(Original.shared(), False);
+        stringBuffer Copy = Original;
+        EXPECT_EQUAL(Copy.data(), Original.data());
+        EXPECT_EQUAL(Copy.shared(), True);
+        EXPECT_EQUAL(Original.shared(), True);
+        stringBuffer Assigned;
+        Assigned = Copy;
+        EXPECT_EQUAL(Assigned.data(), Original.data());
+
+        Copy.push_back('!');
+        EXPECT_EQUAL(Copy.data() == Original.data(), False);
+        EXPECT_EQUAL(Copy, std::string_view("a dialogue line which is much too long to fit inline!"));
+        EXPECT_EQUAL(Original, std::string_view(Chars));
+        EXPECT_EQUAL(Assigned, Original);
+        Assigned.clear();
+        EXPECT_EQUAL(Assigned.isInline(), True);
+        EXPECT_EQUAL(Original.shared(), False);
+        EXPECT_EQUAL(Original, std::string_view(Chars));
+
+        // Short strings are copied rather than shared:
+        stringBuffer Short("hello", 5);
+        stringBuffer ShortCopy = Short;
+        EXPECT_EQUAL(ShortCopy.isInline(), True);
+        EXPECT_EQUAL(ShortCopy, Short);
+    );
+
+    TEST
+    (   "stringBuffer can append from its own bytes",
+        stringBuffer Buffer("0123456789", 10);
+        for (int I = 0; I < 4; ++I)
+        {   Buffer.append(Buffer.data(), Buffer.size());
+        }
+        EXPECT_EQUAL(Buffer.size(), 160);
+        EXPECT_EQUAL(Buffer[159], '9');
+        stringBuffer Shared = Buffer;
+        Buffer.append(Buffer.data() + 150, 10);
+        EXPECT_EQUAL(Buffer.size(), 170);
+        EXPECT_EQUAL(std::string_view(Buffer).substr(160), "0123456789");
+        EXPECT_EQUAL(Shared.size(), 160);
+        Buffer.assign(Buffer.data() + 5, 10);
+        EXPECT_EQUAL(Buffer, std::string_view("5678901234"));
+    );
+
+    TEST
+    (   "stringBuffer moves take the bytes and the resource",
+        const char *Chars = "a dialogue line which is much too long to fit inline";
+        stringBuffer Original(Chars, strlen(Chars));
+        const char *Data = Original.data();
+        stringBuffer Moved = std::move(Original);
+        EXPECT_EQUAL(Moved.data(), Data);
+        EXPECT_EQUAL(Original.size(), 0);
+        EXPECT_EQUAL(Original.isInline(), True);
+
+        memory::arena Arena(1024);
+        stringBuffer InArena(Arena);
+        InArena = std::move(Moved);
+        EXPECT_EQUAL(&InArena.resource(), (memory::resource *)&Arena);
+        EXPECT_EQUAL(InArena, std::string_view(Chars));
+        EXPECT_EQUAL(InArena.data() == Data, False);
+        EXPECT_EQUAL(Arena.bytesUsed() > 0, True);
+
+        // Arena buffers are never shared, and copies go on the heap:
+        stringBuffer Copy = InArena;
+        EXPECT_EQUAL(Copy.data() == InArena.data(), False);
+        EXPECT_EQUAL(&Copy.resource(), &memory::heap());
+        EXPECT_EQUAL(InArena.shared(), False);
+        stringBuffer Heap(Chars, strlen(Chars));
+        InArena = Heap;
+        EXPECT_EQUAL(InArena.shared(), False);
+        EXPECT_EQUAL(&InArena.resource(), (memory::resource *)&Arena);
+    );
+
+    TEST
+    (   "stringBuffer copies can be changed on different threads",
+        const char *Chars = "a dialogue line which is much too long to fit inline";
+        stringBuffer Original(Chars, strlen(Chars));
+        array<stringBuffer> Copies;
+        Copies.count(200);
+        parallelFor
+        (   Copies.view(),
+            [&Original](stringBuffer &Copy)
+            {   Copy = Original;
+                Copy.push_back('!');
+            }
+        );
+        for (const stringBuffer &Copy : Copies.values())
+        {   EXPECT_EQUAL(Copy.size(), (index)strlen(Chars) + 1);
+        }
+        EXPECT_EQUAL(Original.shared(), False);
+    );
+}
+#endif
+
+TMVB
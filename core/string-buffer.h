@@ -0,0 +1,188 @@
+#pragma once
+
+#include "error.h"
+#include "memory.h"
+#include "types.h"
+
+#include <atomic>
+#include <iostream>
+#include <string_view>
+
+BVMT
+
+// The bytes of a `string`.  Short strings (up to `InlineCapacity` bytes) are stored inline
+// without allocating, and longer ones in a reference-counted buffer which copies share
+// until one of them changes (copy-on-write), so that passing long strings around by value,
+// e.g., dialogue lines into draw commands, doesn't copy (or allocate for) their bytes.
+// Buffers from a non-heap `memory::resource` (e.g., an arena) are never shared, and like
+// `memory::resourceAllocator`, a copy goes on the heap while an assignment keeps the resource.
+// Always NUL-terminated.  As with std::string, one buffer isn't thread-safe, but copies
+// which share bytes can be used (and changed) on different threads.
+class stringBuffer
+{
+public:
+    static constexpr index InlineCapacity = 31;
+    // The `memory::allocationTracker` kind for heap buffers.
+    static constexpr const char *AllocationKind = "string";
+
+private:
+    // Precedes the bytes of a heap buffer.
+    struct sharedHeader
+    {   std::atomic<index> References;
+    };
+
+    struct heapBody
+    {   char *Chars;
+        index Size;
+        index Capacity;
+    };
+
+    union
+    {   heapBody Heap;
+        // In inline mode, the last byte is `InlineCapacity - size()`, which doubles as the
+        // NUL terminator when the inline buffer is full; otherwise it's `HeapTag`.
+        char Inline[InlineCapacity + 1];
+    };
+    // Null means the heap, like `memory::resourceAllocator`.
+    memory::resource *Resource = Null;
+
+    static constexpr u8 HeapTag = 0x80;
+
+public:
+    stringBuffer()
+    {   setInlineSize(0);
+    }
+
+    explicit stringBuffer(memory::resource &_Resource);
+    stringBuffer(const char *Chars, index Count, memory::resource *_Resource = Null);
+
+    // Shares `Buffer`'s bytes if it's a long string on the heap.
+    stringBuffer(const stringBuffer &Buffer);
+    // Takes `Buffer`'s bytes and resource, leaving it empty.
+    stringBuffer(stringBuffer &&Buffer) noexcept;
+    stringBuffer &operator = (const stringBuffer &Buffer);
+    // Takes `Buffer`'s bytes if it uses the same resource, otherwise copies them over
+    // (which can throw) to this buffer's resource, like a std::pmr container.
+    stringBuffer &operator = (stringBuffer &&Buffer);
+
+    ~stringBuffer()
+    {   release();
+    }
+
+    inline bool isInline() const
+    {   return (u8)Inline[InlineCapacity] != HeapTag;
+    }
+
+    // True if other buffers have the same bytes, i.e., changing this one will copy them first.
+    inline bool shared() const
+    {   return !isInline() && header()->References.load(std::memory_order_acquire) > 1;
+    }
+
+    inline index size() const
+    {   return isInline() ? InlineCapacity - (u8)Inline[InlineCapacity] : Heap.Size;
+    }
+
+    inline index capacity() const
+    {   return isInline() ? InlineCapacity : Heap.Capacity;
+    }
+
+    inline const char *data() const
+    {   return isInline() ? Inline : Heap.Chars;
+    }
+
+    inline const char *c_str() const
+    {   return data();
+    }
+
+    inline char operator [] (index Index) const
+    {   return data()[Index];
+    }
+
+    inline operator std::string_view() const
+    {   return std::string_view(data(), size());
+    }
+
+    memory::resource &resource() const;
+
+    inline void push_back(char Char)
+    {   const index Size = size();
+        mutableData(Size + 1)[Size] = Char;
+        setSize(Size + 1);
+    }
+
+    inline void pop_back()
+    {   const index Size = size();
+        mutableData(Size);
+        setSize(Size - 1);
+    }
+
+    // `Chars` may point into this buffer.
+    void append(const char *Chars, index Count);
+    void assign(const char *Chars, index Count);
+
+    // Grows (with NUL bytes) or shrinks to `Size` bytes.
+    void resize(index Size);
+    // Makes room for `Capacity` bytes without reallocating.
+    void reserve(index Capacity);
+    // Empties the buffer, keeping its memory unless it was shared.
+    void clear();
+
+    inline bool operator == (const stringBuffer &Other) const
+    {   return std::string_view(This) == std::string_view(Other);
+    }
+
+    inline bool operator == (std::string_view Other) const
+    {   return std::string_view(This) == Other;
+    }
+
+    inline bool operator < (const stringBuffer &Other) const
+    {   return std::string_view(This) < std::string_view(Other);
+    }
+
+private:
+    inline sharedHeader *header() const
+    {   ASSERT(!isInline());
+        return (sharedHeader *)Heap.Chars - 1;
+    }
+
+    inline void setInlineSize(index Size)
+    {   ASSERT(Size >= 0 && Size <= InlineCapacity);
+        Inline[Size] = 0;
+        Inline[InlineCapacity] = (char)(InlineCapacity - Size);
+    }
+
+    inline void setSize(index Size)
+    {   if (isInline())
+        {   setInlineSize(Size);
+        }
+        else
+        {   Heap.Size = Size;
+            Heap.Chars[Size] = 0;
+        }
+    }
+
+    // Returns the bytes for writing, after making sure that they aren't shared
+    // and that there's room for `Capacity` bytes.
+    inline char *mutableData(index Capacity)
+    {   if (isInline())
+        {   if (Capacity <= InlineCapacity)
+            {   return Inline;
+            }
+        }
+        else if (Capacity <= Heap.Capacity && header()->References.load(std::memory_order_acquire) == 1)
+        {   return Heap.Chars;
+        }
+        return reallocate(Capacity);
+    }
+
+    // Moves the bytes into a new (unshared) buffer with room for at least `Capacity` bytes.
+    char *reallocate(index Capacity);
+    // Drops this buffer's reference to its heap bytes, freeing them if it was the last one.
+    void release();
+
+    friend std::ostream &operator << (std::ostream &Out, const stringBuffer &Buffer);
+};
+
+std::ostream &operator << (std::ostream &Out, const stringBuffer &Buffer);
+
+TMVB
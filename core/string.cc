@@ -14,21 +14,77 @@ void string::locale(const char *Chars)
 {   std::locale::global(std::locale(Chars));
 }
 
-string::string(const char *Chars) : Internal(Chars) {}
+namespace
+{   // The rune count of well-formed utf8, or -1 to count it (the slow way) later.
+    inline index runeCountIfValid(const stringBuffer &Internal)
+    {   const u8 *Bytes = (const u8 *)Internal.data();
+        return utf8::valid(Bytes, Internal.size()) ? utf8::countRunes(Bytes, Internal.size()) : -1;
+    }
+}
 
-string::string(std::string String) : Internal(std::move(String)) {}
+string::string(const char *Chars)
+:   Internal(Chars, strlen(Chars)),
+    RuneCount(runeCountIfValid(Internal))
+{}
+
+string::string(std::string String)
+:   Internal(String.data(), String.size()),
+    RuneCount(runeCountIfValid(Internal))
+{}
 
 string::string(rune Rune)
+:   RuneCount(0)
 {   append(Rune);
 }
 
 string::string(stringView StringView)
-:   Internal
-    (   StringView.Internal->begin() + StringView.StartByte,
-        StringView.Internal->begin() + StringView.EndByte
-    )
+:   Internal(StringView.Source->Internal.data() + StringView.StartByte, StringView.countBytes()),
+    RuneCount(runeCountIfValid(Internal))
+{}
+
+string::string(memory::resource &Resource)
+:   Internal(Resource),
+    RuneCount(0)
+{}
+
+string::string(stringView StringView, memory::resource &Resource)
+:   Internal(StringView.Source->Internal.data() + StringView.StartByte, StringView.countBytes(), &Resource),
+    RuneCount(runeCountIfValid(Internal))
 {}
 
+string::string(string &&String) noexcept
+:   Internal(std::move(String.Internal)),
+    RuneCount(String.RuneCount)
+{   String.Internal.clear();
+    String.RuneCount = 0;
+    ++String.Version;
+}
+
+string &string::operator = (const string &String)
+{   if (this != &String)
+    {   Internal = String.Internal;
+        RuneCount = String.RuneCount;
+        ++Version;
+    }
+    return This;
+}
+
+string &string::operator = (string &&String)
+{   if (this != &String)
+    {   Internal = std::move(String.Internal);
+        RuneCount = String.RuneCount;
+        ++Version;
+        String.Internal.clear();
+        String.RuneCount = 0;
+        ++String.Version;
+    }
+    return This;
+}
+
+memory::resource &string::resource() const
+{   return Internal.resource();
+}
+
 stringView string::view() const &
 {   return stringView(This);
 }
@@ -42,7 +98,11 @@ const char *string::chars() const &
 }
 
 void string::append(rune Rune) &
-{   if (Rune < 0)
+{   if (Rune >= 0 && Rune < 1114112 && RuneCount >= 0)
+    {   appendingRunes(1);
+    }
+    ++Version;
+    if (Rune < 0)
     {   LOG_ERR("Rune < 0");
     }
     else if (Rune < 128)
@@ -69,7 +129,28 @@ void string::append(rune Rune) &
 }
 
 void string::append(const string &Other) &
-{   Internal += Other.Internal;
+{   if (Other.RuneCount < 0)
+    {   // `Other` might be invalid utf8, so the joined bytes get recounted when needed.
+        RuneCount = -1;
+    }
+    else if (!Other.empty() && RuneCount >= 0)
+    {   appendingRunes(Other.RuneCount);
+    }
+    Internal.append(Other.Internal.data(), Other.Internal.size());
+    ++Version;
+}
+
+void string::appendAscii(const char *Chars, index Count)
+{   if (Count > 0 && RuneCount >= 0)
+    {   appendingRunes(Count);
+    }
+    Internal.append(Chars, Count);
+    ++Version;
+}
+
+void string::append(iterator<rune> &&Runes) &
+{   reserve(countBytes() + Runes.remainingCount().AtLeast);
+    ITERATOR_BATCH_LOOP(Runes, rune, Rune, append(Rune))
 }
 
 rune string::pop()
@@ -78,12 +159,90 @@ rune string::pop()
     ASSERT(SelfView.EndByte >= 0 && SelfView.EndByte <= countBytes());
     // Make sure to resize the current array, the stringView doesn't do that:
     Internal.resize(SelfView.EndByte);
+    ++Version;
+    if (RuneCount > 0)
+    {   // An invalid utf8 sequence might not pop the same way that it's counted.
+        RuneCount = Result >= 0 ? RuneCount - 1 : -1;
+    }
     return Result;
 }
 
 index string::count() const
-{   // TODO: possibly keep track of this separately, so this operation is O(1) instead of O(N)
-    return view().count();
+{   // Not cached, since many threads might be counting the same (invalid utf8) string.
+    return RuneCount >= 0 ? RuneCount : view().count();
+}
+
+void string::appendingRunes(index Runes)
+{   if (endsOnRuneBoundary())
+    {   if (RuneCount >= 0)
+        {   RuneCount += Runes;
+        }
+    }
+    else
+    {   // The new bytes might become part of our last rune.
+        RuneCount = -1;
+    }
+}
+
+index string::byteOfRune(index Rune) const
+{   stringView View(This);
+    for (index I = 0; I < Rune && !View.empty(); ++I)
+    {   View.shift();
+    }
+    return View.StartByte;
+}
+
+index string::runeOfByte(index Byte) const
+{   stringView View(This);
+    index Rune = 0;
+    while (!View.empty())
+    {   View.shift();
+        if (View.StartByte > Byte)
+        {   break;
+        }
+        ++Rune;
+    }
+    return Rune;
+}
+
+rune string::runeAt(index Rune) const
+{   if (Rune < 0)
+    {   Rune += count();
+    }
+    if (Rune < 0)
+    {   return 0;
+    }
+    stringView View(This, byteOfRune(Rune), countBytes());
+    return View.shift();
+}
+
+stringView string::slice(index StartRune, index EndRune) const &
+{   const index StartByte = byteOfRune(StartRune);
+    return stringView(This, StartByte, std::max(byteOfRune(EndRune), StartByte));
+}
+
+bool string::endsOnRuneBoundary() const
+{   const index Size = Internal.size();
+    for (index Back = 1; Back <= std::min(Size, (index)4); ++Back)
+    {   const u8 Byte = (u8)Internal[Size - Back];
+        if ((Byte & 0b11000000) == 0b10000000)
+        {   // Continuation byte, keep looking for the start of the sequence.
+            continue;
+        }
+        index SequenceBytes = 1;
+        if ((Byte & 0b11100000) == 0b11000000)
+        {   SequenceBytes = 2;
+        }
+        else if ((Byte & 0b11110000) == 0b11100000)
+        {   SequenceBytes = 3;
+        }
+        else if ((Byte & 0b11111000) == 0b11110000)
+        {   SequenceBytes = 4;
+        }
+        return SequenceBytes <= Back;
+    }
+    // Empty, or only continuation bytes (which get counted one at a time).
+    return True;
 }
 
 index string::countBytes() const
@@ -95,11 +254,15 @@ void string::reserve(index Bytes)
 }
 
 bool string::contains(const char *Substring) const
-{   return Internal.find(Substring, 0) != std::string::npos;
+{   return view().contains(Substring);
 }
 
 bool string::contains(const string &Substring) const
-{   return Internal.find(Substring.Internal, 0) != std::string::npos;
+{   return view().contains(Substring.view());
+}
+
+bool string::contains(const stringView &Substring) const
+{   return view().contains(Substring);
 }
 
 bool string::operator == (const char *Other) const
@@ -107,7 +270,7 @@ bool string::operator == (const char *Other) const
 }
 
 bool string::operator == (const std::string &Other) const
-{   return Internal == Other;
+{   return std::string_view(Internal) == Other;
 }
 
 bool string::operator == (const string &Other) const
@@ -123,11 +286,17 @@ bool string::operator < (const string &Other) const
     auto& Facet = std::use_facet<std::collate<char>>(Locale);
  
     return Facet.compare
-    (   &Internal[0], &Internal[0] + Internal.size(),
-        &(Other.Internal[0]), &(Other.Internal[0]) + Other.Internal.size()
+    (   Internal.data(), Internal.data() + Internal.size(),
+        Other.Internal.data(), Other.Internal.data() + Other.Internal.size()
     )   < 0;
 }
 
+std::string string::collationKey() const
+{   std::locale Locale;
+    auto &Facet = std::use_facet<std::collate<char>>(Locale);
+    return Facet.transform(Internal.data(), Internal.data() + Internal.size());
+}
+
 std::ostream &operator << (std::ostream &Out, const string &String)
 {   return Out << String.Internal;
 }
@@ -139,7 +308,7 @@ stringView::stringView()
 {}
 
 stringView::stringView(const string &String, index _StartByte, index _EndByte)
-:   Internal(&String.Internal),
+:   Source(&String),
     StartByte(_StartByte),
     EndByte(_EndByte)
 {   ASSERT(EndByte >= StartByte);
@@ -160,7 +329,7 @@ bool stringView::empty() const
             StartByte >= EndByte
             // TODO: we should be able to remove this condition by ensuring StartByte >= EndByte
             // in the situation where this might occur.
-        ||  StartByte >= (index)Internal->size()
+        ||  StartByte >= (index)Source->Internal.size()
     ;
 }
 
@@ -263,17 +432,80 @@ stringView stringView::stripBack() &&
 
 
 index stringView::count() const
-{   stringView Copy = *this;
+{   if (StartByte == 0 && Source->RuneCount >= 0 && EndByte >= (index)Source->Internal.size())
+    {   return Source->RuneCount;
+    }
+    const u8 *Bytes = (const u8 *)Source->Internal.data() + StartByte;
+    const index ByteCount = countBytes();
     index Size = 0;
-    while (!Copy.empty())
-    {   ++Size;
-        Copy.shift();
+    if (utf8::valid(Bytes, ByteCount))
+    {   Size = utf8::countRunes(Bytes, ByteCount);
+    }
+    else
+    {   // Count malformed sequences the same way that `shift` would consume them.
+        stringView Copy = *this;
+        while (!Copy.empty())
+        {   ++Size;
+            Copy.shift();
+        }
     }
     return Size;
 }
 
+rune stringView::runeAt(index Rune) const
+{   if (Rune < 0)
+    {   Rune += count();
+    }
+    if (Rune < 0)
+    {   return 0;
+    }
+    stringView View = This;
+    for (index I = 0; I < Rune && !View.empty(); ++I)
+    {   View.shift();
+    }
+    return View.empty() ? 0 : View.shift();
+}
+
+stringView stringView::slice(index StartRune, index EndRune) const
+{   stringView View = This;
+    for (index I = 0; I < StartRune && !View.empty(); ++I)
+    {   View.shift();
+    }
+    const index SliceStartByte = std::min(View.StartByte, StartByte + countBytes());
+    for (index I = std::max(StartRune, (index)0); I < EndRune && !View.empty(); ++I)
+    {   View.shift();
+    }
+    const index SliceEndByte = std::min(View.StartByte, StartByte + countBytes());
+    return stringView(*Source, SliceStartByte, std::max(SliceEndByte, SliceStartByte));
+}
+
 index stringView::countBytes() const
-{   return std::max(0L, std::min((index)(Internal->size()), EndByte) - StartByte);
+{   return std::max(0L, std::min((index)(Source->Internal.size()), EndByte) - StartByte);
+}
+
+bool stringView::contains(const char *Substring) const
+{   const index SubstringCount = strlen(Substring);
+    if (SubstringCount == 0)
+    {   return True;
+    }
+    const u8 *Bytes = (const u8 *)Source->Internal.data() + StartByte;
+    const index Count = countBytes();
+    return utf8::find(Bytes, Count, (const u8 *)Substring, SubstringCount) < Count;
+}
+
+bool stringView::contains(const stringView &Substring) const
+{   const index SubstringCount = Substring.countBytes();
+    if (SubstringCount == 0)
+    {   return True;
+    }
+    const u8 *Bytes = (const u8 *)Source->Internal.data() + StartByte;
+    const index Count = countBytes();
+    const u8 *SubstringBytes = (const u8 *)Substring.Source->Internal.data() + Substring.StartByte;
+    return utf8::find(Bytes, Count, SubstringBytes, SubstringCount) < Count;
+}
+
+bool stringView::contains(const string &Substring) const
+{   return contains(Substring.view());
 }
 
 bool stringView::operator == (const char *Other) const
@@ -381,80 +613,86 @@ rune stringView::shiftNotEmpty()
 
 u8 stringView::shiftByteNotEmpty()
 {   ASSERT(!empty());
-    return (u8)Internal->operator[](StartByte++);
+    return (u8)Source->Internal[StartByte++];
 }
 
 u8 stringView::popByteNotEmpty()
 {   ASSERT(!empty());
-    return (u8)Internal->operator[](--EndByte);
+    return (u8)Source->Internal[--EndByte];
 }
 
 // TODO: switch to using CONTAINER_ITERATOR with `stringPointer`
 namespace detail
-{   class stringIteratorKernel : public iteratorKernel<rune>
-    {   stringView StringView;
-    private:
-        inline rune shiftRuneNotEmpty()
-        {   return StringView.shiftNotEmpty();
-        }
-
-        stringIteratorKernel(const stringView _StringView)
-        :   iteratorKernel<rune>
-            ({  .next = [](iteratorKernel<rune> *BaseKernelSelf)
-                {   CAST_DEFINE
-                    (   stringIteratorKernel *,
-                        Self,
-                        BaseKernelSelf
-                    );
-                    if (Self->StringView.empty())
-                    {   return optional<rune>();
-                    }
-                    return optional<rune>(Self->shiftRuneNotEmpty());
-                },
-            }),
-            StringView(_StringView)
-        {}
-
-    public:
-        KERNEL_TO_ITERATOR
-        (   stringIteratorKernel,
-            rune,
-            (stringView _StringView),
-            (_StringView)
-        );
-    };
-
-    class stringSplitIteratorKernel : public iteratorKernel<stringView>
+{   class stringSplitIteratorKernel : public iteratorKernel<stringView>
     {   stringView RemainingView;
         index EndOfLastRegionByte;
-        rune SplitRune;
+        // The utf8 bytes of the delimiters: each rune is a delimiter,
+        // unless `WholeDelimiter`, in which case all of the bytes are one delimiter.
+        string Delimiters;
+        bool WholeDelimiter;
+        // The first byte of each delimiter rune, to find candidates a block at a time.
+        utf8::byteSet FirstBytes;
     private:
         inline bool hasNext()
         {   return EndOfLastRegionByte < RemainingView.EndByte;
         }
 
+        // The byte count of the delimiter at `Bytes`, or 0 if there's none there.
+        inline index delimiterAt(const u8 *Bytes, index Count) const
+        {   const u8 *Delimiter = (const u8 *)Delimiters.chars();
+            const index DelimiterBytes = Delimiters.countBytes();
+            index Offset = 0;
+            while (Offset < DelimiterBytes)
+            {   const u8 Lead = Delimiter[Offset];
+                const index Length = Lead < 0x80 ? 1 : Lead < 0xE0 ? 2 : Lead < 0xF0 ? 3 : 4;
+                if (Length <= Count && memcmp(Bytes, Delimiter + Offset, Length) == 0)
+                {   return Length;
+                }
+                Offset += Length;
+            }
+            return 0;
+        }
+
         inline stringView findNextSplit()
         {   ASSERT(hasNext());
             stringView Result = RemainingView;
+            const u8 *Bytes = (const u8 *)RemainingView.Source->Internal.data();
+            const index EndByte = std::min(RemainingView.EndByte, (index)RemainingView.Source->Internal.size());
+            index SearchByte = RemainingView.StartByte;
             while (True)
-            {   if (RemainingView.empty())
-                {   ASSERT(RemainingView.StartByte == Result.EndByte);
-                    EndOfLastRegionByte = RemainingView.StartByte;
-                    return Result;
+            {   index SplitByte, SplitBytes;
+                if (WholeDelimiter)
+                {   SplitBytes = Delimiters.countBytes();
+                    SplitByte = SearchByte + utf8::find
+                    (   Bytes + SearchByte, EndByte - SearchByte,
+                        (const u8 *)Delimiters.chars(), SplitBytes
+                    );
+                }
+                else
+                {   SplitByte = SearchByte + utf8::findAny(Bytes + SearchByte, EndByte - SearchByte, FirstBytes);
+                    SplitBytes = SplitByte < EndByte ? delimiterAt(Bytes + SplitByte, EndByte - SplitByte) : 0;
                 }
-                index PossibleEndOfRegionByte = RemainingView.StartByte;
-                rune NextRune = RemainingView.shift();
-                if (NextRune == SplitRune)
-                {   Result.EndByte = PossibleEndOfRegionByte;
-                    EndOfLastRegionByte = PossibleEndOfRegionByte;
+                if (SplitByte >= EndByte || (SplitBytes == 0 && WholeDelimiter))
+                {   // No more delimiters (an empty `WholeDelimiter` never splits).
+                    RemainingView.StartByte = EndByte;
+                    EndOfLastRegionByte = EndByte;
                     return Result;
                 }
+                if (SplitBytes == 0)
+                {   // The first byte matched but the rest of the rune didn't.
+                    SearchByte = SplitByte + 1;
+                    continue;
+                }
+                Result.EndByte = SplitByte;
+                EndOfLastRegionByte = SplitByte;
+                RemainingView.StartByte = SplitByte + SplitBytes;
+                return Result;
             }
             // Shouldn't ever get here, but compiler warns about it.
             return Result;
         }
 
-        stringSplitIteratorKernel(stringView StringView, rune _SplitRune)
+        stringSplitIteratorKernel(stringView StringView, string _Delimiters, bool _WholeDelimiter)
         :   iteratorKernel<stringView>
             ({  .next = [](iteratorKernel<stringView> *BaseKernelSelf)
                 {   CAST_DEFINE
@@ -466,32 +704,72 @@ namespace detail
                             ? optional<stringView>(Self->findNextSplit())
                             : optional<stringView>();
                 },
+                // There's at least one more region if we haven't hit the end, and at most
+                // one more region than the number of remaining bytes (all split runes).
+                .remainingCount = [](iteratorKernel<stringView> *BaseKernelSelf)
+                {   CAST_DEFINE
+                    (   stringSplitIteratorKernel *,
+                        Self,
+                        BaseKernelSelf
+                    );
+                    if (!Self->hasNext())
+                    {   return countHint::exactly(0);
+                    }
+                    const index Bytes = Self->RemainingView.EndByte - Self->RemainingView.StartByte;
+                    return countHint({.AtLeast = 1, .AtMost = Bytes + 1});
+                },
             }),
             RemainingView(StringView),
             EndOfLastRegionByte(StringView.StartByte - 1),
-            SplitRune(_SplitRune)
-        {}
+            Delimiters(std::move(_Delimiters)),
+            WholeDelimiter(_WholeDelimiter)
+        {   if (!WholeDelimiter)
+            {   const u8 *Bytes = (const u8 *)Delimiters.chars();
+                const index Count = Delimiters.countBytes();
+                for (index I = 0; I < Count; ++I)
+                {   if ((Bytes[I] & 0b11000000) != 0b10000000)
+                    {   FirstBytes.add(Bytes[I]);
+                    }
+                }
+            }
+        }
 
     public:
         KERNEL_TO_ITERATOR
         (   stringSplitIteratorKernel,
             stringView,
-            (stringView StringView, rune _SplitRune),
-            (StringView, _SplitRune)
+            (stringView StringView, string _Delimiters, bool _WholeDelimiter),
+            (StringView, std::move(_Delimiters), _WholeDelimiter)
         );
     };
 }
 
-iterator<rune> string::runes() const
+staticIterator<rune, detail::stringIteratorKernel> string::runes() const
 {   return view().runes();
 }
 
-iterator<rune> stringView::runes() const
-{   return detail::stringIteratorKernel::toIterator(*this);
+staticIterator<rune, detail::stringIteratorKernel> stringView::runes() const
+{   return staticIterator<rune, detail::stringIteratorKernel>(*this);
 }
 
 iterator<stringView> stringView::split(rune Split) const
-{   return detail::stringSplitIteratorKernel::toIterator(*this, Split);
+{   return detail::stringSplitIteratorKernel::toIterator(*this, string(Split), False);
+}
+
+iterator<stringView> stringView::split(std::initializer_list<rune> Splits) const
+{   string Delimiters;
+    for (rune Split : Splits)
+    {   Delimiters.append(Split);
+    }
+    return detail::stringSplitIteratorKernel::toIterator(*this, std::move(Delimiters), False);
+}
+
+iterator<stringView> stringView::split(const string &Split) const
+{   return detail::stringSplitIteratorKernel::toIterator(*this, Split, True);
+}
+
+iterator<stringView> stringView::split(const stringView &Split) const
+{   return detail::stringSplitIteratorKernel::toIterator(*this, string(Split), True);
 }
 
 #ifndef NDEBUG
@@ -584,6 +862,88 @@ void test__core__string()
             // (just moves the string), but that's hard to do.
             EXPECT_EQUAL(string::of(string("hi, world")), "hi, world");
         );
+
+        TEST
+        (   "string::of numbers with format options",
+            EXPECT_EQUAL(string::of(0.1), "0.1");
+            EXPECT_EQUAL(string::of(-7LL), "-7");
+            EXPECT_EQUAL(string::of(3.14159, {.Precision = 2}), "3.14");
+            EXPECT_EQUAL(string::of(255, {.Base = 16}), "ff");
+            EXPECT_EQUAL(string::of(42, {.Width = 6, .Pad = '0'}), "000042");
+            EXPECT_EQUAL(string::of(1.0, {.Precision = 200}), string("1.") + string("0") * format::MaxPrecision);
+        );
+
+        TEST
+        (   "string::of(char) is still a character",
+            EXPECT_EQUAL(string::of('x'), "x");
+        );
+    );
+
+    TEST
+    (   "appendNumber keeps the rune count",
+        string Line("Punkte: ");
+        EXPECT_EQUAL(Line.count(), 8);
+        Line.appendNumber(1500);
+        Line.append(string(" • "));
+        Line.appendNumber(-2.5f);
+        EXPECT_EQUAL(Line, "Punkte: 1500 • -2.5");
+        EXPECT_EQUAL(Line.count(), 19);
+        EXPECT_EQUAL(Line.count(), Line.view().count());
+    );
+
+    TEST
+    (   "stringView parses hex, underscores, exponents, and only numbers which fit",
+        string Data("0x1F 1_000 -2.5e-1 300 4.0000000000000001");
+        stringView View = Data.view();
+        int Mask = 0;
+        EXPECT_EQUAL(View.shiftInteger(determining(Mask)), True);
+        EXPECT_EQUAL(Mask, 31);
+        View.stripFront();
+        i64 Gold = 0;
+        EXPECT_EQUAL(View.shiftInteger(determining(Gold)), True);
+        EXPECT_EQUAL(Gold, 1000);
+        View.stripFront();
+        dbl Speed = 0;
+        EXPECT_EQUAL(View.shiftReal(determining(Speed)), True);
+        EXPECT_EQUAL(Speed, -0.25);
+        View.stripFront();
+        u8 Byte = 7;
+        EXPECT_EQUAL(View.shiftInteger(determining(Byte)), False);
+        EXPECT_EQUAL(Byte, 7);
+        EXPECT_EQUAL(View.countBytes(), 22);
+        u16 Word = 7;
+        EXPECT_EQUAL(View.shiftInteger(determining(Word)), True);
+        EXPECT_EQUAL(Word, 300);
+        View.stripFront();
+        dbl Real = 0;
+        EXPECT_EQUAL(View.real(determining(Real)), True);
+        EXPECT_EQUAL(Real == 4.0, True);
+    );
+
+    TEST
+    (   "stringView::numbers parses a delimited row into an array",
+        string Row("12, 7, 0x10,3");
+        array<i32> Tiles;
+        Tiles.count(4);
+        EXPECT_EQUAL(Row.numbers(',', Tiles.view()), True);
+        EXPECT_EQUAL(Tiles[0], 12);
+        EXPECT_EQUAL(Tiles[2], 16);
+        EXPECT_EQUAL(Tiles[3], 3);
+        Tiles.count(5);
+        EXPECT_EQUAL(Row.numbers(',', Tiles.view()), False);
+        Tiles.count(3);
+        EXPECT_EQUAL(Row.numbers(',', Tiles.view()), False);
+
+        string Line("position: 0.5 -1.25 8");
+        array<flt> Position;
+        Position.count(3);
+        stringView Values = Line.view();
+        for (int I = 0; I < 10; ++I)
+        {   Values.shift();
+        }
+        EXPECT_EQUAL(Values.numbers(' ', Position.view()), True);
+        EXPECT_EQUAL(Position[1], -1.25f);
+        EXPECT_EQUAL(Position[2], 8.0f);
     );
 
     TEST
@@ -662,6 +1022,19 @@ void test__core__string()
                 EXPECT_EQUAL(String.count(), 14);
             );
         );
+
+        TEST
+        (   "append() and += works for rune iterators correctly",
+            string String("🍌");
+            String.append(string("añb").runes());
+            EXPECT_EQUAL(String, "🍌añb");
+            String += string("xyz").runes().$ iterate<rune>
+            (   [](rune &Rune) { return Rune != 'y' ? optional<rune>(Rune) : optional<rune>(); }
+            );
+            EXPECT_EQUAL(String, "🍌añbxz");
+            String.append(iterator<rune>(string("!?").runes()));
+            EXPECT_EQUAL(String, "🍌añbxz!?");
+        );
     );
 
     TEST
@@ -870,6 +1243,30 @@ void test__core__string()
 
             EXPECT_EQUAL(compare(string("zoo"), string("zo_")), False);
         );
+
+        TEST
+        (   "sorting by collation keys matches sorting with operator <",
+            string::locale("en_US.utf8");
+            array<string> Array({"zoo", "apple", "beak", "Astrology", "eagle", "år", "best", "East", "Ängel"});
+            array<string> Sorted = Array;
+            Sorted.sort();
+            EXPECT_EQUAL(Array.sortByCollation(), Sorted);
+            for (const string &A : Array.values())
+            {   for (const string &B : Array.values())
+                {   EXPECT_EQUAL(A.collationKey() < B.collationKey(), A < B);
+                }
+            }
+            EXPECT_EQUAL(string("").collationKey(), std::string());
+        );
+
+        TEST
+        (   "sorting with stringAsciiCompare sorts by bytes",
+            array<string> Array({"zoo", "apple", "år", "Beak"});
+            EXPECT_EQUAL
+            (   Array.sort(stringAsciiCompare()),
+                array<string>({"Beak", "apple", "zoo", "år"})
+            );
+        );
     );
 
     TEST
@@ -895,6 +1292,23 @@ void test__core__string()
             EXPECT_EQUAL(String.contains(string("4567")), False);
             EXPECT_EQUAL(String.contains(string("helloworld")), False);
         );
+
+        TEST
+        (   "stringView::contains only searches inside of the view",
+            string String("asdf🍌1234hello567world ! and then a much longer tail to search through");
+            stringView View = String.slice(4, 16);
+            EXPECT_EQUAL(View, "🍌1234hello56");
+            EXPECT_EQUAL(View.contains("hello"), True);
+            EXPECT_EQUAL(View.contains("🍌"), True);
+            EXPECT_EQUAL(View.contains("asdf"), False);
+            EXPECT_EQUAL(View.contains("567"), False);
+            EXPECT_EQUAL(View.contains(""), True);
+            EXPECT_EQUAL(View.contains(string("1234")), True);
+            EXPECT_EQUAL(View.contains(String.slice(10, 13)), True);
+            EXPECT_EQUAL(View.contains(String.slice(String.count() - 4, String.count() - 1)), False);
+            EXPECT_EQUAL(String.contains(String.slice(String.count() - 30, String.count() - 10)), True);
+            EXPECT_EQUAL(String.contains("tail to search throughs"), False);
+        );
     );
 
     TEST
@@ -1155,7 +1569,10 @@ void test__core__string()
                 EXPECT_EQUAL(*SplitIterator.next(), "b");
                 EXPECT_EQUAL(*SplitIterator.next(), "cd");
                 EXPECT_EQUAL(*SplitIterator.next(), "e");
+                EXPECT_EQUAL(SplitIterator.remainingCount().AtLeast, 1);
+                EXPECT_EQUAL(SplitIterator.remainingCount().AtMost, 1);
                 EXPECT_EQUAL(*SplitIterator.next(), "");
+                EXPECT_EQUAL(SplitIterator.remainingCount().exact(), True);
                 ASSERT(SplitIterator.next() == Null);
             );
 
@@ -1212,6 +1629,40 @@ void test__core__string()
                 array<stringView> SplitArray = String.view().split(0);
                 EXPECT_EQUAL(SplitArray, array<const char *>({"", "a", "b", "", "🍌", ""}));
             );
+
+            TEST
+            (   "split on any of several runes",
+                string String("alpha beta,\tgamma🍌delta水 ßepsilon,");
+                array<stringView> SplitArray = String.view().split({' ', ',', '\t', 127820, 27700});
+                EXPECT_EQUAL
+                (   SplitArray,
+                    array<const char *>({"alpha", "beta", "", "gamma", "delta", "", "ßepsilon", ""})
+                );
+                // Runes that share a first byte with a delimiter aren't split on:
+                String = "a水b氵c";
+                SplitArray = String.view().split({27700});
+                EXPECT_EQUAL(SplitArray, array<const char *>({"a", "b氵c"}));
+                String = "no delimiters here, really none";
+                SplitArray = String.view().split({'|', ';'});
+                EXPECT_EQUAL(SplitArray, array<const char *>({"no delimiters here, really none"}));
+                String = "";
+                SplitArray = String.view().split({'|', ';'});
+                EXPECT_EQUAL(SplitArray, array<const char *>({""}));
+            );
+
+            TEST
+            (   "split on a substring",
+                string String("a, b,, c, , d, ");
+                array<stringView> SplitArray = String.view().split(string(", "));
+                EXPECT_EQUAL(SplitArray, array<const char *>({"a", "b,", "c", "", "d", ""}));
+                SplitArray = String.slice(3, 9).split(String.slice(1, 3));
+                EXPECT_EQUAL(SplitArray, array<const char *>({"b,", "c,"}));
+                SplitArray = String.view().split("");
+                EXPECT_EQUAL(SplitArray, array<const char *>({"a, b,, c, , d, "}));
+                String = "🍌🍌🍌🍌🍌";
+                SplitArray = String.view().split("🍌🍌");
+                EXPECT_EQUAL(SplitArray, array<const char *>({"", "", "🍌"}));
+            );
         );
 
         TEST
@@ -1904,8 +2355,8 @@ void test__core__string()
                     EXPECT_EQUAL(StringView.shiftReal(determining(Float)), True);
 
                     EXPECT_EQUAL(Float, 123.45);
-                    // TODO: we could try to change our algorithm to be better here:
-                    ASSERT(Float == float(123.4500045776));
+                    // Correctly rounded, i.e., the nearest float:
+                    ASSERT(Float == 123.45f);
                     EXPECT_EQUAL(StringView, ".");
                     EXPECT_EQUAL(String, "+123.45.");
                 );
@@ -1950,8 +2401,8 @@ void test__core__string()
 
                     EXPECT_EQUAL(Float, -123.45);
                     // Ensure that equality is really a given here:
-                    // TODO: we could try to change our algorithm to be better here:
-                    ASSERT(Float == float(-123.4500045776));
+                    // Correctly rounded, i.e., the nearest float:
+                    ASSERT(Float == -123.45f);
                     EXPECT_EQUAL(StringView, ".");
                     EXPECT_EQUAL(String, "-123.45.");
                 );
@@ -2303,6 +2754,407 @@ void test__core__string()
         );
     );
 
+    TEST
+    (   "string can live in a memory::resource",
+        memory::arena Arena(1024);
+        string Scratch(Arena);
+        EXPECT_EQUAL(&Scratch.resource(), (memory::resource *)&Arena);
+        Scratch += "long enough to not fit in a small string";
+        EXPECT_EQUAL(Arena.bytesUsed() > 0, True);
+        EXPECT_EQUAL(Scratch.view().count(), 40);
+
+        // Copies go on the heap so they can outlive the arena:
+        string Copy = Scratch;
+        EXPECT_EQUAL(&Copy.resource(), &memory::heap());
+        EXPECT_EQUAL(Copy, Scratch);
+
+        // Assigning keeps the arena:
+        Scratch = string("hello there, this is another long string");
+        EXPECT_EQUAL(&Scratch.resource(), (memory::resource *)&Arena);
+        EXPECT_EQUAL(Scratch, "hello there, this is another long string");
+
+        string FromView(Copy.view(), Arena);
+        EXPECT_EQUAL(&FromView.resource(), (memory::resource *)&Arena);
+        EXPECT_EQUAL(FromView, Copy);
+        EXPECT_EQUAL(std::hash<string>()(FromView), std::hash<string>()(Copy));
+    );
+
+    TEST
+    (   "string copies share long strings and keep short ones inline",
+        const string Line = "BunkerGuard1: I wouldn't go down there if I were you, traveler.";
+        memory::allocationTracker *Tracker = memory::allocationTracker::get();
+        memory::allocationTracker::enable();
+        Tracker->clear();
+        array<string> Commands;
+        Commands.reserve(10);
+        for (int I = 0; I < 10; ++I)
+        {   Commands.append(Line);
+        }
+        string Short = "Rummaging";
+        string ShortCopy = Short;
+        const index CopyAllocations = Tracker->stats("string").Allocations;
+        Commands[3] += "!";
+        const index ChangeAllocations = Tracker->stats("string").Allocations - CopyAllocations;
+        memory::allocationTracker::enable(False);
+
+        EXPECT_EQUAL(CopyAllocations, 0);
+        EXPECT_EQUAL(ChangeAllocations, 1);
+        EXPECT_EQUAL(Commands[3].count(), Line.count() + 1);
+        EXPECT_EQUAL(Commands[4], Line);
+        EXPECT_EQUAL(ShortCopy, "Rummaging");
+    );
+
+    TEST
+    (   "string copies only copy the bytes and rune count, even after rune-indexed lookups",
+        string Text;
+        for (int I = 0; I < 100; ++I)
+        {   Text += "Grüße, 旅人! ";
+        }
+        EXPECT_EQUAL(Text.slice(990, 993), "Grü");
+        EXPECT_EQUAL(Text.runeOfByte(Text.countBytes()), 1100);
+        memory::allocationTracker *Tracker = memory::allocationTracker::get();
+        memory::allocationTracker::enable();
+        Tracker->clear();
+        string Copy = Text;
+        string Assigned;
+        Assigned = Text;
+        const index Allocations = Tracker->totals().Allocations;
+        memory::allocationTracker::enable(False);
+
+        EXPECT_EQUAL(Allocations, 0);
+        EXPECT_EQUAL(Copy.count(), 1100);
+        EXPECT_EQUAL(Assigned.runeAt(991), 'r');
+    );
+
+    TEST
+    (   "string keeps its rune count up to date",
+        string String = "Straße";
+        EXPECT_EQUAL(String.count(), 6);
+        String += rune(0x1F34C);
+        String += 'x';
+        EXPECT_EQUAL(String.count(), 8);
+        String += string("水1");
+        EXPECT_EQUAL(String.count(), 10);
+        EXPECT_EQUAL(String.pop(), '1');
+        EXPECT_EQUAL(String.pop(), 0x6C34);
+        EXPECT_EQUAL(String.count(), 8);
+        EXPECT_EQUAL(String.count(), String.view().count());
+
+        string Tripled = string("ß!") * 3;
+        EXPECT_EQUAL(Tripled.count(), 6);
+        string Moved = std::move(Tripled);
+        EXPECT_EQUAL(Moved.count(), 6);
+        EXPECT_EQUAL(Tripled.count(), 0);
+        Tripled += "ab";
+        EXPECT_EQUAL(Tripled.count(), 2);
+        EXPECT_EQUAL(string(rune(0x6C34)).count(), 1);
+
+        // A string ending in the middle of a utf8 sequence gets recounted:
+        string Truncated = "a";
+        EXPECT_EQUAL(Truncated.count(), 1);
+        Truncated += string(std::string("\xE6\xB0"));
+        EXPECT_EQUAL(Truncated.countBytes(), 3);
+        Truncated += string(std::string("\xB4"));
+        EXPECT_EQUAL(Truncated.count(), 2);
+        EXPECT_EQUAL(Truncated, "a水");
+
+        stringView View = String.view();
+        EXPECT_EQUAL(View.count(), 8);
+        View.shift();
+        EXPECT_EQUAL(View.count(), 7);
+        View.pop();
+        EXPECT_EQUAL(View.count(), 6);
+    );
+
+    TEST
+    (   "string::count() matches a recount after malformed appends and pops",
+        const string Malformed(std::string("\xff\xa0"));
+        string String("x");
+        String.append(Malformed);
+        EXPECT_EQUAL(String.count(), string(String.view()).count());
+        String.pop();
+        EXPECT_EQUAL(String.countBytes(), 1);
+        EXPECT_EQUAL(String.count(), string(String.view()).count());
+        for (int I = 0; I < 3; ++I)
+        {   String.append(string("水"));
+            String.append(Malformed);
+            String += "ß";
+            EXPECT_EQUAL(String.count(), string(String.view()).count());
+        }
+        while (!String.empty())
+        {   String.pop();
+            EXPECT_EQUAL(String.count(), string(String.view()).count());
+        }
+    );
+
+    TEST
+    (   "string rune-indexed lookups",
+        string Text;
+        for (int I = 0; I < 100; ++I)
+        {   Text += "ab水🍌";
+        }
+        EXPECT_EQUAL(Text.count(), 400);
+        // Each "ab水🍌" is 2 + 3 + 4 bytes:
+        EXPECT_EQUAL(Text.byteOfRune(0), 0);
+        EXPECT_EQUAL(Text.byteOfRune(3), 5);
+        EXPECT_EQUAL(Text.byteOfRune(4 * 70 + 2), 9 * 70 + 2);
+        EXPECT_EQUAL(Text.byteOfRune(400), Text.countBytes());
+        EXPECT_EQUAL(Text.byteOfRune(1000), Text.countBytes());
+        EXPECT_EQUAL(Text.runeOfByte(9 * 70 + 2), 4 * 70 + 2);
+        // A byte inside of a rune belongs to that rune:
+        EXPECT_EQUAL(Text.runeOfByte(9 * 70 + 3), 4 * 70 + 2);
+        EXPECT_EQUAL(Text.runeOfByte(Text.countBytes()), 400);
+
+        EXPECT_EQUAL(Text.runeAt(2), 0x6C34);
+        EXPECT_EQUAL(Text.runeAt(4 * 99 + 3), 0x1F34C);
+        EXPECT_EQUAL(Text.runeAt(-4), 'a');
+        EXPECT_EQUAL(Text.runeAt(400), 0);
+        EXPECT_EQUAL(Text.runeAt(-401), 0);
+        EXPECT_EQUAL(Text.slice(398, 1000), "水🍌");
+        EXPECT_EQUAL(Text.slice(5, 3), "");
+        for (index Rune = 0; Rune < 400; Rune += 7)
+        {   stringView Naive = Text.view();
+            for (index I = 0; I < Rune; ++I)
+            {   Naive.shift();
+            }
+            EXPECT_EQUAL(Text.runeAt(Rune), Naive.first());
+        }
+
+        // Lookups see appends and pops:
+        Text.pop();
+        Text.pop();
+        Text += "xyz";
+        EXPECT_EQUAL(Text.runeAt(398), 'x');
+        EXPECT_EQUAL(Text.slice(396, 401), "abxyz");
+        EXPECT_EQUAL(Text.count(), 401);
+
+        stringView View = Text.slice(100, 200);
+        EXPECT_EQUAL(View.count(), 100);
+        EXPECT_EQUAL(View.runeAt(0), 'a');
+        EXPECT_EQUAL(View.runeAt(-1), 0x1F34C);
+        EXPECT_EQUAL(View.runeAt(100), 0);
+        EXPECT_EQUAL(View.slice(1, 3), "b水");
+        EXPECT_EQUAL(View.slice(98, 500), "水🍌");
+    );
+
+    TEST_BENCHMARK
+    (   "copying dialogue lines into draw commands, std::string vs. string",
+        const index Commands = 200000;
+        const char *Lines[3];
+        Lines[0] = "BunkerGuard1: I wouldn't go down there if I were you, traveler.";
+        Lines[1] = "Rummaging";
+        Lines[2] = "The guard pulls out a sword-axe and looks at you expectantly.";
+        std::vector<std::string> StdCommands;
+        array<string> Strings;
+        StdCommands.reserve(Commands);
+        Strings.reserve(Commands);
+        std::string StdLines[3];
+        string OurLines[3];
+        for (int I = 0; I < 3; ++I)
+        {   StdLines[I] = Lines[I];
+            OurLines[I] = Lines[I];
+        }
+        dbl StdSeconds = test::secondsToRun
+        (   [&]()
+            {   for (index I = 0; I < Commands; ++I)
+                {   StdCommands.push_back(StdLines[I % 3]);
+                }
+            }
+        );
+        dbl StringSeconds = test::secondsToRun
+        (   [&]()
+            {   for (index I = 0; I < Commands; ++I)
+                {   Strings.append(OurLines[I % 3]);
+                }
+            }
+        );
+        LOG(Commands << " copies: std::string " << StdSeconds << "s, string " << StringSeconds << "s");
+        EXPECT_EQUAL(Strings[-1], StdCommands.back().c_str());
+    );
+
+    TEST_BENCHMARK
+    (   "splitting a long chat log into fields, rune by rune vs. split on any delimiter",
+        string Log;
+        for (int I = 0; I < 20000; ++I)
+        {   Log += "12:01\ttraveler\tGrüße, 旅人! How's the road ahead, and how far is it to the next inn?\n";
+        }
+        index RuneTokens = 0;
+        dbl RuneSeconds = test::secondsToRun
+        (   [&]()
+            {   stringView View = Log.view();
+                index TokenBytes = 0;
+                while (!View.empty())
+                {   const rune Rune = View.shift();
+                    if (Rune == '\t' || Rune == '\n')
+                    {   RuneTokens += TokenBytes > 0;
+                        TokenBytes = 0;
+                    }
+                    else
+                    {   ++TokenBytes;
+                    }
+                }
+                RuneTokens += TokenBytes > 0;
+            }
+        );
+        index SplitTokens = 0;
+        dbl SplitSeconds = test::secondsToRun
+        (   [&]()
+            {   for (stringView Token : Log.view().split({'\t', '\n'}))
+                {   SplitTokens += !Token.empty();
+                }
+            }
+        );
+        LOG
+        (   Log.countBytes() << " bytes into " << SplitTokens << " fields: rune by rune "
+                    << RuneSeconds << "s, split " << SplitSeconds << "s"
+        );
+        EXPECT_EQUAL(SplitTokens, RuneTokens);
+    );
+
+    TEST_BENCHMARK
+    (   "rune counts while laying out a long dialogue line",
+        string Line;
+        for (int I = 0; I < 200; ++I)
+        {   Line += "Grüße, 旅人! ";
+        }
+        const index RuneCount = Line.view().count();
+        const int Layouts = 2000;
+        index Total = 0;
+        dbl RecountSeconds = test::secondsToRun
+        (   [&]()
+            {   for (int Layout = 0; Layout < Layouts; ++Layout)
+                {   // A fresh view of the bytes, like the old O(N) count:
+                    stringView View = Line.view();
+                    View.shift();
+                    Total += View.count() + 1;
+                }
+            }
+        );
+        dbl CachedSeconds = test::secondsToRun
+        (   [&]()
+            {   for (int Layout = 0; Layout < Layouts; ++Layout)
+                {   Total += Line.count();
+                }
+            }
+        );
+        LOG
+        (   Layouts << " counts of a " << RuneCount << " rune line: recounting " << RecountSeconds
+                    << "s, string::count " << CachedSeconds << "s"
+        );
+        EXPECT_EQUAL(Total, 2 * Layouts * RuneCount);
+    );
+
+    TEST_BENCHMARK
+    (   "formatting a frame's scores, coordinates, and timers, via a stream vs. string::of",
+        const int Frames = 20000;
+        index StreamBytes = 0;
+        index FormatBytes = 0;
+        dbl StreamSeconds = test::secondsToRun
+        (   [&]()
+            {   for (int Frame = 0; Frame < Frames; ++Frame)
+                {   std::ostringstream Stream;
+                    Stream.imbue(std::locale("C"));
+                    Stream << Frame * 25 << ' ' << Frame * 0.5f << ' ' << -Frame * 0.25 << ' ' << Frame / 60.0;
+                    StreamBytes += Stream.str().size();
+                }
+            }
+        );
+        dbl FormatSeconds = test::secondsToRun
+        (   [&]()
+            {   for (int Frame = 0; Frame < Frames; ++Frame)
+                {   string Line = string::of(Frame * 25);
+                    Line += " ";
+                    Line.appendNumber(Frame * 0.5f);
+                    Line += " ";
+                    Line.appendNumber(-Frame * 0.25);
+                    Line += " ";
+                    Line.appendNumber(Frame / 60.0);
+                    FormatBytes += Line.countBytes();
+                }
+            }
+        );
+        LOG(Frames << " frames: stream " << StreamSeconds << "s, string::of " << FormatSeconds << "s");
+        // Timers have more digits when they round-trip, rather than 6 significant digits.
+        EXPECT_EQUAL(FormatBytes >= StreamBytes, True);
+    );
+
+    TEST_BENCHMARK
+    (   "loading a level's tile rows, via a stream vs. stringView::numbers",
+        const int Width = 256;
+        const int Rows = 200;
+        string Level;
+        for (int Row = 0; Row < Rows; ++Row)
+        {   for (int Column = 0; Column < Width; ++Column)
+            {   if (Column > 0)
+                {   Level += ",";
+                }
+                Level.appendNumber((Row * 31 + Column * 7) % 1000);
+            }
+            Level += "\n";
+        }
+        array<i32> Tiles;
+        Tiles.count(Width);
+        i64 StreamSum = 0;
+        i64 ParseSum = 0;
+        dbl StreamSeconds = test::secondsToRun
+        (   [&]()
+            {   std::istringstream Stream(Level.chars());
+                Stream.imbue(std::locale("C"));
+                std::string Line;
+                while (std::getline(Stream, Line))
+                {   std::istringstream Values(Line);
+                    i32 Tile;
+                    char Comma;
+                    for (int Column = 0; Column < Width; ++Column)
+                    {   Values >> Tile;
+                        Values >> Comma;
+                        StreamSum += Tile;
+                    }
+                }
+            }
+        );
+        dbl ParseSeconds = test::secondsToRun
+        (   [&]()
+            {   for (stringView Line : Level.view().split('\n'))
+                {   if (!Line.empty() && Line.numbers(',', Tiles.view()))
+                    {   for (i32 Tile : Tiles.values())
+                        {   ParseSum += Tile;
+                        }
+                    }
+                }
+            }
+        );
+        LOG(Rows << " rows of " << Width << " tiles: stream " << StreamSeconds << "s, stringView::numbers " << ParseSeconds << "s");
+        EXPECT_EQUAL(ParseSum, StreamSum);
+    );
+
+    TEST_BENCHMARK
+    (   "sorting 100k names, with operator < vs. collation keys vs. bytes",
+        string::locale("en_US.utf8");
+        array<string> Syllables({"an", "Bo", "ré", "ka", "Ös", "li", "ma", "Ån", "tu", "Zi", "el", "ñu"});
+        array<string> Names;
+        u64 Random = 12345;
+        for (int I = 0; I < 100000; ++I)
+        {   string Name;
+            for (int Syllable = 0; Syllable < 4; ++Syllable)
+            {   Random = Random * 6364136223846793005ULL + 1442695040888963407ULL;
+                Name += Syllables[(Random >> 33) % Syllables.count()];
+            }
+            Names.append(std::move(Name));
+        }
+        array<string> ByOperator = Names;
+        array<string> ByKey = Names;
+        array<string> ByBytes = Names;
+        dbl OperatorSeconds = test::secondsToRun([&]() { ByOperator.sort(); });
+        dbl KeySeconds = test::secondsToRun([&]() { ByKey.sortByCollation(); });
+        dbl BytesSeconds = test::secondsToRun([&]() { ByBytes.sort(stringAsciiCompare()); });
+        LOG
+        (   Names.count() << " names: operator < " << OperatorSeconds << "s, collation keys "
+                    << KeySeconds << "s, stringAsciiCompare " << BytesSeconds << "s"
+        );
+        EXPECT_EQUAL(ByKey, ByOperator);
+    );
+
     // TODO: string + string doesn't affect other string
     
     /* TODO
@@ -2426,5 +3278,11 @@ void test__core__string()
 TMVB
 
 std::size_t std::hash<bvmt::string>::operator() (const bvmt::string& String) const {
-    return hash<std::string>()(String.Internal);
+    return hash<std::string_view>()(std::string_view(String.Internal));
+}
+
+std::size_t std::hash<bvmt::stringView>::operator() (const bvmt::stringView& StringView) const {
+    return hash<std::string_view>()
+    (   std::string_view(StringView.Source->Internal.data() + StringView.StartByte, StringView.countBytes())
+    );
 }
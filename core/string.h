@@ -1,12 +1,21 @@
 #pragma once
 
 #include "arg.h"
+#include "array.h"
 #include "error.h"
+#include "format.h"
 #include "iterator.h"
+#include "memory.h"
+#include "parse.h"
+#include "string-buffer.h"
 #include "types.h"
+#include "utf8.h"
 
+#include <algorithm> // std::min
+#include <initializer_list>
 #include <sstream> 
 #include <string>
+#include <string_view>
 
 #define ASSERT_STRING(X, y) ASSERT_THIS(bvmt::string(X), y)
 
@@ -91,14 +100,17 @@ class stringAsciiCompare;
     {   return enclose('<', T, '>'); \
     }
 
-// TODO: maybe switch string to using a localArray to see if it "speeds things up".
-// probably best to use `stringLocal` and see if that works in every use-case.
-// we probably want something like localArray<u8, u16 (alloc)> which switches over
-// to a real string if it goes past max alloc.  maybe we can build this into localArray;
-// e.g., if the size is too big, then use a pointer to the data array, with two index (i64)
-// values allocated before it for size and alloc.
+// Short strings are stored inline, and copies of long strings share their bytes
+// until one of them changes; see `stringBuffer`.
 class string
-{   std::string Internal;
+{   stringBuffer Internal;
+    // The number of runes in `Internal`, kept up to date as runes are appended/popped,
+    // or -1 if it has to be counted, i.e., for invalid utf8.  Never written by const methods,
+    // so that many threads can read the same string.
+    index RuneCount = -1;
+    // Bumped whenever the bytes change (also only by non-const methods), so that a
+    // `runeIndex` can tell when its checkpoints are stale.
+    index Version = 0;
 public:
     // sets the locale to the passed in value, e.g., "en_US.utf8".
     static void locale(const char *Chars);
@@ -107,12 +119,31 @@ public:
     string(std::string String);
     explicit string(rune Rune);
     string(stringView StringView);
+    // A string whose bytes live in `Resource` (e.g., an arena) instead of the heap.
+    // It keeps using `Resource` when assigned to, but copies of it go on the heap.
+    explicit string(memory::resource &Resource);
+    string(stringView StringView, memory::resource &Resource);
 
+    string(const string &String) = default;
+    string &operator = (const string &String);
+    // Moved-from strings are left empty, so that their rune count stays correct.
+    string(string &&String) noexcept;
+    string &operator = (string &&String);
+
+    memory::resource &resource() const;
+
+    // Numbers are written via `format::write` (shortest round-tripping digits for floats),
+    // other types via a stream; character types are written as characters, like a stream does.
     template <class t>
     static string of(t Value)
     {   if constexpr (type<t>::$ equals<string>())
         {   return Value;
         }
+        else if constexpr (format::number<t>)
+        {   string Result;
+            Result.appendNumber(Value);
+            return Result;
+        }
         else
         {   std::ostringstream Stream;
             Stream.imbue(std::locale("C"));
@@ -121,6 +152,13 @@ public:
         }
     }
 
+    template <class t>
+    static string of(t Value, const format::options &Options)
+    {   string Result;
+        Result.appendNumber(Value, Options);
+        return Result;
+    }
+
     stringView view() const &;
 
     bool empty() const;
@@ -129,11 +167,28 @@ public:
 
     void append(rune Rune) &;
     void append(const string &String) &;
-    // TODO: add append(iterator<rune> &&)
+    // Appends all runes from the iterator, reserving space from its `remainingCount` first.
+    void append(iterator<rune> &&Runes) &;
+    // Appends `Value` without going through a stream or allocating (beyond growing the string).
+    template <class t>
+    void appendNumber(t Value, const format::options &Options = {}) &
+    {   char Buffer[format::MaxBytes];
+        const index Count = format::write(Buffer, format::MaxBytes, Value, Options);
+        if (Count < 0)
+        {   LOG_ERR("couldn't format a number into " << format::MaxBytes << " bytes");
+            return;
+        }
+        appendAscii(Buffer, Count);
+    }
+    template <class kernel>
+    void append(staticIterator<rune, kernel> &&Runes) &
+    {   reserve(countBytes() + Runes.remainingCount().AtLeast);
+        ITERATOR_BATCH_LOOP(Runes, rune, Rune, append(Rune))
+    }
 
     template <class t>
     inline string &operator += (t T)
-    {   append(T);
+    {   append(std::move(T));
         return *this;
     }
 
@@ -152,16 +207,16 @@ public:
     rune pop();
 
     // Returns the size (in utf8 characters, i.e., runes) of the string.
-    // Note, this is not O(1).
-    // TODO: maybe make O(1) by determining rune size on init, keeping invariant up to date
-    // with append/pop/etc.
+    // This is O(1); strings constructed from bytes (e.g., a `char *`) are counted up front,
+    // unless they aren't well-formed utf8, in which case every call counts them.
     index count() const;
 
     // Reserves this many bytes for the string data.
     void reserve(index Bytes);
 
+    // Substring search, see `stringView::contains`.
     bool contains(const char *Substring) const;
-    // TODO: bool contains(const stringView &Substring) const;
+    bool contains(const stringView &Substring) const;
     bool contains(const string &Substring) const;
 
     bool operator == (const char *Other) const;
@@ -169,14 +224,36 @@ public:
     bool operator == (const string &Other) const;
     bool operator == (const stringView &Other) const;
 
+    // Compares via the global locale's `std::collate` facet, e.g., for sorting names
+    // (see `string::locale`); use `stringAsciiCompare` to compare bytes instead.
     bool operator < (const string &Other) const;
 
+    // The bytes (via the global locale's `std::collate::transform`) which compare as bytes,
+    // e.g., with std::string's `<`, in the same order that `operator <` compares strings.
+    // Computing one per string beats collating in every comparison when sorting many
+    // strings, see `array::sortByCollation`.
+    std::string collationKey() const;
+
     template <class t>
     inline bool operator != (t Other) const
     {   return !(This == Other);
     }
 
-    iterator<rune> runes() const;
+    staticIterator<rune, detail::stringIteratorKernel> runes() const;
+
+    // The byte where rune `RuneIndex` starts, e.g., for putting a caret before it,
+    // or `countBytes()` if it's past the end.  These rune-indexed lookups walk from the
+    // start of the string; for many of them, e.g., caret math in a text box, use a `runeIndex`.
+    index byteOfRune(index RuneIndex) const;
+    // The rune index of the rune starting at `Byte` (or containing it, if it's not a rune boundary).
+    index runeOfByte(index Byte) const;
+
+    // Returns the rune at `RuneIndex`, counting from the end if it's negative,
+    // or 0 if it's out of bounds.
+    rune runeAt(index RuneIndex) const;
+    // Returns a view of runes `StartRune` up to (not including) `EndRune`,
+    // which are clamped to the string.
+    stringView slice(index StartRune, index EndRune) const &;
 
     STRING_LIKE_H()
     STRING_LIKE_TEMPLATES()
@@ -184,21 +261,31 @@ public:
 // TODO: reset this to `protected:` after we switch to u8 arrays in server.h
     index countBytes() const;
 
+    // These parse a view of the whole string; see `stringView`, after which they're defined.
     template <class t>
-    bool integer(determining<t> Out) const &
-    {   return view().integer(Out); // TODO: avoid compiler warnings
-    }
-
+    bool integer(determining<t> Out) const &;
     template <class t>
-    bool real(determining<t> Out) const &
-    {   return view().real(Out); // TODO: avoid compiler warnings
-    }
+    bool real(determining<t> Out) const &;
+    template <class t>
+    bool numbers(char Delimiter, arrayView<t> Values) const &;
 
 private:
+    // True if appending bytes won't change how the existing bytes are split into runes,
+    // i.e., the string doesn't end in the middle of a utf8 sequence.
+    bool endsOnRuneBoundary() const;
+
+    // Updates `RuneCount` before appending `Runes` runes' worth of bytes.
+    void appendingRunes(index Runes);
+    // Appends `Count` ASCII bytes, i.e., one rune each.
+    void appendAscii(const char *Chars, index Count);
+
     friend stringAsciiCompare;
     friend stringView;
+    friend class runeIndex;
     friend class detail::stringIteratorKernel;
+    friend class detail::stringSplitIteratorKernel;
     friend class ::std::hash<bvmt::string>;
+    friend class ::std::hash<bvmt::stringView>;
     friend std::ostream &operator << (std::ostream &Out, const string &String);
 };
 
@@ -214,7 +301,8 @@ class stringView
 {   // TODO: switch to using std::basic_string_view for ease of algo, like contains() -> find()
     // TODO: or maybe switch to using a `const string *Internal` snapshot.
     // TODO: or maybe, like arrayView, this should be a generic `char *`.
-    const std::string *Internal;
+    // The string whose bytes this is a view of.
+    const string *Source;
     index StartByte;
     index EndByte;
 
@@ -258,12 +346,13 @@ public:
     stringView stripBack() &&;
 
     // Returns the size (in number of utf8 characters, i.e., runes) of what's in this string view.
-    // Note, this is not O(1).
+    // O(1) for a view of a whole string (see `string::count`); otherwise this counts the runes.
     index count() const;
 
-    // TODO: bool contains(const char *Substring) const;
-    // TODO: bool contains(const stringView &Substring) const;
-    // TODO: bool contains(const string &Substring) const;
+    // True if `Substring` is somewhere in this view; see `utf8::find` for how it searches.
+    bool contains(const char *Substring) const;
+    bool contains(const stringView &Substring) const;
+    bool contains(const string &Substring) const;
 
     bool operator == (const char *Other) const;
     bool operator == (const string &Other) const;
@@ -275,65 +364,46 @@ public:
     }
 
     // TODO: overloads for `runes() &` and `runes() &&`
-    iterator<rune> runes() const;
+    staticIterator<rune, detail::stringIteratorKernel> runes() const;
 
-    iterator<stringView> split(rune Split) const;
+    // Returns the rune at `RuneIndex` in this view, counting from the end if it's negative,
+    // or 0 if it's out of bounds.  Walks from the start of the view, see `string::byteOfRune`.
+    rune runeAt(index RuneIndex) const;
+    // Returns a view of runes `StartRune` up to (not including) `EndRune` of this view,
+    // which are clamped to this view.
+    stringView slice(index StartRune, index EndRune) const;
 
-    // Consumes the starting bytes if they are integer-like (0-9), updating the passed-in number.
+    // Iterates over the regions between each `Split` rune, including empty ones,
+    // e.g., "a::b" split on ':' gives "a", "", "b".
+    iterator<stringView> split(rune Split) const;
+    // Like `split(rune)` but splits on any of the `Splits` runes, e.g., `split({' ', '\t', '\n'})`.
+    // Candidates are found a block of bytes at a time (see `utf8::findAny`) rather than rune by rune.
+    iterator<stringView> split(std::initializer_list<rune> Splits) const;
+    // Splits on each (non-overlapping) occurrence of the substring `Split`, e.g., ", ".
+    // An empty `Split` doesn't split at all.
+    iterator<stringView> split(const string &Split) const;
+    iterator<stringView> split(const stringView &Split) const;
+
+    // Consumes the starting bytes if they are an integer, updating the passed-in number.
     // Returns true if this string started with an integer; if the whole stringView should be
     // a integer, use `integer` instead.  Does not update the passed-in number if this
-    // stringView was not an integer.  Also accepts a + or - prefix, the latter of course makes
-    // the passed-in number negative.  Also accepts binary strings that start with `0b`, e.g.,
-    // 0b110 is 6.
+    // stringView was not an integer, or if it doesn't fit into the passed-in number.
+    // Also accepts a + or - prefix, the latter of course makes the passed-in number negative.
+    // Also accepts binary after `0b` and hexadecimal after `0x`, e.g., 0b110 and 0x6 are 6,
+    // and underscores between digits, e.g., 1_000_000.  See `parse::integer`.
     template <class t>
     bool shiftInteger(determining<t> Out)
-    {   // TODO: check std::numeric_limits<t>::min()/max() to ensure we're in bounds
-        // will become non-null if we write to Out:
-        t *T = Null;
-        if (empty())
+    {   if (empty())
         {   return False;
         }
-        const index InitialStartByte = StartByte;
-        bool Negative = False;
-        i8 Byte = Internal->operator[](StartByte);
-        if (Byte == '-')
-        {   Negative = True;
-            ++StartByte;
-        }
-        else if (Byte == '+')
-        {   ++StartByte;
-        }
-        index Position = 0;
-        int Base = 10;
-        i8 MaxDigit = '9';
-        while (!empty())
-        {   Byte = Internal->operator[](StartByte);
-            if (Byte < '0' || Byte > MaxDigit)
-            {   if (Position == 1)
-                {   if (Byte == 'b')
-                    {   ++StartByte;
-                        Base = 2;
-                        MaxDigit = '1';
-                        continue;
-                    }
-                }
-                break;
-            }
-            ++Position;
-            if (T == Null)
-            {   T = &(Out = 0);
-            }
-            ++StartByte;
-            *T = *T * Base + (Byte - '0');
-        }
-        // In case we grabbed a leading + or - but found no subsequent digits:
-        if (T == Null)
-        {   StartByte = InitialStartByte;
-        }
-        else if (Negative)
-        {   *T *= -1;
+        t Value;
+        const index Bytes = parse::integer(Source->Internal.data() + StartByte, countBytes(), Value);
+        if (Bytes == 0)
+        {   return False;
         }
-        return T != Null;
+        Out = Value;
+        StartByte += Bytes;
+        return True;
     }
 
     // Consumes the full stringView if the stringView is just an integer, returning
@@ -367,73 +437,26 @@ public:
     }
 
     // Consumes the starting bytes if they are real-like ([0-9]+{.[0-9]*}?) with an optional
-    // prefix + or -, setting the passed-in pointer to the value if so.  If the whole
-    // stringView should be a real number, use `real` instead.  Will greedily accept "." and
-    // will ignore any second period.  E.g., "9.5.4" will become the float 9.5 and the remaining
-    // stringView will be ".4".  Note that the number (after any optional + or -) must
-    // start with a digit, so if there is no 1's digit, use "0." to start the decimal expansion.
-    // TODO: allow XeY where X and Y are decimals, and X has an optional period
+    // prefix + or - and an optional exponent (e.g., 1.5e-3), setting the passed-in pointer to
+    // the correctly rounded value if so.  If the whole stringView should be a real number,
+    // use `real` instead.  Will greedily accept "." and will ignore any second period.
+    // E.g., "9.5.4" will become the float 9.5 and the remaining stringView will be ".4".
+    // Note that the number (after any optional + or -) must start with a digit, so if there
+    // is no 1's digit, use "0." to start the decimal expansion.  Also accepts hexadecimal
+    // floats after `0x` and underscores between digits.  See `parse::real`.
     template <class t>
     bool shiftReal(determining<t> Out)
     {   if (empty())
         {   return False;
         }
-        const index InitialStartByte = StartByte;
-        t *T = Null;
-        bool FoundPeriod = False;
-        t Decimals = t(1);
-        bool Negative = False;
-        i8 Byte = Internal->operator[](StartByte);
-        if (Byte == '-')
-        {   Negative = True;
-            ++StartByte;
-        }
-        else if (Byte == '+')
-        {   ++StartByte;
-        }
-        while (!empty())
-        {   Byte = Internal->operator[](StartByte);
-            if (Byte < '0' || Byte > '9')
-            {   if (Byte == '.')
-                {   if (T == Null || FoundPeriod)
-                    {   // either (1) we haven't found a number digit yet,
-                        // or (2) we did and found a second period; either way, quit:
-                        break;
-                    }
-                    FoundPeriod = True;
-                    ++StartByte;
-                    continue;
-                }
-                else
-                {   break;
-                }
-            }
-            ++StartByte;
-            if (T == Null)
-            {   T = &(Out = 0);
-            }
-            if (FoundPeriod)
-            {   Decimals /= 10;
-                DEBUG_ONLY
-                (   if (Decimals == 0)
-                    {   LOG_ERR("numerical precision has been lost, too many digits past the decimal");
-                        // don't break, need to consume all number digits here.
-                    }
-                );
-                *T += Decimals * (Byte - '0');
-            }
-            else
-            {   *T = *T * 10 + (Byte - '0');
-            }
-        }
-        // In case we grabbed a leading + or - but found no subsequent digits:
-        if (T == Null)
-        {   StartByte = InitialStartByte;
-        }
-        else if (Negative)
-        {   *T *= -1;
+        t Value;
+        const index Bytes = parse::real(Source->Internal.data() + StartByte, countBytes(), Value);
+        if (Bytes == 0)
+        {   return False;
         }
-        return T != Null;
+        Out = Value;
+        StartByte += Bytes;
+        return True;
     }
 
     // Consumes the full stringView if the stringView is just a real, returning
@@ -466,6 +489,21 @@ public:
         return Copy.real(Out);
     }
 
+    // Parses this whole view as exactly `Values.count()` numbers separated by `Delimiter`
+    // (with optional whitespace around each), e.g., a row of tile ids "3, 4, 4, 7" into an
+    // array already sized to the level width, without allocating.  Returns False if this
+    // view is anything else, in which case some of `Values` may have been written.
+    template <class t>
+    bool numbers(char Delimiter, arrayView<t> Values) const
+    {   if (empty())
+        {   return Values.empty();
+        }
+        return parse::list
+        (   Source->Internal.data() + StartByte, countBytes(), Delimiter,
+            Values.empty() ? Null : &Values[0], Values.count()
+        );
+    }
+
     STRING_LIKE_H()
     STRING_LIKE_TEMPLATES()
 
@@ -479,13 +517,79 @@ private:
     u8 popByteNotEmpty();
 
     friend string;
+    friend class runeIndex;
     friend class detail::stringIteratorKernel; 
     friend class detail::stringSplitIteratorKernel;
+    friend class ::std::hash<bvmt::stringView>;
     friend std::ostream &operator << (std::ostream &Out, const stringView &StringView);
 };
 
 std::ostream &operator << (std::ostream &Out, const stringView &StringView);
 
+template <class t>
+bool string::integer(determining<t> Out) const &
+{   return view().integer(Out);
+}
+
+template <class t>
+bool string::real(determining<t> Out) const &
+{   return view().real(Out);
+}
+
+template <class t>
+bool string::numbers(char Delimiter, arrayView<t> Values) const &
+{   return view().numbers(Delimiter, Values);
+}
+
+namespace detail
+{   // Static kernel for `runes()`; see `staticIterator`.
+    // ASCII is decoded inline, other runes go through `stringView::shiftNotEmpty`.
+    class stringIteratorKernel
+    {   stringView StringView;
+    public:
+        stringIteratorKernel(stringView _StringView)
+        :   StringView(_StringView)
+        {}
+
+        inline optional<rune> next()
+        {   const index EndByte = std::min(StringView.EndByte, (index)StringView.Source->Internal.size());
+            if (StringView.StartByte >= EndByte)
+            {   return optional<rune>();
+            }
+            u8 Byte = (u8)StringView.Source->Internal[StringView.StartByte];
+            if (!(Byte & 128))
+            {   ++StringView.StartByte;
+                return optional<rune>(Byte);
+            }
+            return optional<rune>(StringView.shiftNotEmpty());
+        }
+
+        // Well-formed utf8 is bulk-decoded; anything else goes through `stringView::shiftNotEmpty`.
+        inline void nextBatch(iteratorBatch<rune> &Batch)
+        {   const index EndByte = std::min(StringView.EndByte, (index)StringView.Source->Internal.size());
+            const u8 *Bytes = (const u8 *)StringView.Source->Internal.data();
+            while (!Batch.full() && StringView.StartByte < EndByte)
+            {   utf8::decoded Decoded = utf8::decode
+                (   Bytes + StringView.StartByte, EndByte - StringView.StartByte,
+                    Batch.unfilled(), Batch.room()
+                );
+                StringView.StartByte += Decoded.Bytes;
+                Batch.appended(Decoded.Runes);
+                if (!Batch.full() && StringView.StartByte < EndByte)
+                {   Batch.append(StringView.shiftNotEmpty());
+                }
+            }
+        }
+
+        // Each rune is 1 to 4 bytes.
+        inline countHint remainingCount() const
+        {   const index EndByte = std::min(StringView.EndByte, (index)StringView.Source->Internal.size());
+            const index Bytes = std::max(EndByte - StringView.StartByte, (index)0);
+            return countHint({.AtLeast = (Bytes + 3) / 4, .AtMost = Bytes});
+        }
+    };
+}
+
 TMVB
 
 namespace std
@@ -493,4 +597,10 @@ namespace std
     struct hash<bvmt::string>
     {   std::size_t operator() (const bvmt::string& String) const;
     };
+
+    // Same as the hash of a `string` with the same bytes.
+    template <>
+    struct hash<bvmt::stringView>
+    {   std::size_t operator() (const bvmt::stringView& StringView) const;
+    };
 }
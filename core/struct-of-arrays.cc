@@ -0,0 +1,148 @@
+#include "struct-of-arrays.h"
+
+#ifndef NDEBUG
+#include "fixed-array.h"
+#include "string.h"
+#endif
+
+BVMT
+
+const char *const StructOfArraysIndexErrorMsg = "structOfArrays index is out of bounds";
+
+#ifndef NDEBUG
+namespace
+{   struct positionX { using type = dbl; };
+    struct positionY { using type = dbl; };
+    struct velocityX { using type = dbl; };
+    struct velocityY { using type = dbl; };
+    struct name { using type = string; };
+    // Stands in for everything else an entity has, which a movement pass doesn't need.
+    struct stats { using type = fixedArray<dbl, 12>; };
+
+    using namedPoints = structOfArrays<name, positionX, positionY>;
+    using movingEntities = structOfArrays<positionX, positionY, velocityX, velocityY, stats>;
+
+    struct movingEntity
+    {   dbl PositionX = 0.0;
+        dbl PositionY = 0.0;
+        dbl VelocityX = 0.0;
+        dbl VelocityY = 0.0;
+        fixedArray<dbl, 12> Stats;
+    };
+}
+
+void test__core__struct_of_arrays()
+{   TEST
+    (   "structOfArrays keeps its columns aligned",
+        namedPoints Points;
+        Points.append("a", 1.0, 10.0);
+        Points.append("b", 2.0, 20.0);
+        namedPoints::row Row = Points.append("c", 3.0, 30.0);
+        EXPECT_EQUAL(Row.Index, 2);
+        EXPECT_EQUAL(Row.get<name>(), "c");
+        EXPECT_EQUAL(Points.count(), 3);
+
+        arrayView<dbl> Xs = Points.column<positionX>();
+        EXPECT_EQUAL(Xs.count(), 3);
+        EXPECT_EQUAL(Xs[1], 2.0);
+        Xs[1] = 2.5;
+        EXPECT_EQUAL(Points[1].get<positionX>(), 2.5);
+        Points[-1].get<positionY>() = 33.0;
+        EXPECT_EQUAL(Points.column<positionY>()[2], 33.0);
+
+        Points.erase(0);
+        EXPECT_EQUAL(Points.count(), 2);
+        EXPECT_EQUAL(Points[0].get<name>(), "b");
+        EXPECT_EQUAL(Points[0].get<positionX>(), 2.5);
+        EXPECT_EQUAL(Points[1].get<positionY>(), 33.0);
+
+        Points.append("d", 4.0, 40.0);
+        Points.swapErase(0);
+        EXPECT_EQUAL(Points.count(), 2);
+        EXPECT_EQUAL(Points[0].get<name>(), "d");
+        EXPECT_EQUAL(Points[0].get<positionY>(), 40.0);
+        EXPECT_EQUAL(Points[1].get<name>(), "c");
+        Points.swapErase(-1);
+        EXPECT_EQUAL(Points.count(), 1);
+        EXPECT_EQUAL(Points[0].get<name>(), "d");
+
+        EXPECT_THROW(Points[1], StructOfArraysIndexErrorMsg);
+        EXPECT_THROW(Points.erase(-2), StructOfArraysIndexErrorMsg);
+    );
+
+    TEST
+    (   "structOfArrays can iterate over rows",
+        namedPoints Points;
+        Points.count(3);
+        EXPECT_EQUAL(Points[2].get<name>(), "");
+        for (namedPoints::row Row : Points.rows())
+        {   Row.get<name>() = string::of(Row.Index);
+            Row.get<positionX>() = Row.Index * 1.5;
+        }
+        const namedPoints &ConstPoints = Points;
+        index Count = 0;
+        for (namedPoints::constRow Row : ConstPoints.rows())
+        {   EXPECT_EQUAL(Row.get<name>(), string::of(Row.Index));
+            EXPECT_EQUAL(Row.get<positionX>(), Row.Index * 1.5);
+            ++Count;
+        }
+        EXPECT_EQUAL(Count, 3);
+        EXPECT_EQUAL(Points.rows().remainingCount().AtLeast, 3);
+
+        Points.clear();
+        EXPECT_EQUAL(Points.empty(), True);
+        EXPECT_EQUAL(Points.column<name>().count(), 0);
+    );
+
+    TEST_BENCHMARK
+    (   "position/velocity integration with array (AoS) vs. structOfArrays (SoA)",
+        const index EntityCount = 200000;
+        const int Frames = 50;
+        const dbl Dt = 1.0 / 60.0;
+        array<movingEntity> AoS;
+        movingEntities SoA;
+        AoS.reserve(EntityCount);
+        SoA.reserve(EntityCount);
+        for (index I = 0; I < EntityCount; ++I)
+        {   movingEntity &Entity = AoS.appendInPlace();
+            Entity.VelocityX = 0.001 * I;
+            Entity.VelocityY = -0.002 * I;
+            SoA.append(0.0, 0.0, 0.001 * I, -0.002 * I, fixedArray<dbl, 12>());
+        }
+
+        dbl AoSSeconds = test::secondsToRun
+        (   [&]()
+            {   arrayView<movingEntity> Entities = AoS.view();
+                for (int Frame = 0; Frame < Frames; ++Frame)
+                {   for (index I = 0; I < EntityCount; ++I)
+                    {   movingEntity &Entity = Entities[I];
+                        Entity.PositionX += Entity.VelocityX * Dt;
+                        Entity.PositionY += Entity.VelocityY * Dt;
+                    }
+                }
+            }
+        );
+        dbl SoASeconds = test::secondsToRun
+        (   [&]()
+            {   arrayView<dbl> Xs = SoA.column<positionX>();
+                arrayView<dbl> Ys = SoA.column<positionY>();
+                arrayView<dbl> VelocityXs = SoA.column<velocityX>();
+                arrayView<dbl> VelocityYs = SoA.column<velocityY>();
+                for (int Frame = 0; Frame < Frames; ++Frame)
+                {   for (index I = 0; I < EntityCount; ++I)
+                    {   Xs[I] += VelocityXs[I] * Dt;
+                        Ys[I] += VelocityYs[I] * Dt;
+                    }
+                }
+            }
+        );
+        LOG("AoS " << AoSSeconds << "s, SoA " << SoASeconds << "s");
+        for (index I = 0; I < EntityCount; I += 997)
+        {   EXPECT_EQUAL(SoA[I].get<positionX>(), AoS[I].PositionX);
+            EXPECT_EQUAL(SoA[I].get<positionY>(), AoS[I].PositionY);
+        }
+    );
+}
+#endif
+
+TMVB
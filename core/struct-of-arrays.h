@@ -0,0 +1,206 @@
+#pragma once
+
+#include "array.h"
+#include "error.h"
+#include "iterator.h"
+#include "types.h"
+
+#include <tuple>
+#include <type_traits>
+#include <utility>      // std::index_sequence
+
+BVMT
+
+extern const char *const StructOfArraysIndexErrorMsg;
+
+namespace soaDetail
+{   // Index of `field` in `fields...`, which must contain it exactly once.
+    template <class field, class... fields>
+    constexpr index fieldIndex()
+    {   constexpr bool Matches[] = {std::is_same_v<field, fields>...};
+        index Result = -1;
+        for (index I = 0; I < (index)sizeof...(fields); ++I)
+        {   if (Matches[I])
+            {   if (Result >= 0)
+                {   return -2;
+                }
+                Result = I;
+            }
+        }
+        return Result;
+    }
+
+    // A proxy for one row of a `structOfArrays`, which (like `array::element`) knows its
+    // `Index` and gives access to each field's value, e.g., `Row.get<positionX>()`.
+    // Like any reference into an array, it shouldn't be held across changes to the row count.
+    template <class soaPointer>
+    class row
+    {   soaPointer Soa;
+    public:
+        const index Index;
+
+        row(soaPointer _Soa, index _Index)
+        :   Soa(_Soa), Index(_Index)
+        {}
+
+        template <class field>
+        inline auto &get() const
+        {   return Soa->template column<field>()[Index];
+        }
+    };
+
+    template <class soaPointer>
+    std::ostream &operator << (std::ostream &Out, const row<soaPointer> &Row)
+    {   return Out << "structOfArrays::row(" << Row.Index << ")";
+    }
+
+    // Static kernel for `structOfArrays::rows()`; see `staticIterator`.
+    template <class soaPointer>
+    class rowIteratorKernel
+    {   index Index = -1;
+        soaPointer Soa;
+    public:
+        rowIteratorKernel(soaPointer _Soa)
+        :   Soa(_Soa)
+        {}
+
+        inline optional<row<soaPointer>> next()
+        {   if (Index + 1 >= Soa->count())
+            {   return optional<row<soaPointer>>();
+            }
+            return optional<row<soaPointer>>(row<soaPointer>(Soa, ++Index));
+        }
+
+        inline countHint remainingCount() const
+        {   return countHint::exactly(Soa->count() - (Index + 1));
+        }
+    };
+}
+
+// A structure of arrays: instead of an `array` of structs, each field gets its own
+// contiguous column, so that a pass which only touches a few fields (e.g., integrating
+// positions from velocities) doesn't pull the other fields through the cache,
+// and each column can be handed to a (SIMD-friendly) loop as a plain `arrayView`.
+// Fields are declared as types with a `type` member, e.g.:
+//     struct positionX { using type = dbl; };
+//     struct velocityX { using type = dbl; };
+//     structOfArrays<positionX, velocityX> Entities;
+//     Entities.append(0.0, 1.5);
+//     arrayView<dbl> PositionXs = Entities.column<positionX>();
+// All columns always have the same count.
+template <class... fields>
+class structOfArrays
+{   static_assert(sizeof...(fields) > 0, "structOfArrays needs at least one field");
+
+    std::tuple<array<typename fields::type>...> Columns;
+
+    template <class field>
+    static constexpr index fieldIndex()
+    {   constexpr index Result = soaDetail::fieldIndex<field, fields...>();
+        static_assert(Result != -1, "field is not in this structOfArrays");
+        static_assert(Result != -2, "field is in this structOfArrays more than once");
+        return Result;
+    }
+
+public:
+    using row = soaDetail::row<structOfArrays *>;
+    using constRow = soaDetail::row<const structOfArrays *>;
+    typedef staticIterator<row, soaDetail::rowIteratorKernel<structOfArrays *>> rowsIterator;
+    typedef staticIterator<constRow, soaDetail::rowIteratorKernel<const structOfArrays *>> constRowsIterator;
+
+    structOfArrays() {}
+
+    // The contiguous values of `field` for every row.
+    template <class field>
+    inline arrayView<typename field::type> column() &
+    {   return std::get<fieldIndex<field>()>(Columns).view();
+    }
+
+    template <class field>
+    inline arrayView<const typename field::type> column() const &
+    {   return std::get<fieldIndex<field>()>(Columns).view();
+    }
+
+    inline index count() const
+    {   return std::get<0>(Columns).count();
+    }
+
+    inline bool empty() const
+    {   return count() == 0;
+    }
+
+    // Adds or removes rows at the end; new rows have default values in every column.
+    void count(index ResizeTo)
+    {   std::apply([ResizeTo](auto &... Column) { (Column.count(ResizeTo), ...); }, Columns);
+    }
+
+    void reserve(index Count)
+    {   std::apply([Count](auto &... Column) { (Column.reserve(Count), ...); }, Columns);
+    }
+
+    // Removes all rows but does not reclaim any memory.
+    void clear()
+    {   std::apply([](auto &... Column) { (Column.clear(), ...); }, Columns);
+    }
+
+    // Adds a row with a value for each field, in the order that the fields were declared.
+    row append(typename fields::type... Values)
+    {   appendColumns(std::index_sequence_for<fields...>(), std::move(Values)...);
+        return row(this, count() - 1);
+    }
+
+    // Erases the row at `Index`, keeping the order of the rows after it.
+    void erase(index Index)
+    {   Index = checkIndex(Index);
+        std::apply([Index](auto &... Column) { (Column.erase(Index), ...); }, Columns);
+    }
+
+    // Erases the row at `Index` by moving the last row into its place, which is O(1)
+    // (per column) but doesn't keep the order of the rows.
+    void swapErase(index Index)
+    {   Index = checkIndex(Index);
+        const index Last = count() - 1;
+        std::apply
+        (   [Index, Last](auto &... Column)
+            {   ((Index != Last ? (void)(Column[Index] = std::move(Column[Last])) : (void)0), ...);
+                (Column.pop(), ...);
+            },
+            Columns
+        );
+    }
+
+    inline row operator[] (index Index) &
+    {   return row(this, checkIndex(Index));
+    }
+
+    inline constRow operator[] (index Index) const &
+    {   return constRow(this, checkIndex(Index));
+    }
+
+    rowsIterator rows() &
+    {   return rowsIterator(this);
+    }
+
+    constRowsIterator rows() const &
+    {   return constRowsIterator(this);
+    }
+
+private:
+    template <std::size_t... columnIndices>
+    inline void appendColumns(std::index_sequence<columnIndices...>, typename fields::type &&... Values)
+    {   (std::get<columnIndices>(Columns).append(std::move(Values)), ...);
+    }
+
+    // Normalizes a negative index like `array` does, and throws if it's out of bounds.
+    inline index checkIndex(index Index) const
+    {   if (Index < 0)
+        {   Index += count();
+        }
+        if (Index < 0 || Index >= count())
+        {   throw error(StructOfArraysIndexErrorMsg, AT);
+        }
+        return Index;
+    }
+};
+
+TMVB
@@ -0,0 +1,282 @@
+#include "symbol.h"
+
+#include "hash-table.h"
+#include "memory.h"
+
+#include <mutex>
+
+#ifndef NDEBUG
+#include "map.h"
+#include "parallel.h"
+#include "set.h"
+#endif
+
+BVMT
+
+namespace symbolDetail
+{   namespace
+    {   struct entryText
+        {   static inline stringView of(const entry *Entry)
+            {   return Entry->Text.view();
+            }
+        };
+
+        // The global interning table; entries are never freed or moved, so that symbols
+        // can read their text without taking the lock.
+        class table
+        {   std::mutex Mutex;
+            memory::pool<entry> Entries;
+            hashTable<const entry *, stringView, entryText> ByText;
+
+        public:
+            const entry *find(stringView Text)
+            {   std::lock_guard<std::mutex> Lock(Mutex);
+                const index Slot = ByText.find(Text);
+                return Slot < 0 ? Null : *ByText.at(Slot);
+            }
+
+            // Calls `interned(I, Entry)` with the entry for each of `Texts`, taking the lock once.
+            // Doesn't run any caller code besides `interned`, which mustn't intern anything.
+            template <class onInterned>
+            void intern(arrayView<stringView> Texts, onInterned interned)
+            {   std::lock_guard<std::mutex> Lock(Mutex);
+                ByText.reserve(ByText.count() + Texts.count());
+                for (index I = 0; I < Texts.count(); ++I)
+                {   interned(I, internLocked(Texts[I]));
+                }
+            }
+
+            index count()
+            {   std::lock_guard<std::mutex> Lock(Mutex);
+                return ByText.count();
+            }
+
+        private:
+            const entry *internLocked(stringView Text)
+            {   if (Text.empty())
+                {   return Null;
+                }
+                bool Inserted;
+                const index Slot = ByText.insert
+                (   Text, determining<bool>(Inserted),
+                    [this, &Text](const entry **UninitializedSlot)
+                    {   entry *Entry = Entries.get(Entries.create(entry{string(Text), 0}));
+                        Entry->Id = (u32)Entries.count();
+                        *UninitializedSlot = Entry;
+                    }
+                );
+                return *ByText.at(Slot);
+            }
+        };
+
+        table &globalTable()
+        {   // Never destroyed, so that symbols stay valid in other static destructors.
+            static table *Table = new table();
+            return *Table;
+        }
+    }
+}
+
+symbol::symbol(stringView Text)
+{   symbolDetail::globalTable().intern
+    (   arrayView<stringView>(&Text, &Text + 1),
+        [this](index, const symbolDetail::entry *Interned)
+        {   Entry = Interned;
+        }
+    );
+}
+
+symbol::symbol(const string &Text)
+:   symbol(Text.view())
+{}
+
+symbol::symbol(const char *Chars)
+:   symbol(string(Chars))
+{}
+
+optional<symbol> symbol::find(stringView Text)
+{   if (Text.empty())
+    {   return optional<symbol>(symbol());
+    }
+    const symbolDetail::entry *Entry = symbolDetail::globalTable().find(Text);
+    return Entry == Null ? optional<symbol>() : optional<symbol>(symbol(Entry));
+}
+
+array<symbol> symbol::intern(iterator<stringView> &&Texts)
+{   // Collect the texts before taking the lock, since the iterator might intern symbols itself.
+    array<stringView> Views;
+    Views.reserve(Texts.remainingCount().AtLeast);
+    for (stringView Text : Texts)
+    {   Views.append(Text);
+    }
+    array<symbol> Result;
+    Result.count(Views.count());
+    symbolDetail::globalTable().intern
+    (   Views.view(),
+        [&Result](index I, const symbolDetail::entry *Interned)
+        {   Result[I].Entry = Interned;
+        }
+    );
+    return Result;
+}
+
+index symbol::count()
+{   return symbolDetail::globalTable().count();
+}
+
+stringView symbol::view() const
+{   return Entry == Null ? stringView() : Entry->Text.view();
+}
+
+const char *symbol::chars() const
+{   return Entry == Null ? "" : Entry->Text.chars();
+}
+
+std::ostream &operator << (std::ostream &Out, const symbol &Symbol)
+{   return Out << Symbol.view();
+}
+
+#ifndef NDEBUG
+namespace
+{   using symbolCounts = map<symbol, index>;
+    using stringCounts = map<string, index>;
+}
+
+void test__core__symbol()
+{   TEST
+    (   "symbols with the same text are equal and share their text",
+        symbol Guard("BunkerGuard1");
+        symbol Same(string("BunkerGuard1"));
+        symbol Other("Rummaging");
+        EXPECT_EQUAL(Guard, Same);
+        EXPECT_EQUAL(Guard == Other, False);
+        EXPECT_EQUAL(Guard.id(), Same.id());
+        EXPECT_EQUAL(Guard.view(), "BunkerGuard1");
+        EXPECT_EQUAL(Guard.chars(), Same.chars());
+        EXPECT_EQUAL(std::hash<symbol>()(Guard), std::hash<symbol>()(Same));
+        EXPECT_EQUAL(Other.view().count(), 9);
+
+        string Line("Guard said PullsOutSwordAxe");
+        stringView Word = Line.slice(11, 27);
+        EXPECT_EQUAL(symbol(Word).view(), "PullsOutSwordAxe");
+        EXPECT_EQUAL(symbol(Word), symbol("PullsOutSwordAxe"));
+    );
+
+    TEST
+    (   "the empty symbol",
+        symbol Empty;
+        EXPECT_EQUAL(Empty.empty(), True);
+        EXPECT_EQUAL(Empty.id(), (u32)0);
+        EXPECT_EQUAL(Empty.view(), "");
+        EXPECT_EQUAL(symbol(""), Empty);
+        EXPECT_EQUAL(symbol("x").empty(), False);
+        EXPECT_EQUAL(*symbol::find(stringView()), Empty);
+    );
+
+    TEST
+    (   "symbol::find doesn't intern",
+        const index Count = symbol::count();
+        string Text("NeverInternedAnywhereElse");
+        EXPECT_EQUAL(symbol::find(Text.view()) == Null, True);
+        EXPECT_EQUAL(symbol::count(), Count);
+        symbol Interned(Text);
+        EXPECT_EQUAL(symbol::count(), Count + 1);
+        EXPECT_EQUAL(*symbol::find(Text.view()), Interned);
+    );
+
+    TEST
+    (   "symbol::intern interns a split line of identifiers in bulk",
+        string Line("Speaker Emotion Trigger Speaker Rummaging Emotion");
+        array<symbol> Symbols = symbol::intern(Line.view().split(' '));
+        EXPECT_EQUAL(Symbols.count(), 6);
+        EXPECT_EQUAL(Symbols[0], Symbols[3]);
+        EXPECT_EQUAL(Symbols[1], Symbols[5]);
+        EXPECT_EQUAL(Symbols[4], symbol("Rummaging"));
+        EXPECT_EQUAL(Symbols[2].view(), "Trigger");
+        EXPECT_EQUAL(Symbols[0] == Symbols[1], False);
+        // The text doesn't depend on the line:
+        Line = "something else entirely";
+        EXPECT_EQUAL(Symbols[0].view(), "Speaker");
+    );
+
+    TEST
+    (   "symbol::intern takes iterators which intern symbols themselves",
+        string Line("Speaker Emotion Trigger");
+        array<symbol> Seen;
+        array<symbol> Symbols = symbol::intern
+        (   Line.view().split(' ').iterate<stringView>
+            (   [&Seen](stringView &Word)
+                {   Seen.append(symbol(Word));
+                    return optional<stringView>(Word);
+                }
+            )
+        );
+        EXPECT_EQUAL(Symbols.count(), 3);
+        EXPECT_EQUAL(Symbols, Seen);
+    );
+
+    TEST
+    (   "symbols work as set and map keys",
+        set<symbol> Triggers({symbol("Rummaging"), symbol("PullsOutSwordAxe")});
+        EXPECT_EQUAL(Triggers.contains(symbol("Rummaging")), True);
+        EXPECT_EQUAL(Triggers.contains(symbol("Sleeping")), False);
+        symbolCounts Lines;
+        Lines[symbol("BunkerGuard1")] += 2;
+        Lines[symbol("BunkerGuard1")] += 3;
+        EXPECT_EQUAL(Lines[symbol("BunkerGuard1")], 5);
+    );
+
+    TEST
+    (   "symbols can be interned from many threads at once",
+        array<symbol> Symbols;
+        Symbols.count(1000);
+        parallelFor
+        (   iteratorRange<index>({.EndBefore = Symbols.count()}),
+            [&Symbols](index I)
+            {   string Name("ThreadedName");
+                Name += string::of(I % 10);
+                Symbols[I] = symbol(Name);
+            }
+        );
+        for (index I = 0; I < Symbols.count(); ++I)
+        {   EXPECT_EQUAL(Symbols[I], Symbols[I % 10]);
+        }
+        EXPECT_EQUAL(Symbols[7].view(), "ThreadedName7");
+    );
+
+    TEST_BENCHMARK
+    (   "looking up trigger names in a table, keyed by string vs. by symbol",
+        array<string> Names;
+        for (index I = 0; I < 200; ++I)
+        {   Names.append(string("LongishTriggerNameFromTheLogicFile") + string::of(I));
+        }
+        array<symbol> Symbols;
+        stringCounts ByString;
+        symbolCounts BySymbol;
+        for (const string &Name : Names.values())
+        {   Symbols.append(symbol(Name));
+            ByString[Name] = 0;
+            BySymbol[Symbols[-1]] = 0;
+        }
+        const index Lookups = 400000;
+        dbl StringSeconds = test::secondsToRun
+        (   [&]()
+            {   for (index I = 0; I < Lookups; ++I)
+                {   ++ByString[Names[I % Names.count()]];
+                }
+            }
+        );
+        dbl SymbolSeconds = test::secondsToRun
+        (   [&]()
+            {   for (index I = 0; I < Lookups; ++I)
+                {   ++BySymbol[Symbols[I % Symbols.count()]];
+                }
+            }
+        );
+        LOG(Lookups << " lookups: by string " << StringSeconds << "s, by symbol " << SymbolSeconds << "s");
+        EXPECT_EQUAL(ByString[Names[3]], BySymbol[Symbols[3]]);
+    );
+}
+#endif
+
+TMVB
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "array.h"
+#include "iterator.h"
+#include "optional.h"
+#include "string.h"
+#include "types.h"
+
+BVMT
+
+namespace symbolDetail
+{   // An interned string; these live (and don't move) until the program exits.
+    struct entry
+    {   string Text;
+        // Dense, starting at 1 in the order that symbols were interned.
+        u32 Id;
+    };
+}
+
+// An interned string, for identifiers that are compared and hashed constantly, e.g.,
+// speaker names, emotion tags, and trigger names from a logic file.  Each distinct text is
+// stored once in a global (thread-safe) table, so that comparing or hashing symbols is
+// an integer operation, and the text stays valid (see `view()`) for the rest of the program.
+// The default symbol is the empty one, which is also what interning "" gives.
+class symbol
+{   const symbolDetail::entry *Entry = Null;
+
+    explicit symbol(const symbolDetail::entry *_Entry)
+    :   Entry(_Entry)
+    {}
+public:
+    symbol() {}
+    // Interns `Text`, i.e., finds its symbol or adds it to the table.
+    explicit symbol(stringView Text);
+    explicit symbol(const string &Text);
+    explicit symbol(const char *Chars);
+
+    // The symbol for `Text` if it was already interned, without adding it otherwise,
+    // e.g., for checking input against known identifiers without growing the table.
+    static optional<symbol> find(stringView Text);
+
+    // Interns all of `Texts` while holding the table's lock only once,
+    // e.g., `symbol::intern(Line.split(' '))` for a line of identifiers.
+    // `Texts` is run before taking the lock, so it can intern symbols itself.
+    static array<symbol> intern(iterator<stringView> &&Texts);
+
+    // Number of interned (non-empty) symbols.
+    static index count();
+
+    // The text, which is valid (and unchanging) for the rest of the program.
+    stringView view() const;
+    const char *chars() const;
+
+    inline bool empty() const
+    {   return Entry == Null;
+    }
+
+    // Dense, from 1 in the order that symbols were interned (0 for the empty symbol),
+    // e.g., for indexing per-symbol data in an `array`.  Not stable across runs.
+    inline u32 id() const
+    {   return Entry == Null ? 0 : Entry->Id;
+    }
+
+    inline bool operator == (const symbol &Other) const
+    {   return Entry == Other.Entry;
+    }
+
+    inline bool operator != (const symbol &Other) const
+    {   return Entry != Other.Entry;
+    }
+
+    // Orders by `id()`, not by text.
+    inline bool operator < (const symbol &Other) const
+    {   return id() < Other.id();
+    }
+};
+
+std::ostream &operator << (std::ostream &Out, const symbol &Symbol);
+
+TMVB
+
+namespace std
+{   template <>
+    struct hash<bvmt::symbol>
+    {   inline std::size_t operator() (const bvmt::symbol& Symbol) const
+        {   return Symbol.id();
+        }
+    };
+}
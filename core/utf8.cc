@@ -0,0 +1,479 @@
+#include "utf8.h"
+
+#include <bit>          // std::popcount, std::countr_zero
+#include <cstring>      // memcpy, memchr, memcmp
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifndef NDEBUG
+#include "error.h"
+#include "iterator.h"
+#include "string.h"
+#endif
+
+BVMT
+
+namespace utf8
+{   namespace
+    {
+#if defined(__AVX2__)
+        constexpr index AsciiBlock = 32;
+
+        inline bool asciiBlock(const u8 *Bytes)
+        {   return _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)Bytes)) == 0;
+        }
+#elif defined(__SSE2__)
+        constexpr index AsciiBlock = 16;
+
+        inline bool asciiBlock(const u8 *Bytes)
+        {   return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)Bytes)) == 0;
+        }
+#else
+        constexpr index AsciiBlock = 8;
+
+        inline bool asciiBlock(const u8 *Bytes)
+        {   u64 Word;
+            memcpy(&Word, Bytes, sizeof(Word));
+            return (Word & 0x8080808080808080ull) == 0;
+        }
+#endif
+
+        // Decodes the (non-empty) sequence at the start of `Bytes`, returning its length,
+        // or 0 if it's malformed.
+        inline index decodeOne(const u8 *Bytes, index Count, rune &Rune)
+        {   const u8 Lead = Bytes[0];
+            if (Lead < 0x80)
+            {   Rune = Lead;
+                return 1;
+            }
+            index Length;
+            // The allowed range of the second byte, which rules out overlong sequences,
+            // surrogates, and runes past U+10FFFF.
+            u8 Low = 0x80, High = 0xBF;
+            if (Lead < 0xC2)
+            {   // Continuation byte, or an overlong two-byte sequence.
+                return 0;
+            }
+            else if (Lead < 0xE0)
+            {   Length = 2;
+                Rune = Lead & 0b00011111;
+            }
+            else if (Lead < 0xF0)
+            {   Length = 3;
+                Rune = Lead & 0b00001111;
+                if (Lead == 0xE0)
+                {   Low = 0xA0;
+                }
+                else if (Lead == 0xED)
+                {   High = 0x9F;
+                }
+            }
+            else if (Lead < 0xF5)
+            {   Length = 4;
+                Rune = Lead & 0b00000111;
+                if (Lead == 0xF0)
+                {   Low = 0x90;
+                }
+                else if (Lead == 0xF4)
+                {   High = 0x8F;
+                }
+            }
+            else
+            {   return 0;
+            }
+            if (Count < Length || Bytes[1] < Low || Bytes[1] > High)
+            {   return 0;
+            }
+            Rune = (Rune << 6) | (Bytes[1] & 0b00111111);
+            for (index I = 2; I < Length; ++I)
+            {   if ((Bytes[I] & 0b11000000) != 0b10000000)
+                {   return 0;
+                }
+                Rune = (Rune << 6) | (Bytes[I] & 0b00111111);
+            }
+            return Length;
+        }
+
+        // Writes a block of ASCII `Bytes` as runes.
+        inline void widenAsciiBlock(const u8 *Bytes, rune *Runes)
+        {
+#if defined(__AVX2__)
+            for (index I = 0; I < AsciiBlock; I += 8)
+            {   const __m128i Eight = _mm_loadl_epi64((const __m128i *)(Bytes + I));
+                _mm256_storeu_si256((__m256i *)(Runes + I), _mm256_cvtepu8_epi32(Eight));
+            }
+#elif defined(__SSE2__)
+            const __m128i Zero = _mm_setzero_si128();
+            const __m128i Block = _mm_loadu_si128((const __m128i *)Bytes);
+            const __m128i Low = _mm_unpacklo_epi8(Block, Zero);
+            const __m128i High = _mm_unpackhi_epi8(Block, Zero);
+            _mm_storeu_si128((__m128i *)Runes, _mm_unpacklo_epi16(Low, Zero));
+            _mm_storeu_si128((__m128i *)(Runes + 4), _mm_unpackhi_epi16(Low, Zero));
+            _mm_storeu_si128((__m128i *)(Runes + 8), _mm_unpacklo_epi16(High, Zero));
+            _mm_storeu_si128((__m128i *)(Runes + 12), _mm_unpackhi_epi16(High, Zero));
+#else
+            for (index I = 0; I < AsciiBlock; ++I)
+            {   Runes[I] = Bytes[I];
+            }
+#endif
+        }
+    }
+
+    bool valid(const u8 *Bytes, index Count)
+    {   index I = 0;
+        while (I < Count)
+        {   if (I + AsciiBlock <= Count && asciiBlock(Bytes + I))
+            {   I += AsciiBlock;
+                continue;
+            }
+            rune Rune;
+            const index Length = decodeOne(Bytes + I, Count - I, Rune);
+            if (Length == 0)
+            {   return False;
+            }
+            I += Length;
+        }
+        return True;
+    }
+
+    index countRunes(const u8 *Bytes, index Count)
+    {   index Runes = 0;
+        index I = 0;
+#if defined(__AVX2__)
+        // Continuation bytes (0b10xxxxxx) are the only ones less than -64 as signed bytes.
+        const __m256i ContinuationLimit = _mm256_set1_epi8(-64);
+        for (; I + 32 <= Count; I += 32)
+        {   const __m256i Block = _mm256_loadu_si256((const __m256i *)(Bytes + I));
+            const u32 Continuations = (u32)_mm256_movemask_epi8(_mm256_cmpgt_epi8(ContinuationLimit, Block));
+            Runes += 32 - std::popcount(Continuations);
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i ContinuationLimit16 = _mm_set1_epi8(-64);
+        for (; I + 16 <= Count; I += 16)
+        {   const __m128i Block = _mm_loadu_si128((const __m128i *)(Bytes + I));
+            const u32 Continuations = (u32)_mm_movemask_epi8(_mm_cmplt_epi8(Block, ContinuationLimit16));
+            Runes += 16 - std::popcount(Continuations);
+        }
+#endif
+        for (; I < Count; ++I)
+        {   Runes += (Bytes[I] & 0b11000000) != 0b10000000;
+        }
+        return Runes;
+    }
+
+    decoded decode(const u8 *Bytes, index Count, rune *Runes, index MaxRunes)
+    {   decoded Result;
+        while (Result.Bytes < Count && Result.Runes < MaxRunes)
+        {   if
+            (   Result.Bytes + AsciiBlock <= Count
+                &&  Result.Runes + AsciiBlock <= MaxRunes
+                &&  asciiBlock(Bytes + Result.Bytes)
+            )
+            {   widenAsciiBlock(Bytes + Result.Bytes, Runes + Result.Runes);
+                Result.Bytes += AsciiBlock;
+                Result.Runes += AsciiBlock;
+                continue;
+            }
+            const index Length = decodeOne(Bytes + Result.Bytes, Count - Result.Bytes, Runes[Result.Runes]);
+            if (Length == 0)
+            {   break;
+            }
+            Result.Bytes += Length;
+            ++Result.Runes;
+        }
+        return Result;
+    }
+
+    index find(const u8 *Bytes, index Count, const u8 *Needle, index NeedleCount)
+    {   if (NeedleCount <= 0)
+        {   return 0;
+        }
+        if (NeedleCount > Count)
+        {   return Count;
+        }
+        if (NeedleCount == 1)
+        {   return findByte(Bytes, Count, Needle[0]);
+        }
+        const index Last = NeedleCount - 1;
+        // The number of offsets that `Needle` could start at.
+        const index Starts = Count - Last;
+        index I = 0;
+#if defined(__AVX2__)
+        const __m256i FirstBytes = _mm256_set1_epi8((char)Needle[0]);
+        const __m256i LastBytes = _mm256_set1_epi8((char)Needle[Last]);
+        for (; I + 32 <= Starts; I += 32)
+        {   const __m256i Firsts = _mm256_loadu_si256((const __m256i *)(Bytes + I));
+            const __m256i Lasts = _mm256_loadu_si256((const __m256i *)(Bytes + I + Last));
+            u32 Candidates = (u32)_mm256_movemask_epi8
+            (   _mm256_and_si256(_mm256_cmpeq_epi8(Firsts, FirstBytes), _mm256_cmpeq_epi8(Lasts, LastBytes))
+            );
+            while (Candidates)
+            {   const index Offset = I + std::countr_zero(Candidates);
+                if (memcmp(Bytes + Offset + 1, Needle + 1, NeedleCount - 2) == 0)
+                {   return Offset;
+                }
+                Candidates &= Candidates - 1;
+            }
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i FirstBytes16 = _mm_set1_epi8((char)Needle[0]);
+        const __m128i LastBytes16 = _mm_set1_epi8((char)Needle[Last]);
+        for (; I + 16 <= Starts; I += 16)
+        {   const __m128i Firsts = _mm_loadu_si128((const __m128i *)(Bytes + I));
+            const __m128i Lasts = _mm_loadu_si128((const __m128i *)(Bytes + I + Last));
+            u32 Candidates = (u32)_mm_movemask_epi8
+            (   _mm_and_si128(_mm_cmpeq_epi8(Firsts, FirstBytes16), _mm_cmpeq_epi8(Lasts, LastBytes16))
+            );
+            while (Candidates)
+            {   const index Offset = I + std::countr_zero(Candidates);
+                if (memcmp(Bytes + Offset + 1, Needle + 1, NeedleCount - 2) == 0)
+                {   return Offset;
+                }
+                Candidates &= Candidates - 1;
+            }
+        }
+#endif
+        while (I < Starts)
+        {   const u8 *Found = (const u8 *)memchr(Bytes + I, Needle[0], Starts - I);
+            if (Found == Null)
+            {   break;
+            }
+            I = Found - Bytes;
+            if (Bytes[I + Last] == Needle[Last] && memcmp(Bytes + I + 1, Needle + 1, NeedleCount - 2) == 0)
+            {   return I;
+            }
+            ++I;
+        }
+        return Count;
+    }
+
+    index findByte(const u8 *Bytes, index Count, u8 Byte)
+    {   if (Count <= 0)
+        {   return 0;
+        }
+        // libc's memchr is already vectorized.
+        const u8 *Found = (const u8 *)memchr(Bytes, Byte, Count);
+        return Found == Null ? Count : Found - Bytes;
+    }
+
+    byteSet::byteSet(std::initializer_list<u8> Bytes)
+    {   for (u8 Byte : Bytes)
+        {   add(Byte);
+        }
+    }
+
+    void byteSet::add(u8 Byte)
+    {   if (contains(Byte))
+        {   return;
+        }
+        Bits[Byte >> 6] |= u64(1) << (Byte & 63);
+        if (MemberCount < (index)sizeof(Members))
+        {   Members[MemberCount] = Byte;
+        }
+        ++MemberCount;
+    }
+
+    index findAny(const u8 *Bytes, index Count, const byteSet &Set)
+    {   if (Set.MemberCount == 0)
+        {   return Count;
+        }
+        if (Set.MemberCount == 1)
+        {   return findByte(Bytes, Count, Set.Members[0]);
+        }
+        index I = 0;
+        // Small sets compare each member against a block at a time; larger sets are
+        // rare enough (as delimiters) that the bit lookup below is fine.
+        if (Set.MemberCount <= (index)sizeof(Set.Members))
+        {
+#if defined(__AVX2__)
+            __m256i Members[sizeof(Set.Members)];
+            for (index M = 0; M < Set.MemberCount; ++M)
+            {   Members[M] = _mm256_set1_epi8((char)Set.Members[M]);
+            }
+            for (; I + 32 <= Count; I += 32)
+            {   const __m256i Block = _mm256_loadu_si256((const __m256i *)(Bytes + I));
+                __m256i Matches = _mm256_cmpeq_epi8(Block, Members[0]);
+                for (index M = 1; M < Set.MemberCount; ++M)
+                {   Matches = _mm256_or_si256(Matches, _mm256_cmpeq_epi8(Block, Members[M]));
+                }
+                const u32 Mask = (u32)_mm256_movemask_epi8(Matches);
+                if (Mask)
+                {   return I + std::countr_zero(Mask);
+                }
+            }
+#endif
+#if defined(__SSE2__)
+            __m128i Members16[sizeof(Set.Members)];
+            for (index M = 0; M < Set.MemberCount; ++M)
+            {   Members16[M] = _mm_set1_epi8((char)Set.Members[M]);
+            }
+            for (; I + 16 <= Count; I += 16)
+            {   const __m128i Block = _mm_loadu_si128((const __m128i *)(Bytes + I));
+                __m128i Matches = _mm_cmpeq_epi8(Block, Members16[0]);
+                for (index M = 1; M < Set.MemberCount; ++M)
+                {   Matches = _mm_or_si128(Matches, _mm_cmpeq_epi8(Block, Members16[M]));
+                }
+                const u32 Mask = (u32)_mm_movemask_epi8(Matches);
+                if (Mask)
+                {   return I + std::countr_zero(Mask);
+                }
+            }
+#endif
+        }
+        for (; I < Count; ++I)
+        {   if (Set.contains(Bytes[I]))
+            {   return I;
+            }
+        }
+        return Count;
+    }
+}
+
+#ifndef NDEBUG
+void test__core__utf8()
+{   TEST
+    (   "utf8::valid accepts well-formed utf8 and rejects malformed sequences",
+        const string Mixed = string("plain ascii that spans more than one block, ") * 3 + "Straße 水🍌!";
+        EXPECT_EQUAL(utf8::valid((const u8 *)Mixed.chars(), Mixed.countBytes()), True);
+        EXPECT_EQUAL(utf8::valid((const u8 *)"", 0), True);
+
+        auto isValid = [](const char *Bytes) { return utf8::valid((const u8 *)Bytes, strlen(Bytes)); };
+        EXPECT_EQUAL(isValid("\xC3\xA9"), True);
+        // Stray continuation byte:
+        EXPECT_EQUAL(isValid("a\x80"), False);
+        // Truncated sequence, also after a long run of ascii:
+        EXPECT_EQUAL(isValid("\xE6\xB0"), False);
+        EXPECT_EQUAL(isValid("0123456789abcdef0123456789abcdef0123456789\xE6\xB0"), False);
+        // Overlong encodings:
+        EXPECT_EQUAL(isValid("\xC0\xAF"), False);
+        EXPECT_EQUAL(isValid("\xE0\x80\xAF"), False);
+        EXPECT_EQUAL(isValid("\xF0\x80\x80\xAF"), False);
+        // Surrogate and past U+10FFFF:
+        EXPECT_EQUAL(isValid("\xED\xA0\x80"), False);
+        EXPECT_EQUAL(isValid("\xF4\x90\x80\x80"), False);
+        EXPECT_EQUAL(isValid("\xF4\x8F\xBF\xBF"), True);
+    );
+
+    TEST
+    (   "utf8::countRunes counts non-continuation bytes",
+        const string Mixed = string("Grüße, 旅人! 🍌 and some ascii to fill a block") * 5;
+        EXPECT_EQUAL(utf8::countRunes((const u8 *)Mixed.chars(), Mixed.countBytes()), 5 * 43);
+        EXPECT_EQUAL(utf8::countRunes((const u8 *)"abc", 3), 3);
+        EXPECT_EQUAL(utf8::countRunes((const u8 *)"", 0), 0);
+    );
+
+    TEST
+    (   "utf8::decode decodes into a rune buffer and stops at malformed sequences",
+        const string Mixed = string("0123456789abcdefghijklmnopqrstuv") + "水ß🍌" + "0123456789abcdef";
+        rune Runes[64];
+        utf8::decoded Decoded = utf8::decode((const u8 *)Mixed.chars(), Mixed.countBytes(), Runes, 64);
+        EXPECT_EQUAL(Decoded.Runes, 32 + 3 + 16);
+        EXPECT_EQUAL(Decoded.Bytes, Mixed.countBytes());
+        EXPECT_EQUAL(Runes[0], '0');
+        EXPECT_EQUAL(Runes[31], 'v');
+        EXPECT_EQUAL(Runes[32], 0x6C34);
+        EXPECT_EQUAL(Runes[33], 0xDF);
+        EXPECT_EQUAL(Runes[34], 0x1F34C);
+        EXPECT_EQUAL(Runes[50], 'f');
+
+        // Stops when out of room:
+        Decoded = utf8::decode((const u8 *)Mixed.chars(), Mixed.countBytes(), Runes, 33);
+        EXPECT_EQUAL(Decoded.Runes, 33);
+        EXPECT_EQUAL(Decoded.Bytes, 35);
+
+        const char *Malformed = "ab\x80" "cd";
+        Decoded = utf8::decode((const u8 *)Malformed, 5, Runes, 64);
+        EXPECT_EQUAL(Decoded.Runes, 2);
+        EXPECT_EQUAL(Decoded.Bytes, 2);
+    );
+
+    TEST
+    (   "utf8::find finds substrings, checking candidates across block boundaries",
+        auto find = [](const char *Bytes, const char *Needle)
+        {   return utf8::find((const u8 *)Bytes, strlen(Bytes), (const u8 *)Needle, strlen(Needle));
+        };
+        EXPECT_EQUAL(find("hello world", "world"), 6);
+        EXPECT_EQUAL(find("hello world", "worlds"), 11);
+        EXPECT_EQUAL(find("hello world", "hello world!"), 11);
+        EXPECT_EQUAL(find("hello world", ""), 0);
+        EXPECT_EQUAL(find("hello world", "o"), 4);
+        EXPECT_EQUAL(find("", "o"), 0);
+        // Many candidates that match the first and last bytes but not the middle:
+        EXPECT_EQUAL(find("axxb axyb axxb axyb axxb axyb axxb axyb axxb axyb axxb ayyb", "ayyb"), 55);
+        EXPECT_EQUAL(find("axxb axyb axxb axyb axxb axyb axxb axyb axxb axyb axxb ayyb", "ayxb"), 59);
+        EXPECT_EQUAL(find("0123456789abcdef0123456789abcdef0123456789abcdef0123456789水🍌", "9水🍌"), 57);
+        EXPECT_EQUAL(find("0123456789abcdef0123456789abcdef0123456789abcdef0123456789", "f01"), 15);
+    );
+
+    TEST
+    (   "utf8::findByte and findAny find the first matching byte",
+        const char *Bytes = "0123456789abcdef0123456789abcdef0123456789abcdef,0123456789;";
+        const index Count = strlen(Bytes);
+        EXPECT_EQUAL(utf8::findByte((const u8 *)Bytes, Count, ','), 48);
+        EXPECT_EQUAL(utf8::findByte((const u8 *)Bytes, Count, '!'), Count);
+        EXPECT_EQUAL(utf8::findAny((const u8 *)Bytes, Count, utf8::byteSet({';', ','})), 48);
+        EXPECT_EQUAL(utf8::findAny((const u8 *)Bytes, Count, utf8::byteSet({';', '!'})), Count - 1);
+        EXPECT_EQUAL(utf8::findAny((const u8 *)Bytes, Count, utf8::byteSet({'!', '?'})), Count);
+        EXPECT_EQUAL(utf8::findAny((const u8 *)Bytes, Count, utf8::byteSet()), Count);
+
+        // More members than are compared a block at a time:
+        utf8::byteSet Set({'!', '?', '#', '$', '%', '^', '&', '*', '(', ')'});
+        EXPECT_EQUAL(Set.count(), 10);
+        EXPECT_EQUAL(Set.contains('('), True);
+        EXPECT_EQUAL(Set.contains('a'), False);
+        EXPECT_EQUAL(utf8::findAny((const u8 *)Bytes, Count, Set), Count);
+        Set.add(';');
+        Set.add(';');
+        EXPECT_EQUAL(Set.count(), 11);
+        EXPECT_EQUAL(utf8::findAny((const u8 *)Bytes, Count, Set), Count - 1);
+    );
+
+    TEST_BENCHMARK
+    (   "counting and decoding a large text asset, rune by rune vs. utf8:: routines",
+        string Text;
+        for (int I = 0; I < 20000; ++I)
+        {   Text += "The traveler said, \"Grüße!\" and walked on toward 旅館.\n";
+        }
+        const u8 *Bytes = (const u8 *)Text.chars();
+        const index ByteCount = Text.countBytes();
+        index ShiftCount = 0;
+        dbl ShiftSeconds = test::secondsToRun
+        (   [&]()
+            {   stringView View = Text.view();
+                while (!View.empty())
+                {   View.shift();
+                    ++ShiftCount;
+                }
+            }
+        );
+        index Utf8Count = 0;
+        dbl Utf8Seconds = test::secondsToRun
+        (   [&]()
+            {   if (utf8::valid(Bytes, ByteCount))
+                {   Utf8Count = utf8::countRunes(Bytes, ByteCount);
+                }
+            }
+        );
+        index DecodedCount = 0;
+        dbl DecodeSeconds = test::secondsToRun
+        (   [&]()
+            {   auto Runes = Text.runes();
+                ITERATOR_BATCH_LOOP(Runes, rune, Rune, DecodedCount += Rune != 0)
+            }
+        );
+        LOG
+        (   ByteCount << " bytes: shift() " << ShiftSeconds << "s, utf8::valid + countRunes "
+                    << Utf8Seconds << "s, runes() " << DecodeSeconds << "s"
+        );
+        EXPECT_EQUAL(Utf8Count, ShiftCount);
+        EXPECT_EQUAL(DecodedCount, ShiftCount);
+    );
+}
+#endif
+
+TMVB
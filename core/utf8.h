@@ -0,0 +1,71 @@
+#pragma once
+
+#include "types.h"
+
+#include <initializer_list>
+
+BVMT
+
+// Bulk utf8 routines for long strings, e.g., when loading or laying out text assets.
+// Runs of ASCII are handled 16 bytes at a time with SSE2 (32 with AVX2) where available,
+// so that plain text is bounded by memory bandwidth; other sequences are decoded one at a time.
+namespace utf8
+{   // True if `Bytes` is well-formed utf8, i.e., no stray continuation bytes, truncated or
+    // overlong sequences, surrogates, or runes past U+10FFFF.
+    bool valid(const u8 *Bytes, index Count);
+
+    // The number of runes in well-formed utf8 `Bytes`, i.e., the number of bytes which
+    // aren't continuation bytes.  Check `valid` first if `Bytes` might be malformed.
+    index countRunes(const u8 *Bytes, index Count);
+
+    struct decoded
+    {   index Runes = 0;
+        index Bytes = 0;
+    };
+
+    // Decodes `Bytes` into `Runes` until `MaxRunes` runes are written or the bytes run out,
+    // returning how many runes were written and how many bytes they took.  Stops early
+    // (before it) at any malformed sequence, so that the caller can decide what to do with it.
+    decoded decode(const u8 *Bytes, index Count, rune *Runes, index MaxRunes);
+
+    // The offset of the first `Needle` in `Bytes`, or `Count` if there's none.  An empty
+    // `Needle` is found at 0.  Candidates are filtered a block at a time by comparing against
+    // the first and last bytes of `Needle`, so only those go through a full comparison.
+    // Since utf8 is self-synchronizing, a well-formed `Needle` is only found on rune boundaries.
+    index find(const u8 *Bytes, index Count, const u8 *Needle, index NeedleCount);
+
+    // The offset of the first `Byte` in `Bytes`, or `Count` if there's none.
+    index findByte(const u8 *Bytes, index Count, u8 Byte);
+
+    // A set of bytes to search for with `findAny`, e.g., the first bytes of some delimiters.
+    class byteSet
+    {   u64 Bits[4] = {0, 0, 0, 0};
+        // The first few members, which `findAny` compares against a block at a time.
+        u8 Members[8];
+        index MemberCount = 0;
+    public:
+        byteSet() {}
+        byteSet(std::initializer_list<u8> Bytes);
+
+        void add(u8 Byte);
+
+        inline bool contains(u8 Byte) const
+        {   return (Bits[Byte >> 6] >> (Byte & 63)) & 1;
+        }
+
+        inline index count() const
+        {   return MemberCount;
+        }
+
+        inline bool empty() const
+        {   return MemberCount == 0;
+        }
+
+        friend index findAny(const u8 *Bytes, index Count, const byteSet &Set);
+    };
+
+    // The offset of the first byte in `Bytes` which is in `Set`, or `Count` if there's none.
+    index findAny(const u8 *Bytes, index Count, const byteSet &Set);
+}
+
+TMVB
@@ -0,0 +1,296 @@
+#include "command-queue.h"
+
+#include "../core/memory.h"
+
+#ifndef NDEBUG
+#include "../core/error.h"
+#include "../core/job.h"
+
+#include <thread>
+#endif
+
+BVMT
+
+drawCommand drawCommand::write
+(   texture *Target, const font *Font, string Text, coordinate2i Coordinates
+)
+{   drawCommand Command;
+    Command.Kind = kind::Write;
+    Command.Target = Target;
+    Command.Font = Font;
+    if (&Text.resource() == &memory::heap())
+    {   Command.Text = std::move(Text);
+    }
+    else
+    {   // E.g., text formatted in `memory::frameArena()`, which gets reset at the end of
+        // the frame, before the command is drained; so keep a copy on the heap.
+        Command.Text = string(Text.view());
+    }
+    Command.Coordinates = Coordinates;
+    return Command;
+}
+
+drawCommand drawCommand::draw(const texture *Source)
+{   drawCommand Command;
+    Command.Kind = kind::Draw;
+    Command.Source = Source;
+    return Command;
+}
+
+struct commandQueue::recorder
+{   // The buffer this thread is currently recording into, if any.
+    buffer *Recording = Null;
+    // Drained buffers which this thread took off the free list, to record into next.
+    buffer *Spares = Null;
+
+    // Runs when the thread exits, so that commands recorded since its last `flush()`
+    // still get drained, and its buffers go back to the queue instead of leaking.
+    ~recorder()
+    {   commandQueue *Queue = commandQueue::get();
+        Queue->flush();
+        if (Spares != Null)
+        {   buffer *Last = Spares;
+            while (Last->Next != Null)
+            {   Last = Last->Next;
+            }
+            Queue->recycle(Spares, Last);
+            Spares = Null;
+        }
+    }
+};
+
+thread_local commandQueue::recorder commandQueue::Recorder;
+
+commandQueue *commandQueue::get()
+{   // Never deleted (like other singletons), so threads which exit late can still flush.
+    static commandQueue *Instance = new commandQueue();
+    return Instance;
+}
+
+commandQueue::~commandQueue()
+{   for (buffer *Buffer : {Submitted.exchange(Null), Free.exchange(Null)})
+    {   while (Buffer != Null)
+        {   buffer *Next = Buffer->Next;
+            delete Buffer;
+            Buffer = Next;
+        }
+    }
+}
+
+commandQueue::buffer *commandQueue::emptyBuffer()
+{   if (Recorder.Spares == Null)
+    {   Recorder.Spares = Free.exchange(Null, std::memory_order_acquire);
+    }
+    buffer *Buffer = Recorder.Spares;
+    if (Buffer == Null)
+    {   Buffer = new buffer();
+        Buffer->Commands.reserve(BufferCount);
+        return Buffer;
+    }
+    Recorder.Spares = Buffer->Next;
+    Buffer->Next = Null;
+    return Buffer;
+}
+
+void commandQueue::recycle(buffer *First, buffer *Last)
+{   Last->Next = Free.load(std::memory_order_relaxed);
+    // On failure, `Last->Next` is updated to the latest head, so just try again.
+    while
+    (   !Free.compare_exchange_weak
+        (   Last->Next, First,
+            std::memory_order_release,
+            std::memory_order_relaxed
+        )
+    )
+    {}
+}
+
+void commandQueue::record(drawCommand Command)
+{   buffer *&Recording = Recorder.Recording;
+    if (Recording == Null)
+    {   Recording = emptyBuffer();
+    }
+    Recording->Commands.append(std::move(Command));
+    if (Recording->Commands.count() >= BufferCount)
+    {   flush();
+    }
+}
+
+void commandQueue::flush()
+{   if (Recorder.Recording == Null)
+    {   return;
+    }
+    buffer *Buffer = Recorder.Recording;
+    Recorder.Recording = Null;
+    Buffer->Next = Submitted.load(std::memory_order_relaxed);
+    // On failure, `Buffer->Next` is updated to the latest head, so just try again.
+    while
+    (   !Submitted.compare_exchange_weak
+        (   Buffer->Next, Buffer,
+            std::memory_order_release,
+            std::memory_order_relaxed
+        )
+    )
+    {}
+}
+
+index commandQueue::drain(fn<void(drawCommand &)> run)
+{   flush();
+    // Take everything at once, then reverse the list so that the oldest buffer is first.
+    buffer *Newest = Submitted.exchange(Null, std::memory_order_acquire);
+    buffer *Oldest = Null;
+    while (Newest != Null)
+    {   buffer *Next = Newest->Next;
+        Newest->Next = Oldest;
+        Oldest = Newest;
+        Newest = Next;
+    }
+    index Count = 0;
+    buffer *Last = Null;
+    for (buffer *Buffer = Oldest; Buffer != Null; Buffer = Buffer->Next)
+    {   const index BufferCommandCount = Buffer->Commands.count();
+        for (index I = 0; I < BufferCommandCount; ++I)
+        {   run(Buffer->Commands[I]);
+        }
+        Count += BufferCommandCount;
+        // Keeps the capacity for the next thread which records into it.
+        Buffer->Commands.clear();
+        Last = Buffer;
+    }
+    if (Oldest != Null)
+    {   recycle(Oldest, Last);
+    }
+    return Count;
+}
+
+#ifndef NDEBUG
+void test__library__command_queue()
+{   // Runs first, so that jobs are the first to `get()` the queue
+    // (`library/command-queue.cc` sorts before the other tests which record).
+    TEST
+    (   "jobs can be the first to record",
+        const i32 JobCount = 16;
+        array<commandQueue *> QueueForJob = array<commandQueue *>::fixedCount(JobCount);
+        jobCounter Counter;
+        for (i32 Job = 0; Job < JobCount; ++Job)
+        {   jobs::get()->run
+            (   [&QueueForJob, Job]()
+                {   commandQueue *Queue = commandQueue::get();
+                    QueueForJob[Job] = Queue;
+                    Queue->record(drawCommand::write(Null, Null, "", {.X = Job}));
+                    Queue->flush();
+                },
+                &Counter
+            );
+        }
+        jobs::get()->wait(Counter);
+        commandQueue *Queue = commandQueue::get();
+        for (i32 Job = 0; Job < JobCount; ++Job)
+        {   EXPECT_EQUAL(QueueForJob[Job], Queue);
+        }
+        EXPECT_EQUAL(Queue->drain([](drawCommand &) {}), JobCount);
+    );
+
+    TEST
+    (   "commands from this thread are drained in order",
+        commandQueue *Queue = commandQueue::get();
+        for (i32 I = 0; I < 2 * commandQueue::BufferCount + 3; ++I)
+        {   Queue->record(drawCommand::write(Null, Null, string::of(I), {.X = I}));
+        }
+        i32 Expected = 0;
+        index Count = Queue->drain
+        (   [&Expected](drawCommand &Command)
+            {   EXPECT_EQUAL(Command.Kind == drawCommand::kind::Write, True);
+                EXPECT_EQUAL(Command.Coordinates.X, Expected);
+                EXPECT_EQUAL(Command.Text, string::of(Expected));
+                ++Expected;
+            }
+        );
+        EXPECT_EQUAL(Count, 2 * commandQueue::BufferCount + 3);
+        EXPECT_EQUAL(Queue->drain([](drawCommand &) {}), 0);
+    );
+
+    TEST
+    (   "commands can be recorded from other threads",
+        commandQueue *Queue = commandQueue::get();
+        jobCounter Counter;
+        for (i32 Job = 0; Job < 16; ++Job)
+        {   jobs::get()->run
+            (   [Queue, Job]()
+                {   for (i32 I = 0; I < 100; ++I)
+                    {   Queue->record(drawCommand::write(Null, Null, "", {.X = Job, .Y = I}));
+                    }
+                    Queue->flush();
+                },
+                &Counter
+            );
+        }
+        jobs::get()->wait(Counter);
+        array<i32> NextYForJob = array<i32>::fixedCount(16);
+        index Count = Queue->drain
+        (   [&NextYForJob](drawCommand &Command)
+            {   // Each thread's commands are in order:
+                EXPECT_EQUAL(Command.Coordinates.Y, NextYForJob[Command.Coordinates.X]++);
+            }
+        );
+        EXPECT_EQUAL(Count, 1600);
+    );
+
+    TEST
+    (   "drained buffers are recorded into again, frame after frame",
+        commandQueue *Queue = commandQueue::get();
+        for (i32 Frame = 0; Frame < 10; ++Frame)
+        {   for (i32 I = 0; I <= Frame * 50; ++I)
+            {   Queue->record(drawCommand::write(Null, Null, "", {.X = Frame, .Y = I}));
+            }
+            i32 Expected = 0;
+            index Count = Queue->drain
+            (   [Frame, &Expected](drawCommand &Command)
+                {   EXPECT_EQUAL(Command.Coordinates.X, Frame);
+                    EXPECT_EQUAL(Command.Coordinates.Y, Expected++);
+                }
+            );
+            EXPECT_EQUAL(Count, Frame * 50 + 1);
+        }
+    );
+
+    TEST
+    (   "recorded text outlives the frame arena it was formatted in",
+        commandQueue *Queue = commandQueue::get();
+        memory::arena &Arena = memory::frameArena();
+        // Too long to be stored inline:
+        string Text(Arena);
+        Text += "formatted in the frame arena: ";
+        Text += string::of(123);
+        Queue->record(drawCommand::write(Null, Null, std::move(Text), {}));
+        Arena.reset();
+        // Reuse the arena's bytes:
+        string Other(Arena);
+        Other += string("X") * 40;
+        string Recorded;
+        EXPECT_EQUAL
+        (   Queue->drain([&Recorded](drawCommand &Command) { Recorded = Command.Text; }),
+            1
+        );
+        EXPECT_EQUAL(Recorded, "formatted in the frame arena: 123");
+        EXPECT_EQUAL(&Recorded.resource() == &memory::heap(), True);
+    );
+
+    TEST
+    (   "commands are flushed when their thread exits",
+        commandQueue *Queue = commandQueue::get();
+        std::thread Thread
+        (   [Queue]()
+            {   // Without calling `flush()`:
+                Queue->record(drawCommand::write(Null, Null, "last words", {.X = 3}));
+            }
+        );
+        Thread.join();
+        string Text;
+        EXPECT_EQUAL(Queue->drain([&Text](drawCommand &Command) { Text = Command.Text; }), 1);
+        EXPECT_EQUAL(Text, "last words");
+    );
+}
+#endif
+
+TMVB
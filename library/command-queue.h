@@ -0,0 +1,98 @@
+#pragma once
+
+#include "dimensions.h"
+
+#include "../core/array.h"
+#include "../core/string.h"
+#include "../core/types.h"
+
+#include <atomic>
+
+BVMT
+
+struct font;
+struct texture;
+
+struct drawCommand
+{   // Something to draw which was recorded off the main thread; see `commandQueue`.
+    enum class kind : u8
+    {   // Writes `Text` with `Font` at `Coordinates` into the `Target` texture.
+        Write,
+        // Draws the `Source` texture across the window, like `window::draw(const texture &)`.
+        Draw,
+    };
+
+    kind Kind = kind::Write;
+    texture *Target = Null;
+    const font *Font = Null;
+    string Text;
+    coordinate2i Coordinates;
+    const texture *Source = Null;
+
+    // `Text` is copied onto the heap if it's on another resource (e.g., the frame arena).
+    static drawCommand write
+    (   texture *Target, const font *Font, string Text, coordinate2i Coordinates
+    );
+    static drawCommand draw(const texture *Source);
+};
+
+class commandQueue
+{   // Lets any thread record `drawCommand`s without locking, for the main thread to run
+    // (since raylib calls need to happen on the main thread).  Each thread records into
+    // its own buffer, which gets submitted as a whole via a compare-and-swap when it's
+    // full or when the thread calls `flush()`.  `window::draw()` drains the queue each frame,
+    // and drained buffers are kept on a free list to be recorded into again.  Commands from
+    // the same thread run in the order they were recorded; a thread's leftover commands are
+    // flushed when it exits.
+    commandQueue() = default;
+public:
+    // Like `SINGLETON_H`'s `get()`, but safe to call first from any thread,
+    // since worker threads can record before the main thread does.
+    static commandQueue *get();
+
+    // How many commands a thread records before its buffer is submitted automatically.
+    static constexpr index BufferCount = 256;
+
+    struct buffer
+    {   array<drawCommand> Commands;
+        // The buffer submitted before this one.
+        buffer *Next = Null;
+    };
+
+    ~commandQueue();
+
+    UNCOPYABLE_CLASS(commandQueue)
+    UNMOVABLE_CLASS(commandQueue)
+
+    // Records a command into this thread's buffer.
+    void record(drawCommand Command);
+
+    // Submits everything this thread has recorded so far.  Call this when a thread
+    // is done recording for the frame, otherwise its commands might wait for later frames.
+    void flush();
+
+    // Runs `run` on each submitted command, oldest first; this thread's recorded commands
+    // are flushed first.  Should only be called from one thread (i.e., the main thread).
+    // Returns how many commands were run.
+    index drain(fn<void(drawCommand &)> run);
+
+private:
+    // This thread's buffers; see command-queue.cc.
+    struct recorder;
+    static thread_local recorder Recorder;
+
+    // Returns an empty buffer to record into, reusing a drained one if there are any.
+    buffer *emptyBuffer();
+
+    // Puts the buffers from `First` through `Last` (via `Next`) onto the free list.
+    void recycle(buffer *First, buffer *Last);
+
+    // Submitted buffers, newest first.
+    std::atomic<buffer *> Submitted = Null;
+    // Drained buffers, ready to be recorded into again.  Threads only ever take
+    // the whole list at once (see `emptyBuffer()`), so a compare-and-swap can't see
+    // a buffer which was taken and put back in the meantime.
+    std::atomic<buffer *> Free = Null;
+};
+
+TMVB
@@ -1,5 +1,7 @@
 #include "l2.h"
 
+#include "command-queue.h"
+
 #ifndef NDEBUG
 #include "../core/error.h"
 #endif
@@ -25,6 +27,10 @@ void l2::writeToRow(const char *Chars)
     // TODO: calculate Offset from Font size and Texture size.
 }
 
+void l2::recordWrite(string String, coordinate2i Coordinates)
+{   commandQueue::get()->record(drawCommand::write(texture(), Font, std::move(String), Coordinates));
+}
+
 l2Owned::l2Owned(size2i Size) : l2(), Texture(Size)
 {}
 
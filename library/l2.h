@@ -37,6 +37,11 @@ public:
     textureBatch batch();
     void writeToRow(const char *Chars);
 
+    // Writes `String` at `Coordinates` with this l2's `Font` during the next `window::draw()`.
+    // Safe to call from any thread, since the write is recorded in the `commandQueue`
+    // and runs on the main thread.  This l2 (and its `Font`) must outlive that draw.
+    void recordWrite(string String, coordinate2i Coordinates);
+
     // TODO: `bvmt::coordinates coordinates(index2i Other_Position) const`
     //       to help with drawing to a specific region close to some position.
 private:
@@ -1,7 +1,12 @@
 #include "window.h"
 
+#include "command-queue.h"
+#include "font.h"
 #include "l2.h"
 
+#include "../core/job.h"
+#include "../core/memory.h"
+
 #ifndef NDEBUG
 #include "../core/error.h"
 #endif
@@ -13,7 +18,10 @@ BVMT
 WRAPPER(texture, RenderTexture2D)
 
 SINGLETON_CC(window,
-{   InitWindow(Resolution.Width, Resolution.Height, "bvmt");
+{   // Creates the job pool on this (i.e., raylib's) thread, so that it's the pool's main thread
+    // and runs `jobs::runOnMainThread` jobs in `firstPush`.
+    jobs::get();
+    InitWindow(Resolution.Width, Resolution.Height, "bvmt");
     TextureL3 = pointer<texture>::deleteOnDescope(new texture(DefaultResolution));
     TextureL2 = pointer<texture>::deleteOnDescope(new texture(DefaultResolution));
 })
@@ -27,15 +35,24 @@ windowDraw window::draw()
 }
 
 void window::firstPush()
-{   BeginDrawing();
+{   // Jobs from other threads which need raylib:
+    jobs::get()->runMainThreadJobs();
+    BeginDrawing();
     // TODO: change to a desired color.
     ClearBackground(RAYWHITE);
     draw(*TextureL3); // L3 goes first so it's drawn behind everything
+    // Commands recorded by other threads (or before this frame) go on top of L3:
+    commandQueue::get()->drain([this](drawCommand &Command) { run(Command); });
 }
 
 void window::lastPop()
 {   draw(*TextureL2); // L2 goes on top (e.g., for HUD)
     EndDrawing();
+    // Everything allocated for this frame goes away at once.
+    memory::frameArena().reset();
+    if (memory::allocationTracker::enabled())
+    {   memory::allocationTracker::get()->endFrame();
+    }
 }
 
 void window::draw(const texture &The_Texture)
@@ -58,6 +75,23 @@ void window::draw(const texture &The_Texture)
     );
 }
 
+void window::recordDraw(const texture &The_Texture)
+{   commandQueue::get()->record(drawCommand::draw(&The_Texture));
+}
+
+void window::run(drawCommand &Command)
+{   if (Command.Kind == drawCommand::kind::Draw)
+    {   draw(*Command.Source);
+        return;
+    }
+    if (Command.Target == Null || Command.Font == Null)
+    {   LOG_ERR("write command needs a target texture and a font");
+        return;
+    }
+    textureBatch Batch = Command.Target->batch();
+    Command.Font->write(std::move(Command.Text), Command.Coordinates);
+}
+
 void window::l2(fn<void(bvmt::l2 *)> L2Modifier_fn)
 {   l2Borrowed L2(*TextureL2);
     textureBatch Batch = L2.batch();
@@ -12,6 +12,7 @@ BVMT
 class l2;
 class l3;
 class window;
+struct drawCommand;
 
 typedef pushPop<window> windowDraw;
 
@@ -29,6 +30,10 @@ struct window
 
     // TODO: add a `windowDraw draw(texture, offset2i)` method.
 
+    // Draws `The_Texture` across the window (above L3, below L2) during the next `draw()`.
+    // Safe to call from any thread, see `commandQueue`.  The texture must outlive that draw.
+    void recordDraw(const texture &The_Texture);
+
     // Don't resize this window inside the callback.
     void l2(fn<void(bvmt::l2 *)> L2Modifier_fn);
 
@@ -52,6 +57,9 @@ private:
     pointer<texture> TextureL2;
 
     void draw(const texture &The_Texture);
+
+    // Runs a command recorded in the `commandQueue`.
+    void run(drawCommand &Command);
 };
 
 TMVB